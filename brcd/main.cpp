@@ -20,6 +20,7 @@
 #include <libbrccore/KeyManager.h>
 #include <libdevcore/DBFactory.h>
 #include <libbrcdchain/SnapshotImporter.h>
+#include <libbrcdchain/State.h>
 #include <libbrcdchain/SnapshotStorage.h>
 #include <libbvm/VMFactory.h>
 #include <libwebthree/WebThree.h>
@@ -259,6 +260,34 @@ int main(int argc, char **argv) {
     addClientOption("kill,K", "Kill the blockchain first");
     addClientOption("rebuild,R", "Rebuild the blockchain from the existing database");
     addClientOption("rescue", "Attempt to rescue a corrupt database\n");
+    addClientOption("account-cache", po::value<size_t>()->value_name("<MiB>")->notifier([](size_t _mb) {
+                        State::setAccountCacheBudget(_mb * 1024 * 1024);
+                    }),
+                    "Set the memory of decoded accounts kept per state (default: 4)");
+    addClientOption("shared-account-cache", po::value<size_t>()->value_name("<MiB>")->notifier([](size_t _mb) {
+                        State::setSharedAccountCacheBudget(_mb * 1024 * 1024);
+                    }),
+                    "Set the memory of decoded accounts shared by all states (default: 64)");
+    addClientOption("exdb-high-water", po::value<uint32_t>()->value_name("<percent>")->notifier([](uint32_t _percent) {
+                        if (_percent == 0 || _percent > 100)
+                            throw po::validation_error(po::validation_error::invalid_option_value, "exdb-high-water");
+                        State::exdbOptions().high_water = _percent;
+                    }),
+                    "Grow the exchange database when more than <percent> of it is used after a block (default: 80)");
+    addClientOption("exdb-max-size", po::value<uint64_t>()->value_name("<MiB>")->notifier([](uint64_t _mb) {
+                        State::exdbOptions().max_size = _mb * 1024 * 1024;
+                    }),
+                    "Never grow the exchange database past <MiB>, 0 for no limit (default: 0)");
+    addClientOption("exdb-flush-chunk", po::value<uint64_t>()->value_name("<MiB>")->notifier([](uint64_t _mb) {
+                        if (_mb == 0)
+                            throw po::validation_error(po::validation_error::invalid_option_value, "exdb-flush-chunk");
+                        State::exdbOptions().flush_chunk = _mb * 1024 * 1024;
+                    }),
+                    "Write back <MiB> of the exchange database after each block (default: 64)");
+    addClientOption("exdb-shrink-on-open", po::bool_switch()->notifier([](bool _shrink) {
+                        State::exdbOptions().shrink_on_open = _shrink;
+                    }),
+                    "Give the free space at the end of the exchange database file back before opening it\n");
     addClientOption("import-presale", po::value<string>()->value_name("<file>"),
                     "Import a pre-sale key; you'll need to specify the password to this key");
     addClientOption("import-secret,s", po::value<string>()->value_name("<secret>"),
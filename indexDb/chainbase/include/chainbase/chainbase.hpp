@@ -606,34 +606,44 @@ namespace chainbase {
 
          virtual void remove_object( int64_t id ) = 0;
 
+         /** finds the index again after the segment was mapped anew, see database::grow */
+         virtual void remap( bip::managed_mapped_file& segment ) = 0;
+
          void* get()const { return _idx_ptr; }
-      private:
+      protected:
          void* _idx_ptr;
    };
 
    template<typename BaseIndex>
    class index_impl : public abstract_index {
       public:
-         index_impl( BaseIndex& base ):abstract_index( &base ),_base(base){}
+         index_impl( BaseIndex& base ):abstract_index( &base ),_base(&base){}
 
          virtual unique_ptr<abstract_session> start_undo_session( bool enabled ) override {
-            return unique_ptr<abstract_session>(new session_impl<typename BaseIndex::session>( _base.start_undo_session( enabled ) ) );
+            return unique_ptr<abstract_session>(new session_impl<typename BaseIndex::session>( _base->start_undo_session( enabled ) ) );
          }
 
-         virtual void     set_revision( uint64_t revision ) override { _base.set_revision( revision ); }
-         virtual int64_t  revision()const  override { return _base.revision(); }
-         virtual void     undo()const  override { _base.undo(); }
-         virtual void     squash()const  override { _base.squash(); }
-         virtual void     commit( int64_t revision )const  override { _base.commit(revision); }
-         virtual void     undo_all() const override {_base.undo_all(); }
+         virtual void     set_revision( uint64_t revision ) override { _base->set_revision( revision ); }
+         virtual int64_t  revision()const  override { return _base->revision(); }
+         virtual void     undo()const  override { _base->undo(); }
+         virtual void     squash()const  override { _base->squash(); }
+         virtual void     commit( int64_t revision )const  override { _base->commit(revision); }
+         virtual void     undo_all() const override {_base->undo_all(); }
          virtual uint32_t type_id()const override { return BaseIndex::value_type::type_id; }
-         virtual uint64_t row_count()const override { return _base.indices().size(); }
+         virtual uint64_t row_count()const override { return _base->indices().size(); }
          virtual const std::string& type_name() const override { return BaseIndex_name; }
-         virtual std::pair<int64_t, int64_t> undo_stack_revision_range()const override { return _base.undo_stack_revision_range(); }
+         virtual std::pair<int64_t, int64_t> undo_stack_revision_range()const override { return _base->undo_stack_revision_range(); }
 
-         virtual void     remove_object( int64_t id ) override { return _base.remove_object( id ); }
+         virtual void     remove_object( int64_t id ) override { return _base->remove_object( id ); }
+
+         virtual void     remap( bip::managed_mapped_file& segment ) override {
+            _base = segment.find< BaseIndex >( BaseIndex_name.c_str() ).first;
+            if( !_base )
+               BOOST_THROW_EXCEPTION( std::runtime_error( "unable to find index for " + BaseIndex_name + " after remapping" ) );
+            this->_idx_ptr = _base;
+         }
       private:
-         BaseIndex& _base;
+         BaseIndex* _base;
          std::string BaseIndex_name = boost::core::demangle( typeid( typename BaseIndex::value_type ).name() );
    };
 
@@ -695,6 +705,21 @@ namespace chainbase {
          database& operator=(database&&) = default;
          bool is_read_only() const { return _read_only; }
          void flush();
+
+         /**
+          * writes back the dirty pages of [offset, offset + size) of the segment without waiting,
+          * a bounded alternative to flush() for the hot path.
+          */
+         void flush_range( uint64_t offset, uint64_t size );
+
+         /**
+          * grows the segment file by extra bytes and maps it again. the database may move, so nothing
+          * that points into it (objects, iterators, open undo sessions) may be held across the call.
+          */
+         void grow( uint64_t extra );
+
+         /** offline, returns the free space at the end of the segment file of dir to the file system */
+         static void shrink_to_fit( const bfs::path& dir );
          void set_require_locking( bool enable_require_locking );
 
 #ifdef CHAINBASE_CHECK_LOCKING
@@ -851,6 +876,11 @@ namespace chainbase {
             return _segment->get_segment_manager()->get_free_memory();
          }
 
+         size_t get_size()const
+         {
+            return _segment->get_size();
+         }
+
          template<typename MultiIndexType>
          const generic_index<MultiIndexType>& get_index()const
          {
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include <sys/mman.h>
+#include <unistd.h>
 
 namespace chainbase {
 
@@ -187,6 +188,44 @@ namespace chainbase {
          _meta->flush();
    }
 
+   void database::flush_range( uint64_t offset, uint64_t size ) {
+#ifndef _WIN32
+      if( !_segment || offset >= _segment->get_size() )
+         return;
+      static const uint64_t page = sysconf( _SC_PAGESIZE );
+      uint64_t begin = offset / page * page;
+      uint64_t end = std::min<uint64_t>( offset + size, _segment->get_size() );
+      if( msync( static_cast<char*>( _segment->get_address() ) + begin, end - begin, MS_ASYNC ) )
+         perror( "Failed to msync DB file range" );
+#else
+      flush();
+#endif
+   }
+
+   void database::grow( uint64_t extra ) {
+      if( _read_only )
+         BOOST_THROW_EXCEPTION( std::logic_error( "cannot grow a read-only database" ) );
+      auto abs_path = bfs::absolute( _data_dir / "shared_memory.bin" ).generic_string();
+
+      _segment->flush();
+      _segment.reset();
+      bool grown = bip::managed_mapped_file::grow( abs_path.c_str(), extra );
+      _segment.reset( new bip::managed_mapped_file( bip::open_only, abs_path.c_str() ) );
+      for( auto& item : _index_map )
+      {
+         if( item )
+            item->remap( *_segment );
+      }
+      if( !grown )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "could not grow database file." ) );
+   }
+
+   void database::shrink_to_fit( const bfs::path& dir ) {
+      auto abs_path = bfs::absolute( dir / "shared_memory.bin" );
+      if( bfs::exists( abs_path ) && !bip::managed_mapped_file::shrink_to_fit( abs_path.generic_string().c_str() ) )
+         BOOST_THROW_EXCEPTION( std::runtime_error( "could not shrink database file." ) );
+   }
+
    void database::_msync_database() {
 #ifdef _WIN32
 #warning Safe database dirty handling not implemented on WIN32
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <ostream>
+
+namespace dev {
+    namespace brc {
+        namespace ex {
+
+#ifdef __SIZEOF_INT128__
+            /// 256-bit unsigned number as two native 128-bit halves, for exchange prices and amounts.
+            /// compare/add/sub are native and wrap like u256, mul/div run in 128 bits while both operands
+            /// fit (checked), otherwise fall back to u256. the layout is plain data, safe in the mapped segment.
+            class compact_u256 {
+            public:
+                typedef unsigned __int128 half;
+
+                compact_u256() = default;
+
+                compact_u256(uint64_t v) : lo(v), hi(0) {}
+
+                compact_u256(const u256 &v) : lo(to_half(v)), hi(to_half(v >> 128)) {}
+
+                u256 value() const {
+                    return (from_half(hi) << 128) | from_half(lo);
+                }
+
+                /// true if the value fits 128 bits and takes the native path.
+                bool is_compact() const { return hi == 0; }
+
+                explicit operator bool() const { return lo != 0 || hi != 0; }
+
+                compact_u256 &operator+=(const compact_u256 &b) {
+                    half l = lo + b.lo;
+                    hi += b.hi + (l < lo ? 1 : 0);
+                    lo = l;
+                    return *this;
+                }
+
+                compact_u256 &operator-=(const compact_u256 &b) {
+                    half l = lo - b.lo;
+                    hi -= b.hi + (lo < b.lo ? 1 : 0);
+                    lo = l;
+                    return *this;
+                }
+
+                friend compact_u256 operator+(compact_u256 a, const compact_u256 &b) { return a += b; }
+
+                friend compact_u256 operator-(compact_u256 a, const compact_u256 &b) { return a -= b; }
+
+                friend compact_u256 operator*(const compact_u256 &a, const compact_u256 &b) {
+                    half r;
+                    if (a.hi == 0 && b.hi == 0 && !__builtin_mul_overflow(a.lo, b.lo, &r)) {
+                        return from_native(r);
+                    }
+                    return compact_u256(a.value() * b.value());
+                }
+
+                friend compact_u256 operator/(const compact_u256 &a, const compact_u256 &b) {
+                    // division by zero goes to u256, which throws.
+                    if (a.hi == 0 && b.hi == 0 && b.lo != 0) {
+                        return from_native(a.lo / b.lo);
+                    }
+                    return compact_u256(a.value() / b.value());
+                }
+
+                friend bool operator==(const compact_u256 &a, const compact_u256 &b) { return a.lo == b.lo && a.hi == b.hi; }
+                friend bool operator!=(const compact_u256 &a, const compact_u256 &b) { return !(a == b); }
+                friend bool operator<(const compact_u256 &a, const compact_u256 &b) {
+                    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+                }
+                friend bool operator>(const compact_u256 &a, const compact_u256 &b) { return b < a; }
+                friend bool operator<=(const compact_u256 &a, const compact_u256 &b) { return !(b < a); }
+                friend bool operator>=(const compact_u256 &a, const compact_u256 &b) { return !(a < b); }
+
+                friend std::ostream &operator<<(std::ostream &os, const compact_u256 &v) { return os << v.value(); }
+
+                /// a * b <= limit, without wrapping.
+                friend bool product_le(const compact_u256 &a, const compact_u256 &b, const compact_u256 &limit) {
+                    half r;
+                    if (a.hi == 0 && b.hi == 0 && !__builtin_mul_overflow(a.lo, b.lo, &r)) {
+                        return limit.hi != 0 || r <= limit.lo;
+                    }
+                    return bigint(a.value()) * b.value() <= limit.value();
+                }
+
+            private:
+                static compact_u256 from_native(half v) {
+                    compact_u256 ret;
+                    ret.lo = v;
+                    ret.hi = 0;
+                    return ret;
+                }
+
+                static half to_half(const u256 &v) {
+                    const u256 mask = std::numeric_limits<uint64_t>::max();
+                    return (half(static_cast<uint64_t>((v >> 64) & mask)) << 64) | half(static_cast<uint64_t>(v & mask));
+                }
+
+                static u256 from_half(half v) {
+                    return (u256(static_cast<uint64_t>(v >> 64)) << 64) | u256(static_cast<uint64_t>(v));
+                }
+
+                half lo = 0;
+                half hi = 0;
+            };
+
+            inline u256 to_u256(const compact_u256 &v) { return v.value(); }
+#endif
+
+            inline const u256 &to_u256(const u256 &v) { return v; }
+
+            /// a * b <= limit, without wrapping.
+            inline bool product_le(const u256 &a, const u256 &b, const u256 &limit) {
+                return bigint(a) * b <= limit;
+            }
+
+            /// price and amount type of the exchange objects and the matching path.
+            /// u256 by default, EX_COMPACT_NUMBER selects compact_u256.
+#if defined(BRC_EX_COMPACT_NUMBER) && defined(__SIZEOF_INT128__)
+            typedef compact_u256 ex_number;
+#else
+            typedef u256 ex_number;
+#endif
+
+        }
+    }
+}
@@ -13,14 +13,72 @@ namespace dev {
         namespace ex {
 
 
+            /// how the segment file of the exchange database is sized and written back.
+            struct segment_options {
+                uint64_t initial_size = 1024 * 1024 * 1024ULL;
+                /// grow when more than this percent of the segment is used after a block.
+                uint32_t high_water = 80;
+                /// never grow past this size, 0 for no limit.
+                uint64_t max_size = 0;
+                /// bytes written back after each block, the whole segment is covered in turns.
+                uint64_t flush_chunk = 64 * 1024 * 1024ULL;
+                /// return trailing free space of the file before opening.
+                bool shrink_on_open = false;
+                /// result orders kept in the segment, older fills move to the history store. 0 keeps all.
+                uint64_t hot_results = 100000;
+            };
+
             class database : public chainbase::database {
             public:
 
                 database(const boost::filesystem::path &data_dir, open_flags write = read_only,
                          uint64_t shared_file_size = 0, bool allow_dirty = false);
 
+                database(const boost::filesystem::path &data_dir, const segment_options &options);
+
                 ~database();
                 std::vector<result_order> find_order(order_type o_type, order_token_type t_type, u256 price_upper);
+
+                /// open the undo session of a block, no-op if one is open.
+                void start_block();
+
+                /// keep the changes of the block session on the undo stack and close it.
+                void push_block();
+
+                /// undo the changes of the block session and close it.
+                void undo_block();
+
+                bool in_block() const { return m_block_session != nullptr; }
+
+                /// lowest revision the undo stack can still go back to.
+                int64_t undoable_revision() const;
+
+                /// drop the block session, then undo pushed sessions back to @a revision. false if it is not undoable.
+                bool undo_to(int64_t revision);
+
+                /// committed blocks kept undoable, at least 1.
+                void set_checkpoint_depth(uint32_t depth) { m_checkpoint_depth = std::max<uint32_t>(depth, 1); }
+                uint32_t checkpoint_depth() const { return m_checkpoint_depth; }
+
+                /// between blocks only: grows the segment if it is used past the high-water mark.
+                /// the database moves, no object reference or session may be held. call it under the write lock,
+                /// so no reader is in the segment while it is mapped again.
+                /// \return true if it grew.
+                bool grow_if_needed();
+
+                /// write back the next flush_chunk bytes of the segment without waiting.
+                void flush_step();
+
+                const segment_options &options() const { return m_options; }
+
+            private:
+                /// shared by every exchange_plugin of this database, the block may be executed by any State copy.
+                std::unique_ptr<session> m_block_session;
+
+                uint32_t m_checkpoint_depth = 64;
+
+                segment_options m_options;
+                uint64_t m_flush_offset = 0;
             };
         }
     }
@@ -12,6 +12,8 @@
 #include <brc/objects.hpp>
 
 #include <brc/database.hpp>
+#include <brc/orderBook.hpp>
+#include <brc/resultArchive.hpp>
 
 namespace dev {
     namespace brc {
@@ -23,7 +25,7 @@ namespace dev {
                 }
 
                 ~exchange_plugin();
-                exchange_plugin(const boost::filesystem::path &data_dir);
+                exchange_plugin(const boost::filesystem::path &data_dir, const segment_options &options = segment_options());
 
 
                 exchange_plugin(const exchange_plugin &) = default;
@@ -39,48 +41,106 @@ namespace dev {
                 /// \return
                 std::vector<result_order> insert_operation(const std::vector<order> &orders, bool reset = true, bool throw_exception = false) ;
 
+                /// open the exchange session of a block, no-op if it is open.
+                /// recorded operations of the block are matched in this one undo session instead of one session
+                /// (and write lock) each, commit() keeps the block and rollback() drops it.
+                void begin_block();
+
+                /// true if a block session is open.
+                bool in_block() const;
+
                 /// get exchange order by address,
                 /// \param addr   Address
                 /// \return         complete order.
                 std::vector<exchange_order> get_order_by_address(const Address &addr) const;
 
+                /// one page of the orders of an address, newest first.
+                /// \param size   page size.
+                /// \param after  the last order of the previous page, empty for the first page.
+                std::vector<exchange_order> get_order_by_address(const Address &addr, uint32_t size,
+                                                                 const order_cursor &after = order_cursor()) const;
+
                 /// get current all orders on exchange by size. this search by id in function.
                 /// \param size  once get once.
+                /// \param after the last order of the previous page, empty for the first page.
                 /// \return
-                std::vector<exchange_order> get_orders(uint32_t size = 50) const;
+                std::vector<exchange_order> get_orders(uint32_t size = 50, const order_cursor &after = order_cursor()) const;
 
-                /// get newest result_order by size
+                /// get newest result_order by size, from the segment and then the history store.
                 /// \param size         once get size.
-                /// \return             vector<result_orders>.
-                std::vector<result_order> get_result_orders_by_news(uint32_t size = 50) const;
+                /// \param before       only fills with an id below it, the id of the last fill of a page gets the next.
+                /// \return             vector<result_orders>, newest first.
+                std::vector<result_order> get_result_orders_by_news(uint32_t size = 50, int64_t before = INT64_MAX) const;
 
                 /// get exchange order by type (sell or buy && BRC or  FUEL)
                 /// \param type         sell or buy
                 /// \param token_type   BRC OR FUEL
                 /// \param size         once search size.
+                /// \param after        the last order of the previous page, empty for the first page.
                 /// \return             complete order.
-                std::vector<exchange_order> get_order_by_type(order_type type, order_token_type token_type, uint32_t size) const;
+                std::vector<exchange_order> get_order_by_type(order_type type, order_token_type token_type, uint32_t size,
+                                                              const order_cursor &after = order_cursor()) const;
 
-                /// rollback before packed block.
+                /// rollback before packed block, drops the block session and anything after the newest checkpoint.
                 /// \return
                 bool rollback();
 
 
-                ///  commit this state by block number.
+                ///  commit this state by block number, keeps the block session. nothing stays undoable.
                 /// \param version  block number
                 /// \return  true
                 bool commit(int64_t version);
 
+                /// commit this state as the checkpoint of a block, keeps the block session.
+                /// the newest checkpoint_depth blocks stay on the undo stack, rewind_to() goes back to any of them.
+                /// \param version     block number + 1
+                /// \param block_hash  hash of the committed block.
+                /// \return  true
+                bool commit(int64_t version, const h256 &block_hash);
+
+                /// undo back to the state committed with @a block_hash, cost is the changes of the undone blocks.
+                /// drops the block session. false and unchanged if the block is not a kept checkpoint.
+                bool rewind_to(const h256 &block_hash);
+
+                /// true if rewind_to(block_hash) can succeed.
+                bool has_checkpoint(const h256 &block_hash) const;
+
+                /// hash of the newest checkpoint, zero if there is none.
+                h256 head_checkpoint() const;
+
+                /// number of committed blocks kept undoable, 64 by default. shared by every copy of this database.
+                void set_checkpoint_depth(uint32_t depth);
+                uint32_t checkpoint_depth() const;
+
                 ///
                 /// \param os vector transactions id
                 /// \param reset   if true, this operation rollback
                 /// \return        vector<orders>
                 std::vector<order>  cancel_order_by_trxid(const std::vector<h256> &os, bool reset);
 
+                /// read only, the orders cancel_order_by_trxid would remove. takes the read lock.
+                /// \param os vector transactions id
+                /// \return        vector<orders>, throws find_order_trxid_error if an id is not on book.
+                std::vector<order> get_order_by_trxid(const std::vector<h256> &os) const;
+
+                /// read only, true if the order of trxid is on book and every part of it belongs to sender.
+                /// waits for a writer instead of failing, the answer decides a transaction of a block.
+                bool is_order_owner(const h256 &trxid, const Address &sender) const;
+
+                /// read only, aggregated price levels of one side, best price first.
+                /// \return    pairs of price and token amount.
+                std::vector<std::pair<u256, u256>> get_depth(order_type type, order_token_type token_type, uint32_t size = 50) const;
+
+                /// read only, what an order would fill against the book now. see order_book::estimate.
+                fill_estimate estimate_fill(order_type type, order_token_type token_type, order_buy_type buy_type,
+                                            const u256 &price, const u256 &amount) const;
+
 
                 inline std::string check_version(bool p) const{
-                    const auto &obj = get_dynamic_object();
-                    std::string ret = "  current  exchange database version : " + std::to_string(obj.version) + " orders: " + std::to_string(obj.orders) + " ret_orders:" + std::to_string(obj.result_orders);
+                    std::string ret = read_locked([&]() {
+                        const auto &obj = get_dynamic_object();
+                        return "  current  exchange database version : " + std::to_string(obj.version) + " orders: " + std::to_string(obj.orders) + " ret_orders:" + std::to_string(obj.result_orders);
+                    });
                     if(p){
                         cwarn << ret;
                     }
@@ -88,122 +148,6 @@ namespace dev {
                 };
             private:
 
-                /// get iterator by type and price . this only find order of sell.
-                /// \param token_type   BRC OR FUEL
-                /// \param price        upper price.
-                /// \return         std::pair<lower iterator, upper iterator>
-                auto get_buy_itr(order_token_type token_type, u256 price) {
-                    auto find_token = token_type == order_token_type::BRC ? order_token_type::FUEL : order_token_type::BRC;
-                    const auto &index_greater = db->get_index<order_object_index>().indices().get<by_price_less>();
-
-                    auto find_lower = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::sell, find_token,
-                                                                                                u256(0), 0);
-                    auto find_upper = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::sell, find_token,
-                                                                                                price, INT64_MAX);
-
-                    typedef decltype(index_greater.lower_bound(find_lower)) Lower_Type;
-                    typedef decltype(index_greater.upper_bound(find_upper)) Upper_Type;
-
-                    return std::pair<Lower_Type, Upper_Type>(index_greater.lower_bound(find_lower),
-                                                             index_greater.upper_bound(find_upper));
-                };
-
-                /// get iterator by type and price, this only find of buy
-                /// \param token_type   BRC OR FUEL,
-                /// \param price        lower price.
-                /// \return             std::pair<lower iterator, upper iterator>
-                auto get_sell_itr(order_token_type token_type, u256 price) {
-                    auto find_token = token_type == order_token_type::BRC ? order_token_type::FUEL : order_token_type::BRC;
-                    const auto &index_less = db->get_index<order_object_index>().indices().get<by_price_greater>();  //↑
-
-                    auto find_lower = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::buy, find_token,
-                                                                                                u256(-1), 0);
-                    auto find_upper = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::buy, find_token,
-                                                                                                price, INT64_MAX);
-
-                    typedef decltype(index_less.lower_bound(find_lower)) Lower_Type;
-                    typedef decltype(index_less.upper_bound(find_upper)) Upper_Type;
-
-                    return std::pair<Lower_Type, Upper_Type>(index_less.lower_bound(find_lower),
-                                                             index_less.upper_bound(find_upper));
-                };
-
-
-                /// process buy or sell orders by price and amount,
-                /// \tparam BEGIN   get_buy_itr.first or get_sell_itr.first.
-                /// \tparam END     get_buy_itr.second or get_buy_itr.second.
-                /// \param begin    begin iterator,
-                /// \param end      end iterator.
-                /// \param od       source order.
-                /// \param price    price,
-                /// \param amount   exchange amount
-                /// \param result   result of success order.
-                /// \param throw_exception  if true, will throw exception while error.
-                template<typename BEGIN, typename END>
-                void process_only_price(BEGIN &begin, END &end, const order &od, const u256 &price, const u256 &amount,
-                              std::vector<result_order> &result, bool throw_exception) {
-                    if (begin == end) {
-                        db->create<order_object>([&](order_object &obj) {
-                            obj.set_data(od, std::pair<u256, u256>(price, amount), amount);
-                        });
-
-                        update_dynamic_orders(true);
-                        return;
-                    }
-                    auto spend = amount;
-
-                    bool rm = false;
-                    while (spend > 0 && begin != end) {
-                        result_order ret;
-                        if (begin->token_amount <= spend) {
-                            spend -= begin->token_amount;
-                            ret.set_data(od, begin, begin->token_amount, begin->price);
-                            rm = true;
-
-                        } else {
-                            db->modify(*begin, [&](order_object &obj) {
-                                obj.token_amount -= spend;
-                            });
-                            ret.set_data(od, begin, spend, begin->price);
-                            spend = 0;
-                        }
-
-                        db->create<order_result_object>([&](order_result_object &obj) {
-                            obj.set_data(ret);
-                        });
-                        update_dynamic_result_orders();
-
-                        result.push_back(ret);
-                        if (rm) {
-                            const auto rm_obj = db->find(begin->id);
-                            if (rm_obj != nullptr) {
-                                begin++;
-                                db->remove(*rm_obj);
-                                update_dynamic_orders(false);
-                            } else {
-                                if (throw_exception) {
-                                    BOOST_THROW_EXCEPTION(remove_object_error());
-                                }
-                            }
-                            rm = false;
-                        } else {
-                            begin++;
-                        }
-
-                    }
-                    //surplus token ,  record to db
-                    if (spend > 0) {
-                        db->create<order_object>([&](order_object &obj) {
-                            obj.set_data(od, std::pair<u256, u256>(price, amount), spend);
-                        });
-                        update_dynamic_orders(true);
-                    }
-
-
-                }
-
-
-
                 //only for public interface.
                 //mabey remove it.  if use for debug.
                 inline void check_db() const{
@@ -214,32 +158,52 @@ namespace dev {
 #endif
                 }
 
+                /// every read and every write of the database goes through these two, readers share it with each
+                /// other and wait for writers. there is no timeout: a failed lock would change the answer a block
+                /// gets, and a timed out write lock moves on to another mutex beside readers of the old one.
+                template<typename Lambda>
+                auto read_locked(Lambda &&callback) const -> decltype(callback()) {
+                    return db->with_read_lock(std::forward<Lambda>(callback), 0);
+                }
+
+                template<typename Lambda>
+                auto write_locked(Lambda &&callback) -> decltype(callback()) {
+                    return db->with_write_lock(std::forward<Lambda>(callback), 0);
+                }
+
+                /// after a commit: grow the segment if needed and write back the next part of it,
+                /// a full flush of the segment each block stalls the import thread.
+                void end_block();
+
+                /// the writes of commit(version, block_hash), under the write lock.
+                void commit_checkpoint(int64_t version, const h256 &block_hash);
 
+                /// after a commit: move result orders beyond hot_results and the undo stack to the history store.
+                void archive_results();
 
+                /// match orders in the current session.
+                std::vector<result_order> match_orders(const std::vector<order> &orders);
 
                 const dynamic_object &get_dynamic_object() const {
                     return db->get<dynamic_object>();
                 }
 
-                void update_dynamic_orders(bool up){
-                    db->modify(get_dynamic_object(), [&](dynamic_object &obj){
-                        if(up){
-                            obj.orders++;
-                        }else{
-                            obj.orders--;
-                        }
-                    });
-                }
-
-                void update_dynamic_result_orders(){
-                    db->modify(get_dynamic_object(), [&](dynamic_object &obj){
-                        obj.result_orders++;
+                /// write back counters changed by one operation.
+                void update_dynamic(const dynamic_delta &delta) {
+                    if (delta.empty()) {
+                        return;
+                    }
+                    db->modify(get_dynamic_object(), [&](dynamic_object &obj) {
+                        obj.orders += delta.orders;
+                        obj.result_orders += delta.result_orders;
                     });
                 }
 
             //--------------------- members ---------------------
                 /// database
                 std::shared_ptr<database> db;
+                /// older result orders.
+                std::shared_ptr<result_archive> archive;
 
 
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <brc/compactNumber.hpp>
 #include <brc/types.hpp>
 #include <libdevcore/Address.h>
 #include <libdevcore/Common.h>
@@ -65,6 +66,7 @@ namespace dev {
                 h256                to_trxid;           //which trxid
                 u256                amount;
                 u256                price;
+                int64_t             id = 0;             //history id, set by result queries.
             };
 
 
@@ -76,7 +78,9 @@ namespace dev {
             enum object_id {
                 order_object_id = 0,
                 order_result_object_id,
-                dynamic_object_id
+                dynamic_object_id,
+                order_level_object_id,
+                block_checkpoint_object_id
             };
 
 
@@ -91,9 +95,9 @@ namespace dev {
                 id_type id;
                 h256 trxid;
                 Address sender;
-                u256 price;
-                u256 token_amount;
-                u256 source_amount;
+                ex_number price;
+                ex_number token_amount;
+                ex_number source_amount;
                 Time_ms create_time;
                 order_type type;
                 order_token_type token_type;
@@ -101,7 +105,7 @@ namespace dev {
 
                 //set data
                 template<typename ITR1, typename ITR2>
-                void set_data(ITR1 itr, ITR2 t, u256 rel_amount) {
+                void set_data(ITR1 itr, ITR2 t, const ex_number &rel_amount) {
                     sender = itr.sender;
                     trxid = itr.trxid;
                     price = t.first;
@@ -136,19 +140,19 @@ namespace dev {
                                     composite_key<order_object,
                                             member<order_object, order_type, &order_object::type>,
                                             member<order_object, order_token_type, &order_object::token_type>,
-                                            member<order_object, u256, &order_object::price>,
+                                            member<order_object, ex_number, &order_object::price>,
                                             member<order_object, Time_ms, &order_object::create_time>
                                     >,
-                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::less<u256>, std::less<Time_ms>>
+                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::less<ex_number>, std::less<Time_ms>>
                             >,
                             ordered_non_unique<tag<by_price_greater>,
                                     composite_key<order_object,
                                             member<order_object, order_type, &order_object::type>,
                                             member<order_object, order_token_type, &order_object::token_type>,
-                                            member<order_object, u256, &order_object::price>,
+                                            member<order_object, ex_number, &order_object::price>,
                                             member<order_object, Time_ms, &order_object::create_time>
                                     >,
-                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::greater<u256>, std::less<Time_ms>>
+                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::greater<ex_number>, std::less<Time_ms>>
                             >,
                             ordered_non_unique<tag<by_address>,
                                     composite_key<order_object,
@@ -246,13 +250,94 @@ namespace dev {
             > dynamic_object_index;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+            /// aggregate of all resting orders at one price of one book side (type && token_type).
+            /// the orders of a level are kept FIFO by the by_price_less index (price, create_time).
+            class order_level_object : public chainbase::object<order_level_object_id, order_level_object> {
+            public:
+                template<typename Constructor, typename Allocator>
+                order_level_object(Constructor &&c, Allocator &&a) {
+                    c(*this);
+                }
+
+                id_type id;
+                order_type type;
+                order_token_type token_type;
+                ex_number price;
+                ex_number total_amount;     //sum of token_amount of the resting orders.
+                uint64_t size;              //resting orders number.
+            };
+
+            struct by_level_less;
+            struct by_level_greater;
+            typedef multi_index_container<
+                    order_level_object,
+                    indexed_by<
+                            ordered_unique<tag<by_id>,
+                                    member<order_level_object, order_level_object::id_type, &order_level_object::id>
+                            >,
+                            ordered_unique<tag<by_level_less>,
+                                    composite_key<order_level_object,
+                                            member<order_level_object, order_type, &order_level_object::type>,
+                                            member<order_level_object, order_token_type, &order_level_object::token_type>,
+                                            member<order_level_object, ex_number, &order_level_object::price>
+                                    >,
+                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::less<ex_number>>
+                            >,
+                            ordered_unique<tag<by_level_greater>,
+                                    composite_key<order_level_object,
+                                            member<order_level_object, order_type, &order_level_object::type>,
+                                            member<order_level_object, order_token_type, &order_level_object::token_type>,
+                                            member<order_level_object, ex_number, &order_level_object::price>
+                                    >,
+                                    composite_key_compare<std::less<order_type>, std::less<order_token_type>, std::greater<ex_number>>
+                            >
+                    >,
+                    chainbase::allocator<order_level_object>
+            > order_level_object_index;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+            /// the undo revision the exchange state had after a committed block.
+            /// created in the undo state of its own block, so undoing the block removes it too.
+            class block_checkpoint_object : public chainbase::object<block_checkpoint_object_id, block_checkpoint_object> {
+            public:
+                template<typename Constructor, typename Allocator>
+                block_checkpoint_object(Constructor &&c, Allocator &&a) {
+                    c(*this);
+                }
+
+                id_type id;
+                h256 block_hash;
+                int64_t number;
+                int64_t revision;
+            };
+
+            struct by_block_hash;
+            typedef multi_index_container<
+                    block_checkpoint_object,
+                    indexed_by<
+                            ordered_unique<tag<by_id>,
+                                    member<block_checkpoint_object, block_checkpoint_object::id_type, &block_checkpoint_object::id>
+                            >,
+                            ordered_unique<tag<by_block_hash>,
+                                    member<block_checkpoint_object, h256, &block_checkpoint_object::block_hash>
+                            >
+                    >,
+                    chainbase::allocator<block_checkpoint_object>
+            > block_checkpoint_object_index;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
             struct exchange_order {
                 exchange_order(const order_object &obj)
-                        : trxid(obj.trxid), sender(obj.sender), price(obj.price), token_amount(obj.token_amount),
-                          source_amount(obj.source_amount), create_time(obj.create_time), type(obj.type),
+                        : trxid(obj.trxid), sender(obj.sender), price(to_u256(obj.price)),
+                          token_amount(to_u256(obj.token_amount)), source_amount(to_u256(obj.source_amount)),
+                          create_time(obj.create_time), type(obj.type),
                           token_type(obj.token_type) {
                 }
 
@@ -266,6 +351,26 @@ namespace dev {
                 order_token_type token_type;
             };
 
+            /// where a page of resting orders ended, the next page starts after it.
+            /// the order is found again by trxid; once it is gone the page starts at its key, which may repeat
+            /// orders sharing that key but never skips one. a zero trxid starts from the top.
+            struct order_cursor {
+                order_cursor() {}
+
+                order_cursor(const exchange_order &o)
+                        : trxid(o.trxid), type(o.type), token_type(o.token_type), price(o.price),
+                          create_time(o.create_time) {
+                }
+
+                bool empty() const { return !trxid; }
+
+                h256 trxid;
+                order_type type = order_type::null_type;
+                order_token_type token_type = order_token_type::BRC;
+                u256 price;
+                Time_ms create_time = 0;
+            };
+
         }
     }
 }
@@ -274,3 +379,5 @@ namespace dev {
 CHAINBASE_SET_INDEX_TYPE(dev::brc::ex::order_object, dev::brc::ex::order_object_index)
 CHAINBASE_SET_INDEX_TYPE(dev::brc::ex::order_result_object, dev::brc::ex::order_result_object_index)
 CHAINBASE_SET_INDEX_TYPE(dev::brc::ex::dynamic_object, dev::brc::ex::dynamic_object_index)
+CHAINBASE_SET_INDEX_TYPE(dev::brc::ex::order_level_object, dev::brc::ex::order_level_object_index)
+CHAINBASE_SET_INDEX_TYPE(dev::brc::ex::block_checkpoint_object, dev::brc::ex::block_checkpoint_object_index)
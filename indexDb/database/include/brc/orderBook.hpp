@@ -0,0 +1,124 @@
+#pragma once
+
+#include <boost/tuple/tuple.hpp>
+#include <brc/database.hpp>
+#include <brc/compactNumber.hpp>
+#include <brc/exception.hpp>
+#include <brc/objects.hpp>
+#include <brc/types.hpp>
+
+namespace dev {
+    namespace brc {
+        namespace ex {
+
+            /// changes of dynamic_object counters, written back with one modify per operation.
+            struct dynamic_delta {
+                int64_t orders = 0;
+                uint64_t result_orders = 0;
+
+                bool empty() const { return orders == 0 && result_orders == 0; }
+            };
+
+            /// what an order would take from the book, nothing is matched.
+            struct fill_estimate {
+                u256 amount = 0;            //token amount filled.
+                bigint total_price = 0;     //sum of amount * price of the filled part.
+                uint32_t levels = 0;        //price levels touched.
+            };
+
+
+            /// price-level book over the chainbase order indices.
+            /// every side (type && token_type) is a set of order_level_object ordered by price, a level aggregates
+            /// the amount of its resting order_object, which are consumed FIFO (create_time).
+            /// matching walks the levels and takes a whole level at once when the taker covers it,
+            /// the order_object stay the source of truth and a level is written once per match.
+            class order_book {
+            public:
+                explicit order_book(database &_db) : db(_db) {}
+
+                /// match only_price order, surplus token is recorded to book.
+                /// \param od       source order.
+                /// \param price    price,
+                /// \param amount   exchange amount
+                /// \param result   result of success order.
+                void match_only_price(const order &od, const ex_number &price, const ex_number &amount,
+                                      std::vector<result_order> &result);
+
+                /// match all_price buy order, spend total price (price_token key) from the lowest sell level.
+                /// \param od       source order.
+                /// \param result   result of success order.
+                void match_all_price_buy(const order &od, std::vector<result_order> &result);
+
+                /// match all_price sell order, sell amount (price_token value) from the highest buy level.
+                /// \param od       source order.
+                /// \param result   result of success order.
+                void match_all_price_sell(const order &od, std::vector<result_order> &result);
+
+                /// record resting order and update its level.
+                /// \param od               source order.
+                /// \param price            price.
+                /// \param source_amount    amount of source order.
+                /// \param amount           amount still on book.
+                void add_order(const order &od, const ex_number &price, const ex_number &source_amount,
+                               const ex_number &amount);
+
+                /// remove resting order and update its level.
+                void remove_order(const order_object &obj);
+
+                /// rebuild all levels from the resting orders, for database created without level index.
+                void rebuild_levels();
+
+                /// walk the book like a match of the order would, without changing it.
+                /// \param price    only_price: limit price. all_price buy: total price to spend.
+                /// \param amount   only_price and all_price sell: token amount.
+                fill_estimate estimate(order_type type, order_token_type token_type, order_buy_type buy_type,
+                                       const u256 &price, const u256 &amount) const;
+
+                const dynamic_delta &delta() const { return m_delta; }
+
+            private:
+                /// sell levels of token_type, price up to price, low to high.
+                auto get_sell_levels(order_token_type token_type, const ex_number &price) const {
+                    const auto &index = db.get_index<order_level_object_index>().indices().get<by_level_less>();
+                    return std::make_pair(index.lower_bound(boost::make_tuple(order_type::sell, token_type, ex_number(0))),
+                                          index.upper_bound(boost::make_tuple(order_type::sell, token_type, price)));
+                }
+
+                /// buy levels of token_type, price down to price, high to low.
+                auto get_buy_levels(order_token_type token_type, const ex_number &price) const {
+                    const auto &index = db.get_index<order_level_object_index>().indices().get<by_level_greater>();
+                    return std::make_pair(index.lower_bound(boost::make_tuple(order_type::buy, token_type, ex_number(u256(-1)))),
+                                          index.upper_bound(boost::make_tuple(order_type::buy, token_type, price)));
+                }
+
+                /// resting orders of level, FIFO.
+                auto get_level_orders(const order_level_object &level) const {
+                    const auto &index = db.get_index<order_object_index>().indices().get<by_price_less>();
+                    return index.equal_range(boost::make_tuple(level.type, level.token_type, level.price));
+                }
+
+                template<typename BEGIN, typename END>
+                void process_only_price(BEGIN begin, END end, const order &od, const ex_number &price, const ex_number &amount,
+                                        std::vector<result_order> &result);
+
+                template<typename BEGIN, typename END>
+                void estimate_levels(BEGIN begin, END end, bool spend_price, const u256 &price, const u256 &amount,
+                                     fill_estimate &ret) const;
+
+                /// fill every resting order of level completely and remove level.
+                void fill_level(const order &od, const order_level_object &level, std::vector<result_order> &result);
+
+                /// write back a partially filled level.
+                void update_level(const order_level_object &level, const ex_number &filled, uint64_t removed);
+
+                /// record success order.
+                void fill_order(const order &od, const order_object &obj, const ex_number &amount,
+                                std::vector<result_order> &result);
+
+                database &db;
+                dynamic_delta m_delta;
+            };
+
+        }
+    }
+}
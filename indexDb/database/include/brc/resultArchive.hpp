@@ -0,0 +1,36 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <brc/objects.hpp>
+#include <libdevcore/db.h>
+
+#include <atomic>
+#include <memory>
+
+namespace dev {
+    namespace brc {
+        namespace ex {
+
+            /// history tier of result orders, fills moved out of the segment are kept here by id.
+            /// the ids of fills are dense, so the newest first paging is one lookup each fill.
+            class result_archive {
+            public:
+                explicit result_archive(const boost::filesystem::path &path);
+                explicit result_archive(std::unique_ptr<db::DatabaseFace> db);
+
+                /// store fills with their ids in one batch. storing an id again keeps it as it was.
+                void append(const std::vector<std::pair<int64_t, result_order>> &fills);
+
+                /// newest first, up to size fills with an id below before.
+                std::vector<result_order> get_before(int64_t before, uint32_t size) const;
+
+                /// one past the newest archived id.
+                int64_t end() const { return m_end; }
+
+            private:
+                std::unique_ptr<db::DatabaseFace> m_db;
+                std::atomic<int64_t> m_end{0};
+            };
+        }
+    }
+}
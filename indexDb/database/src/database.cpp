@@ -2,6 +2,7 @@
 
 
 #include <brc/database.hpp>
+#include <libdevcore/Log.h>
 
 namespace dev {
     namespace brc {
@@ -12,9 +13,88 @@ namespace dev {
                                                                                                   allow_dirty) {
             }
 
+            namespace {
+                const boost::filesystem::path &shrink_before_open(const boost::filesystem::path &data_dir,
+                                                                  const segment_options &options) {
+                    if (options.shrink_on_open) {
+                        chainbase::database::shrink_to_fit(data_dir);
+                    }
+                    return data_dir;
+                }
+            }
+
+            database::database(const boost::filesystem::path &data_dir, const segment_options &options)
+                    : chainbase::database(shrink_before_open(data_dir, options), read_write, options.initial_size),
+                      m_options(options) {
+            }
+
             database::~database() {
                 std::cout << __FUNCTION__ << "  " <<  __LINE__ << "  : close exdb complete.\n";
             }
+
+            void database::start_block() {
+                if (!m_block_session) {
+                    m_block_session.reset(new session(start_undo_session(true)));
+                }
+            }
+
+            void database::push_block() {
+                if (m_block_session) {
+                    m_block_session->push();
+                    m_block_session.reset();
+                }
+            }
+
+            void database::undo_block() {
+                // session destructor undoes.
+                m_block_session.reset();
+            }
+
+            bool database::grow_if_needed() {
+                uint64_t size = get_size();
+                uint64_t used = size - get_free_memory();
+                if (used * 100 <= size * m_options.high_water) {
+                    return false;
+                }
+                if (m_block_session) {
+                    BOOST_THROW_EXCEPTION(std::logic_error("can not grow exchange database in a block."));
+                }
+                // double, or less if capped.
+                uint64_t extra = size;
+                if (m_options.max_size) {
+                    extra = m_options.max_size > size ? std::min(extra, m_options.max_size - size) : 0;
+                }
+                if (extra == 0) {
+                    cwarn << "exchange database is " << used * 100 / size << "% used and at its size limit.";
+                    return false;
+                }
+                cnote << "growing exchange database from " << size << " to " << size + extra << " bytes.";
+                grow(extra);
+                return true;
+            }
+
+            void database::flush_step() {
+                if (m_flush_offset >= get_size()) {
+                    m_flush_offset = 0;
+                }
+                flush_range(m_flush_offset, m_options.flush_chunk);
+                m_flush_offset += m_options.flush_chunk;
+            }
+
+            int64_t database::undoable_revision() const {
+                return get_index<dynamic_object_index>().undo_stack_revision_range().first;
+            }
+
+            bool database::undo_to(int64_t revision) {
+                undo_block();
+                if (revision < undoable_revision() || revision > this->revision()) {
+                    return false;
+                }
+                while (this->revision() > revision) {
+                    undo();
+                }
+                return true;
+            }
         }
     }
 }
\ No newline at end of file
@@ -14,18 +14,79 @@ namespace dev {
     namespace brc {
         namespace ex {
 
-            exchange_plugin::exchange_plugin(const boost::filesystem::path &data_dir)
-                    : db(new database(data_dir, chainbase::database::read_write, 1024 * 1024 * 1024ULL)) {
+            namespace {
+                /// the order of a trxid from its resting parts, one per price.
+                template<typename ITR>
+                order make_order(ITR begin, ITR end) {
+                    order o;
+                    o.trxid = begin->trxid;
+                    o.sender = begin->sender;
+                    o.buy_type = order_buy_type::only_price;
+                    o.token_type = begin->token_type;
+                    o.type = begin->type;
+                    o.time = begin->create_time;
+                    for (; begin != end; ++begin) {
+                        o.price_token[to_u256(begin->price)] = to_u256(begin->token_amount);
+                    }
+                    return o;
+                }
+
+                result_order make_result_order(const order_result_object &obj) {
+                    result_order eo;
+                    eo.sender = obj.sender;
+                    eo.acceptor = obj.acceptor;
+                    eo.type = obj.type;
+                    eo.token_type = obj.token_type;
+                    eo.buy_type = obj.buy_type;
+                    eo.create_time = obj.create_time;
+                    eo.send_trxid = obj.send_trxid;
+                    eo.to_trxid = obj.to_trxid;
+                    eo.amount = obj.amount;
+                    eo.price = obj.price;
+                    eo.id = obj.id._id;
+                    return eo;
+                }
+
+                /// first position after the cursor in the Tag index of orders, or first after key if the
+                /// cursor order is gone or is not one of @a in_range.
+                template<typename Tag, typename Orders, typename Key, typename Pred>
+                typename Orders::template index<Tag>::type::const_iterator
+                resume_after(const Orders &orders, const order_cursor &after, const Key &key, Pred in_range) {
+                    const auto &by_trx = orders.template get<by_trx_id>();
+                    auto itr = by_trx.find(after.trxid);
+                    if (itr != by_trx.end() && in_range(*itr)) {
+                        return ++orders.template project<Tag>(itr);
+                    }
+                    return orders.template get<Tag>().lower_bound(key);
+                }
+
+                /// fills moved to the history store at most each block, bounds the commit stall.
+                const size_t c_archive_batch = 10000;
+            }
+
+            exchange_plugin::exchange_plugin(const boost::filesystem::path &data_dir, const segment_options &options)
+                    : db(new database(data_dir, options)), archive(new result_archive(data_dir / "history")) {
 
                 db->add_index<order_object_index>();
                 db->add_index<order_result_object_index>();
                 db->add_index<dynamic_object_index>();
+                db->add_index<order_level_object_index>();
+                db->add_index<block_checkpoint_object_index>();
 
 
                 if (!db->find<dynamic_object>()) {
                     db->create<dynamic_object>([](dynamic_object &obj) {
                     });
                 }
+
+                // database created before price levels, build them from the resting orders.
+                // undo history is dropped first like a rollback does, a block pending at a crash is not part of
+                // the levels, and the levels can not be undone apart from their orders.
+                if (db->get_index<order_level_object_index>().indices().empty() &&
+                    !db->get_index<order_object_index>().indices().empty()) {
+                    db->undo_all();
+                    order_book(*db).rebuild_levels();
+                }
             }
 
             exchange_plugin::~exchange_plugin() {
@@ -34,271 +95,407 @@ namespace dev {
 
             std::vector<result_order>
             exchange_plugin::insert_operation(const std::vector<order> &orders, bool reset, bool throw_exception) {
-                return db->with_write_lock([&]() {
-
-                    check_db();
+                check_db();
+                return write_locked([&]() {
+                    if (!reset && db->in_block()) {
+                        // recorded in the block session, the block is executed on one thread.
+                        // even one order may throw after it wrote fills, its own session drops them then.
+                        auto session = db->start_undo_session(true);
+                        auto result = match_orders(orders);
+                        session.squash();
+                        return result;
+                    }
                     auto session = db->start_undo_session(true);
-                    std::vector<result_order> result;
-//                    try {
-                        for (const auto &itr : orders) {
-                            if (itr.buy_type == order_buy_type::only_price) {
-                                for (const auto t :  itr.price_token) {
-                                    if (itr.type == order_type::buy) {
-                                        auto find_itr = get_buy_itr(itr.token_type, t.first);
-                                        process_only_price(find_itr.first, find_itr.second, itr, t.first, t.second,
-                                                           result,
-                                                           throw_exception);
-                                    } else { //sell
-                                        auto find_itr = get_sell_itr(itr.token_type, t.first);
-                                        process_only_price(find_itr.first, find_itr.second, itr, t.first, t.second,
-                                                           result,
-                                                           throw_exception);
-                                    }
-
-                                }
-                            } else {
-                                if (itr.price_token.size() != 1) {
-                                    BOOST_THROW_EXCEPTION(all_price_operation_error());
-                                }
-                                if (itr.type == order_type::buy) {
-                                    auto find_itr = get_buy_itr(itr.token_type, u256(-1));
-                                    auto total_price = itr.price_token.begin()->first;
-                                    auto begin = find_itr.first;
-                                    auto end = find_itr.second;
-                                    if (begin != end) {
-                                        while (total_price > 0 && begin != end) {
-                                            auto begin_total_price = begin->token_amount * begin->price;
-                                            result_order ret;
-                                            if (begin_total_price <= total_price) {   //
-                                                total_price -= begin_total_price;
-                                                ret.set_data(itr, begin, begin->token_amount, begin->price);
-                                                result.push_back(ret);
-                                                const auto rm_obj = db->find(begin->id);
-                                                begin++;
-                                                db->remove(*rm_obj);
-                                                update_dynamic_orders(false);
-                                            } else if (begin_total_price > total_price) {
-
-                                                auto can_buy_amount = total_price / begin->price;
-                                                if (can_buy_amount == 0) {
-                                                    break;
-                                                }
-                                                ret.set_data(itr, begin, can_buy_amount, begin->price);
-                                                result.push_back(ret);
-                                                const auto rm_obj = db->find(begin->id);
-                                                db->modify(*rm_obj, [&](order_object &obj) {
-                                                    obj.token_amount -= can_buy_amount;
-                                                });
-                                                begin++;
-                                            }
-
-                                            db->create<order_result_object>([&](order_result_object &obj) {
-                                                obj.set_data(ret);
-                                            });
-                                            update_dynamic_result_orders();
-                                        }
-                                    } else {
-                                        BOOST_THROW_EXCEPTION(all_price_operation_error());
-                                    }
-                                } else {   //all_price  , sell,
-                                    auto find_itr = get_sell_itr(itr.token_type, u256(0));
-                                    auto begin = find_itr.first;
-                                    auto end = find_itr.second;
-                                    auto total_amount = itr.price_token.begin()->second;
-                                    if (begin != end) {
-                                        while (total_amount > 0 && begin != end) {
-                                            result_order ret;
-                                            if (begin->token_amount >= total_amount) {
-                                                ret.set_data(itr, begin, total_amount, begin->price);
-                                                result.push_back(ret);
-                                                const auto rm_obj = db->find(begin->id);
-                                                db->modify(*rm_obj, [&](order_object &obj) {
-                                                    obj.token_amount -= total_amount;
-                                                });
-                                                total_amount = 0;
-                                            } else {
-                                                total_amount -= begin->token_amount;
-                                                ret.set_data(itr, begin, begin->token_amount, begin->price);
-                                                result.push_back(ret);
-                                                const auto rm_obj = db->find(begin->id);
-                                                begin++;
-                                                db->remove(*rm_obj);
-                                                update_dynamic_orders(false);
-                                            }
-                                            db->create<order_result_object>([&](order_result_object &obj) {
-                                                obj.set_data(ret);
-                                            });
-                                            update_dynamic_result_orders();
-                                        }
-                                    } else {
-                                        BOOST_THROW_EXCEPTION(all_price_operation_error());
-                                    }
-                                }
-
-
-                            }
+                    auto result = match_orders(orders);
+                    if (!reset) {
+                        session.push();
+                    }
+                    return result;
+                });
+            }
 
+            std::vector<result_order> exchange_plugin::match_orders(const std::vector<order> &orders) {
+                std::vector<result_order> result;
+                order_book book(*db);
+                for (const auto &itr : orders) {
+                    if (itr.buy_type == order_buy_type::only_price) {
+                        for (const auto &t :  itr.price_token) {
+                            book.match_only_price(itr, t.first, t.second, result);
                         }
-
-                        if (!reset) {
-                            session.push();
+                    } else {
+                        if (itr.price_token.size() != 1) {
+                            BOOST_THROW_EXCEPTION(all_price_operation_error());
+                        }
+                        if (itr.type == order_type::buy) {
+                            book.match_all_price_buy(itr, result);
+                        } else {   //all_price  , sell,
+                            book.match_all_price_sell(itr, result);
                         }
-//                    } catch (const dev::Exception &e) {
-//                        session.undo();
-//                        BOOST_THROW_EXCEPTION(e);
-//                    } catch (const std::exception &e) {
-//                        session.undo();
-//                        BOOST_THROW_EXCEPTION(e);
-//                    }catch (...){
-//                        session.undo();
-//                        BOOST_THROW_EXCEPTION(createOrderError());
-//                    }
+                    }
+                }
+                update_dynamic(book.delta());
+                return result;
+            }
 
-                    return result;
+            void exchange_plugin::begin_block() {
+                check_db();
+                write_locked([&]() {
+                    db->start_block();
                 });
             }
 
+            bool exchange_plugin::in_block() const {
+                check_db();
+                return db->in_block();
+            }
+
             std::vector<exchange_order> exchange_plugin::get_order_by_address(const Address &addr) const {
+                return get_order_by_address(addr, UINT32_MAX);
+            }
+
+            std::vector<exchange_order>
+            exchange_plugin::get_order_by_address(const Address &addr, uint32_t size, const order_cursor &after) const {
                 check_db();
-                std::vector<exchange_order> ret;
-
-                const auto &index = db->get_index<order_object_index>().indices().get<by_address>();
-                auto lower_itr = index.lower_bound(boost::tuple<Address, Time_ms>(addr, INT64_MAX));
-                auto up_itr = index.upper_bound(boost::tuple<Address, Time_ms>(addr, 0));
-                while (lower_itr != up_itr && lower_itr != index.end()) {
-                    ret.push_back(exchange_order(*lower_itr));
-                    lower_itr++;
-                }
+                return read_locked([&]() {
+                    std::vector<exchange_order> ret;
+
+                    const auto &orders = db->get_index<order_object_index>().indices();
+                    const auto &index = orders.get<by_address>();
+                    auto lower_itr = after.empty() ? index.lower_bound(boost::tuple<Address, Time_ms>(addr, INT64_MAX))
+                                                   : resume_after<by_address>(orders, after,
+                                                            boost::tuple<Address, Time_ms>(addr, after.create_time),
+                                                            [&](const order_object &o) { return o.sender == addr; });
+                    auto up_itr = index.upper_bound(boost::tuple<Address, Time_ms>(addr, 0));
+                    while (lower_itr != up_itr && lower_itr != index.end() && size > 0) {
+                        ret.push_back(exchange_order(*lower_itr));
+                        lower_itr++;
+                        size--;
+                    }
 
-                return ret;
+                    return ret;
+                });
             }
 
-            std::vector<exchange_order> exchange_plugin::get_orders(uint32_t size) const {
+            std::vector<exchange_order> exchange_plugin::get_orders(uint32_t size, const order_cursor &after) const {
                 check_db();
-                std::vector<exchange_order> ret;
-                const auto &index = db->get_index<order_object_index>().indices().get<by_price_less>();
-                auto begin = index.begin();
-                while (begin != index.end() && size > 0) {
-                    ret.push_back(exchange_order(*begin));
-                    begin++;
-                    size--;
-                }
-                return ret;
+                return read_locked([&]() {
+                    std::vector<exchange_order> ret;
+                    const auto &orders = db->get_index<order_object_index>().indices();
+                    const auto &index = orders.get<by_price_less>();
+                    auto begin = after.empty() ? index.begin()
+                                               : resume_after<by_price_less>(orders, after,
+                                                        boost::make_tuple(after.type, after.token_type, ex_number(after.price), after.create_time),
+                                                        [](const order_object &) { return true; });
+                    while (begin != index.end() && size > 0) {
+                        ret.push_back(exchange_order(*begin));
+                        begin++;
+                        size--;
+                    }
+                    return ret;
+                });
             }
 
-            std::vector<result_order> exchange_plugin::get_result_orders_by_news(uint32_t size) const {
+            std::vector<result_order> exchange_plugin::get_result_orders_by_news(uint32_t size, int64_t before) const {
                 check_db();
-                vector<result_order> ret;
-                const auto &index = db->get_index<order_result_object_index>().indices().get<by_greater_id>();
-                auto begin = index.begin();
-                while (begin != index.end() && size > 0) {
-                    result_order eo;
+                return read_locked([&]() {
+                    vector<result_order> ret;
+                    const auto &index = db->get_index<order_result_object_index>().indices().get<by_greater_id>();
+                    auto begin = index.lower_bound(order_result_object::id_type(before));
+                    while (begin != index.begin() && size > 0) {
+                        --begin;
+                        ret.push_back(make_result_order(*begin));
+                        size--;
+                    }
+                    if (size > 0 && archive) {
+                        // older fills are in the history store, below the oldest one kept in the segment.
+                        int64_t oldest = index.empty() ? before : std::min(before, index.begin()->id._id);
+                        auto older = archive->get_before(oldest, size);
+                        ret.insert(ret.end(), older.begin(), older.end());
+                    }
+                    return ret;
+                });
+            }
 
-                    eo.sender = begin->sender;
-                    eo.acceptor = begin->acceptor;
-                    eo.type = begin->type;
-                    eo.token_type = begin->token_type;
-                    eo.buy_type = begin->buy_type;
-                    eo.create_time = begin->create_time;
-                    eo.send_trxid = begin->send_trxid;
-                    eo.to_trxid = begin->to_trxid;
-                    eo.amount = begin->amount;
-                    eo.price = begin->price;
-
-                    ret.push_back(eo);
-                    begin++;
-                    size--;
+            void exchange_plugin::archive_results() {
+                auto hot = db->options().hot_results;
+                const auto &index = db->get_index<order_result_object_index>().indices().get<by_greater_id>();
+                if (!archive || hot == 0 || index.size() <= hot) {
+                    return;
+                }
+                // fills of blocks still on the undo stack stay, a rewind may need them.
+                const auto &stack = db->get_index<order_result_object_index>().stack();
+                int64_t horizon = stack.empty() ? INT64_MAX : stack.front().old_next_id._id;
+
+                size_t count = std::min<size_t>(index.size() - hot, c_archive_batch);
+                std::vector<std::pair<int64_t, result_order>> fills;
+                for (auto itr = index.begin(); itr != index.end() && fills.size() < count && itr->id._id < horizon; ++itr) {
+                    fills.emplace_back(itr->id._id, make_result_order(*itr));
+                }
+                // written first, a fill in both tiers is read from the segment.
+                archive->append(fills);
+                for (size_t i = 0; i < fills.size(); i++) {
+                    db->remove(*index.begin());
                 }
-                return ret;
             }
 
 
             bool exchange_plugin::rollback() {
                 check_db();
-                db->undo_all();
+                write_locked([&]() {
+                    const auto &index = db->get_index<block_checkpoint_object_index>().indices().get<by_id>();
+                    if (index.empty() || !db->undo_to(index.rbegin()->revision)) {
+                        db->undo_block();
+                        db->undo_all();
+                    }
+                });
                 return true;
             }
 
             bool exchange_plugin::commit(int64_t version) {
                 check_db();
-                const auto &obj = db->get<dynamic_object>();
-                db->modify(obj, [&](dynamic_object &obj) {
-                    obj.version = version;
+                write_locked([&]() {
+                    db->push_block();
+                    db->modify(get_dynamic_object(), [&](dynamic_object &obj) {
+                        obj.version = version;
+                    });
+                    // nothing stays undoable, so no checkpoint can be rewound to.
+                    db->commit(db->revision());
+                    const auto &index = db->get_index<block_checkpoint_object_index>().indices().get<by_id>();
+                    while (!index.empty()) {
+                        db->remove(*index.begin());
+                    }
+                    archive_results();
+                });
+                end_block();
+                return true;
+            }
+
+            bool exchange_plugin::commit(int64_t version, const h256 &block_hash) {
+                check_db();
+                write_locked([&]() {
+                    commit_checkpoint(version, block_hash);
                 });
-                db->commit(version);
-                db->flush();
-//                cwarn << "commit rollback version  exchange database version : " << obj.version << " orders: " << obj.orders << " ret_orders:" << obj.result_orders;
+                end_block();
                 return true;
             }
 
+            void exchange_plugin::commit_checkpoint(int64_t version, const h256 &block_hash) {
+                // every block gets a revision of its own, with or without exchange operations.
+                // the version, the checkpoint and the pruning are all in it, so undoing the block undoes them.
+                db->start_block();
+                db->modify(get_dynamic_object(), [&](dynamic_object &obj) {
+                    obj.version = version;
+                });
+                const auto &by_hash = db->get_index<block_checkpoint_object_index>().indices().get<by_block_hash>();
+                auto itr = by_hash.find(block_hash);
+                if (itr != by_hash.end()) {
+                    db->remove(*itr);
+                }
+                auto revision = db->revision();
+                db->create<block_checkpoint_object>([&](block_checkpoint_object &obj) {
+                    obj.block_hash = block_hash;
+                    obj.number = version - 1;
+                    obj.revision = revision;
+                });
 
-            std::vector<exchange_order>
-            exchange_plugin::get_order_by_type(order_type type, order_token_type token_type, uint32_t size) const {
+                const auto &index = db->get_index<block_checkpoint_object_index>().indices().get<by_id>();
+                while (index.size() > db->checkpoint_depth()) {
+                    db->remove(*index.begin());
+                }
+                db->push_block();
+                db->commit(index.begin()->revision);
+                archive_results();
+            }
+
+            void exchange_plugin::end_block() {
+                // no session is open here, the segment may move.
+                write_locked([&]() {
+                    db->grow_if_needed();
+                });
+                db->flush_step();
+            }
+
+            bool exchange_plugin::rewind_to(const h256 &block_hash) {
                 check_db();
-                vector<exchange_order> ret;
-                if (type == order_type::buy) {
-                    const auto &index_greater = db->get_index<order_object_index>().indices().get<by_price_greater>();
-                    auto find_lower = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::buy, token_type,
-                                                                                                u256(-1), 0);
-                    auto find_upper = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::buy, token_type,
-                                                                                                u256(0), INT64_MAX);
-                    auto begin = index_greater.lower_bound(find_lower);
-                    auto end = index_greater.upper_bound(find_upper);
-
-                    while (begin != end && size > 0) {
-                        ret.push_back(exchange_order(*begin));
-                        begin++;
-                        size--;
+                return write_locked([&]() {
+                    const auto &by_hash = db->get_index<block_checkpoint_object_index>().indices().get<by_block_hash>();
+                    auto itr = by_hash.find(block_hash);
+                    if (itr == by_hash.end()) {
+                        return false;
                     }
-                } else {
-                    const auto &index_less = db->get_index<order_object_index>().indices().get<by_price_less>();
-                    auto find_lower = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::sell, token_type,
-                                                                                                u256(0), 0);
-                    auto find_upper = boost::tuple<order_type, order_token_type, u256, Time_ms>(order_type::sell, token_type,
-                                                                                                u256(-1), INT64_MAX);
-                    auto begin = index_less.lower_bound(find_lower);
-                    auto end = index_less.upper_bound(find_upper);
-                    while (begin != end && size > 0) {
-                        ret.push_back(exchange_order(*begin));
-                        begin++;
-                        size--;
+                    return db->undo_to(itr->revision);
+                });
+            }
+
+            bool exchange_plugin::has_checkpoint(const h256 &block_hash) const {
+                check_db();
+                return read_locked([&]() {
+                    const auto &by_hash = db->get_index<block_checkpoint_object_index>().indices().get<by_block_hash>();
+                    auto itr = by_hash.find(block_hash);
+                    return itr != by_hash.end() && itr->revision >= db->undoable_revision();
+                });
+            }
+
+            h256 exchange_plugin::head_checkpoint() const {
+                check_db();
+                return read_locked([&]() {
+                    const auto &index = db->get_index<block_checkpoint_object_index>().indices().get<by_id>();
+                    return index.empty() ? h256() : index.rbegin()->block_hash;
+                });
+            }
+
+            void exchange_plugin::set_checkpoint_depth(uint32_t depth) {
+                check_db();
+                db->set_checkpoint_depth(depth);
+            }
+
+            uint32_t exchange_plugin::checkpoint_depth() const {
+                check_db();
+                return db->checkpoint_depth();
+            }
+
+
+            std::vector<exchange_order>
+            exchange_plugin::get_order_by_type(order_type type, order_token_type token_type, uint32_t size,
+                                               const order_cursor &after) const {
+                check_db();
+                return read_locked([&]() {
+                    vector<exchange_order> ret;
+                    const auto &orders = db->get_index<order_object_index>().indices();
+                    auto same_side = [&](const order_object &o) { return o.type == type && o.token_type == token_type; };
+                    auto resume_key = boost::make_tuple(type, token_type, ex_number(after.price), after.create_time);
+                    if (type == order_type::buy) {
+                        const auto &index_greater = orders.get<by_price_greater>();
+                        auto find_lower = boost::tuple<order_type, order_token_type, ex_number, Time_ms>(order_type::buy, token_type,
+                                                                                                    ex_number(u256(-1)), 0);
+                        auto find_upper = boost::tuple<order_type, order_token_type, ex_number, Time_ms>(order_type::buy, token_type,
+                                                                                                    ex_number(0), INT64_MAX);
+                        auto begin = after.empty() ? index_greater.lower_bound(find_lower)
+                                                   : resume_after<by_price_greater>(orders, after, resume_key, same_side);
+                        auto end = index_greater.upper_bound(find_upper);
+
+                        while (begin != end && size > 0) {
+                            ret.push_back(exchange_order(*begin));
+                            begin++;
+                            size--;
+                        }
+                    } else {
+                        const auto &index_less = orders.get<by_price_less>();
+                        auto find_lower = boost::tuple<order_type, order_token_type, ex_number, Time_ms>(order_type::sell, token_type,
+                                                                                                    ex_number(0), 0);
+                        auto find_upper = boost::tuple<order_type, order_token_type, ex_number, Time_ms>(order_type::sell, token_type,
+                                                                                                    ex_number(u256(-1)), INT64_MAX);
+                        auto begin = after.empty() ? index_less.lower_bound(find_lower)
+                                                   : resume_after<by_price_less>(orders, after, resume_key, same_side);
+                        auto end = index_less.upper_bound(find_upper);
+                        while (begin != end && size > 0) {
+                            ret.push_back(exchange_order(*begin));
+                            begin++;
+                            size--;
+                        }
                     }
-                }
-                return ret;
+                    return ret;
+                });
             }
 
+
             std::vector<order> exchange_plugin::cancel_order_by_trxid(const std::vector<h256> &os, bool reset) {
                 check_db();
-                auto session = db->start_undo_session(true);
-                std::vector<order> ret;
-                const auto &index_trx = db->get_index<order_object_index>().indices().get<by_trx_id>();
-                for (const auto &t : os) {
-                    auto begin = index_trx.lower_bound(t);
-                    auto end = index_trx.upper_bound(t);
-                    if (begin == end) {
-                        BOOST_THROW_EXCEPTION(find_order_trxid_error());
+                return write_locked([&]() {
+                    // in the block session, squashed into it like insert_operation.
+                    bool block = !reset && db->in_block();
+                    auto session = db->start_undo_session(true);
+                    std::vector<order> ret;
+                    order_book book(*db);
+                    const auto &index_trx = db->get_index<order_object_index>().indices().get<by_trx_id>();
+                    for (const auto &t : os) {
+                        auto begin = index_trx.lower_bound(t);
+                        auto end = index_trx.upper_bound(t);
+                        if (begin == end) {
+                            BOOST_THROW_EXCEPTION(find_order_trxid_error());
+                        }
+                        ret.push_back(make_order(begin, end));
+                        while (begin != end) {
+                            book.remove_order(*begin++);
+                        }
                     }
-                    order o;
-                    o.trxid = begin->trxid;
-                    o.sender = begin->sender;
-                    o.buy_type = order_buy_type::only_price;
-                    o.token_type = begin->token_type;
-                    o.type = begin->type;
-                    o.time = begin->create_time;
-                    while (begin != end) {
-                        o.price_token[begin->price] = begin->token_amount;
-                        const auto rm = db->find(begin->id);
-                        db->remove(*rm);
-                        begin++;
+                    update_dynamic(book.delta());
+
+                    if (block) {
+                        session.squash();
+                    } else if (!reset) {
+                        session.push();
                     }
-                    ret.push_back(o);
-                }
+                    return ret;
+                });
+            }
 
+            std::vector<order> exchange_plugin::get_order_by_trxid(const std::vector<h256> &os) const {
+                check_db();
+                return read_locked([&]() {
+                    std::vector<order> ret;
+                    const auto &index_trx = db->get_index<order_object_index>().indices().get<by_trx_id>();
+                    for (const auto &t : os) {
+                        auto range = index_trx.equal_range(t);
+                        if (range.first == range.second) {
+                            BOOST_THROW_EXCEPTION(find_order_trxid_error());
+                        }
+                        ret.push_back(make_order(range.first, range.second));
+                    }
+                    return ret;
+                });
+            }
 
-                if (!reset) {
-                    session.push();
-                }
-                return ret;
+            bool exchange_plugin::is_order_owner(const h256 &trxid, const Address &sender) const {
+                check_db();
+                return read_locked([&]() {
+                    const auto &index_trx = db->get_index<order_object_index>().indices().get<by_trx_id>();
+                    auto range = index_trx.equal_range(trxid);
+                    if (range.first == range.second) {
+                        return false;
+                    }
+                    for (auto itr = range.first; itr != range.second; ++itr) {
+                        if (itr->sender != sender) {
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+            }
+
+            std::vector<std::pair<u256, u256>>
+            exchange_plugin::get_depth(order_type type, order_token_type token_type, uint32_t size) const {
+                check_db();
+                return read_locked([&]() {
+                    std::vector<std::pair<u256, u256>> ret;
+                    auto push = [&](const order_level_object &level) {
+                        ret.push_back(std::make_pair(to_u256(level.price), to_u256(level.total_amount)));
+                    };
+                    if (type == order_type::buy) {
+                        const auto &index = db->get_index<order_level_object_index>().indices().get<by_level_greater>();
+                        auto begin = index.lower_bound(boost::make_tuple(order_type::buy, token_type, ex_number(u256(-1))));
+                        auto end = index.upper_bound(boost::make_tuple(order_type::buy, token_type, ex_number(0)));
+                        for (; begin != end && size > 0; ++begin, --size) {
+                            push(*begin);
+                        }
+                    } else {
+                        const auto &index = db->get_index<order_level_object_index>().indices().get<by_level_less>();
+                        auto begin = index.lower_bound(boost::make_tuple(order_type::sell, token_type, ex_number(0)));
+                        auto end = index.upper_bound(boost::make_tuple(order_type::sell, token_type, ex_number(u256(-1))));
+                        for (; begin != end && size > 0; ++begin, --size) {
+                            push(*begin);
+                        }
+                    }
+                    return ret;
+                });
+            }
+
+            fill_estimate exchange_plugin::estimate_fill(order_type type, order_token_type token_type, order_buy_type buy_type,
+                                                         const u256 &price, const u256 &amount) const {
+                check_db();
+                return read_locked([&]() {
+                    return order_book(*db).estimate(type, token_type, buy_type, price, amount);
+                });
             }
 
         }
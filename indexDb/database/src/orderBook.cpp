@@ -0,0 +1,309 @@
+#include <brc/orderBook.hpp>
+
+namespace dev {
+    namespace brc {
+        namespace ex {
+
+            namespace {
+                /// orders of token_type are matched with the other token book.
+                order_token_type match_token(order_token_type token_type) {
+                    return token_type == order_token_type::BRC ? order_token_type::FUEL : order_token_type::BRC;
+                }
+            }
+
+            void order_book::match_only_price(const order &od, const ex_number &price, const ex_number &amount,
+                                              std::vector<result_order> &result) {
+                if (od.type == order_type::buy) {
+                    auto levels = get_sell_levels(match_token(od.token_type), price);
+                    process_only_price(levels.first, levels.second, od, price, amount, result);
+                } else {
+                    auto levels = get_buy_levels(match_token(od.token_type), price);
+                    process_only_price(levels.first, levels.second, od, price, amount, result);
+                }
+            }
+
+            template<typename BEGIN, typename END>
+            void order_book::process_only_price(BEGIN begin, END end, const order &od, const ex_number &price,
+                                                const ex_number &amount, std::vector<result_order> &result) {
+                if (begin == end) {
+                    add_order(od, price, amount, amount);
+                    return;
+                }
+
+                ex_number spend = amount;
+                while (spend > 0 && begin != end) {
+                    const auto &level = *begin++;
+                    if (level.total_amount <= spend) {
+                        spend -= level.total_amount;
+                        fill_level(od, level, result);
+                        continue;
+                    }
+
+                    // level is larger than spend, it stays on book.
+                    ex_number filled = 0;
+                    uint64_t removed = 0;
+                    auto orders = get_level_orders(level);
+                    auto itr = orders.first;
+                    while (spend > 0 && itr != orders.second) {
+                        const auto &obj = *itr++;
+                        if (obj.token_amount <= spend) {
+                            spend -= obj.token_amount;
+                            filled += obj.token_amount;
+                            fill_order(od, obj, obj.token_amount, result);
+                            db.remove(obj);
+                            m_delta.orders--;
+                            removed++;
+                        } else {
+                            fill_order(od, obj, spend, result);
+                            db.modify(obj, [&](order_object &o) {
+                                o.token_amount -= spend;
+                            });
+                            filled += spend;
+                            spend = 0;
+                        }
+                    }
+                    update_level(level, filled, removed);
+                }
+
+                //surplus token ,  record to db
+                if (spend > 0) {
+                    add_order(od, price, amount, spend);
+                }
+            }
+
+            fill_estimate order_book::estimate(order_type type, order_token_type token_type, order_buy_type buy_type,
+                                               const u256 &price, const u256 &amount) const {
+                fill_estimate ret;
+                bool only_price = buy_type == order_buy_type::only_price;
+                if (type == order_type::buy) {
+                    auto levels = get_sell_levels(match_token(token_type), only_price ? price : u256(-1));
+                    estimate_levels(levels.first, levels.second, !only_price, price, amount, ret);
+                } else {
+                    auto levels = get_buy_levels(match_token(token_type), only_price ? price : u256(0));
+                    estimate_levels(levels.first, levels.second, false, price, amount, ret);
+                }
+                return ret;
+            }
+
+            template<typename BEGIN, typename END>
+            void order_book::estimate_levels(BEGIN begin, END end, bool spend_price, const u256 &price,
+                                             const u256 &amount, fill_estimate &ret) const {
+                // the orders of a level share its price, so a level is taken as a whole like the match does.
+                u256 left = spend_price ? price : amount;
+                for (; left > 0 && begin != end; ++begin) {
+                    u256 level_price = to_u256(begin->price);
+                    u256 level_amount = to_u256(begin->total_amount);
+                    u256 take;
+                    if (spend_price) {
+                        take = bigint(level_amount) * level_price <= left ? level_amount : left / level_price;
+                        if (take == 0) {
+                            break;
+                        }
+                        left -= take * level_price;
+                    } else {
+                        take = std::min(level_amount, left);
+                        left -= take;
+                    }
+                    ret.amount += take;
+                    ret.total_price += bigint(take) * level_price;
+                    ret.levels++;
+                }
+            }
+
+            void order_book::match_all_price_buy(const order &od, std::vector<result_order> &result) {
+                auto levels = get_sell_levels(match_token(od.token_type), u256(-1));
+                auto begin = levels.first;
+                auto end = levels.second;
+                if (begin == end) {
+                    BOOST_THROW_EXCEPTION(all_price_operation_error());
+                }
+
+                ex_number total_price = od.price_token.begin()->first;
+                bool stop = false;
+                while (!stop && total_price > 0 && begin != end) {
+                    const auto &level = *begin++;
+                    // the product of the aggregate may not fit u256 even when each order does.
+                    if (product_le(level.total_amount, level.price, total_price)) {
+                        total_price -= level.total_amount * level.price;
+                        fill_level(od, level, result);
+                        continue;
+                    }
+
+                    ex_number filled = 0;
+                    uint64_t removed = 0;
+                    auto orders = get_level_orders(level);
+                    auto itr = orders.first;
+                    while (total_price > 0 && itr != orders.second) {
+                        const auto &obj = *itr++;
+                        auto order_price = obj.token_amount * obj.price;
+                        if (order_price <= total_price) {
+                            total_price -= order_price;
+                            filled += obj.token_amount;
+                            fill_order(od, obj, obj.token_amount, result);
+                            db.remove(obj);
+                            m_delta.orders--;
+                            removed++;
+                        } else {
+                            auto can_buy_amount = total_price / obj.price;
+                            if (can_buy_amount == 0) {
+                                stop = true;
+                                break;
+                            }
+                            fill_order(od, obj, can_buy_amount, result);
+                            db.modify(obj, [&](order_object &o) {
+                                o.token_amount -= can_buy_amount;
+                            });
+                            filled += can_buy_amount;
+                        }
+                    }
+                    update_level(level, filled, removed);
+                }
+            }
+
+            void order_book::match_all_price_sell(const order &od, std::vector<result_order> &result) {
+                auto levels = get_buy_levels(match_token(od.token_type), u256(0));
+                auto begin = levels.first;
+                auto end = levels.second;
+                if (begin == end) {
+                    BOOST_THROW_EXCEPTION(all_price_operation_error());
+                }
+
+                ex_number total_amount = od.price_token.begin()->second;
+                while (total_amount > 0 && begin != end) {
+                    const auto &level = *begin++;
+                    if (level.total_amount < total_amount) {
+                        total_amount -= level.total_amount;
+                        fill_level(od, level, result);
+                        continue;
+                    }
+
+                    ex_number filled = 0;
+                    uint64_t removed = 0;
+                    auto orders = get_level_orders(level);
+                    auto itr = orders.first;
+                    while (total_amount > 0 && itr != orders.second) {
+                        const auto &obj = *itr++;
+                        if (obj.token_amount >= total_amount) {
+                            fill_order(od, obj, total_amount, result);
+                            db.modify(obj, [&](order_object &o) {
+                                o.token_amount -= total_amount;
+                            });
+                            filled += total_amount;
+                            total_amount = 0;
+                        } else {
+                            total_amount -= obj.token_amount;
+                            filled += obj.token_amount;
+                            fill_order(od, obj, obj.token_amount, result);
+                            db.remove(obj);
+                            m_delta.orders--;
+                            removed++;
+                        }
+                    }
+                    update_level(level, filled, removed);
+                }
+            }
+
+            void order_book::add_order(const order &od, const ex_number &price, const ex_number &source_amount,
+                                       const ex_number &amount) {
+                db.create<order_object>([&](order_object &obj) {
+                    obj.set_data(od, std::make_pair(price, source_amount), amount);
+                });
+                m_delta.orders++;
+
+                const auto &index = db.get_index<order_level_object_index>().indices().get<by_level_less>();
+                auto level = index.find(boost::make_tuple(od.type, od.token_type, price));
+                if (level == index.end()) {
+                    db.create<order_level_object>([&](order_level_object &obj) {
+                        obj.type = od.type;
+                        obj.token_type = od.token_type;
+                        obj.price = price;
+                        obj.total_amount = amount;
+                        obj.size = 1;
+                    });
+                } else {
+                    db.modify(*level, [&](order_level_object &obj) {
+                        obj.total_amount += amount;
+                        obj.size++;
+                    });
+                }
+            }
+
+            void order_book::remove_order(const order_object &obj) {
+                const auto &index = db.get_index<order_level_object_index>().indices().get<by_level_less>();
+                auto level = index.find(boost::make_tuple(obj.type, obj.token_type, obj.price));
+                if (level == index.end()) {
+                    BOOST_THROW_EXCEPTION(remove_object_error());
+                }
+                update_level(*level, obj.token_amount, 1);
+
+                db.remove(obj);
+                m_delta.orders--;
+            }
+
+            void order_book::rebuild_levels() {
+                const auto &levels = db.get_index<order_level_object_index>().indices();
+                while (!levels.empty()) {
+                    db.remove(*levels.begin());
+                }
+
+                const auto &index = db.get_index<order_object_index>().indices().get<by_price_less>();
+                auto itr = index.begin();
+                while (itr != index.end()) {
+                    auto orders = index.equal_range(boost::make_tuple(itr->type, itr->token_type, itr->price));
+                    ex_number total_amount = 0;
+                    uint64_t size = 0;
+                    for (auto o = orders.first; o != orders.second; o++) {
+                        total_amount += o->token_amount;
+                        size++;
+                    }
+                    db.create<order_level_object>([&](order_level_object &obj) {
+                        obj.type = itr->type;
+                        obj.token_type = itr->token_type;
+                        obj.price = itr->price;
+                        obj.total_amount = total_amount;
+                        obj.size = size;
+                    });
+                    itr = orders.second;
+                }
+            }
+
+            void order_book::fill_level(const order &od, const order_level_object &level,
+                                        std::vector<result_order> &result) {
+                auto orders = get_level_orders(level);
+                auto itr = orders.first;
+                while (itr != orders.second) {
+                    const auto &obj = *itr++;
+                    fill_order(od, obj, obj.token_amount, result);
+                    db.remove(obj);
+                    m_delta.orders--;
+                }
+                db.remove(level);
+            }
+
+            void order_book::update_level(const order_level_object &level, const ex_number &filled, uint64_t removed) {
+                if (removed >= level.size) {
+                    db.remove(level);
+                    return;
+                }
+                if (filled == 0 && removed == 0) {
+                    return;
+                }
+                db.modify(level, [&](order_level_object &obj) {
+                    obj.total_amount -= filled;
+                    obj.size -= removed;
+                });
+            }
+
+            void order_book::fill_order(const order &od, const order_object &obj, const ex_number &amount,
+                                        std::vector<result_order> &result) {
+                result_order ret(od, &obj, to_u256(amount), to_u256(obj.price));
+                db.create<order_result_object>([&](order_result_object &o) {
+                    o.set_data(ret);
+                });
+                m_delta.result_orders++;
+                result.push_back(ret);
+            }
+
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include <brc/resultArchive.hpp>
+
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/RLP.h>
+
+namespace dev {
+    namespace brc {
+        namespace ex {
+
+            namespace {
+                const std::string c_end_key = "end";
+
+                std::string id_key(int64_t id) {
+                    std::string ret(8, '\0');
+                    toBigEndian(static_cast<uint64_t>(id), ret);
+                    return ret;
+                }
+
+                db::Slice to_slice(const std::string &s) {
+                    return db::Slice(s.data(), s.size());
+                }
+
+                std::string encode(int64_t id, const result_order &o) {
+                    RLPStream s(11);
+                    s << static_cast<uint64_t>(id) << o.sender << o.acceptor
+                      << static_cast<uint8_t>(o.type) << static_cast<uint8_t>(o.token_type)
+                      << static_cast<uint8_t>(o.buy_type) << static_cast<uint64_t>(o.create_time)
+                      << o.send_trxid << o.to_trxid << o.amount << o.price;
+                    return asString(s.out());
+                }
+
+                result_order decode(const std::string &data) {
+                    RLP r(data);
+                    result_order o;
+                    o.id = static_cast<int64_t>(r[0].toInt<uint64_t>());
+                    o.sender = r[1].toHash<Address>();
+                    o.acceptor = r[2].toHash<Address>();
+                    o.type = static_cast<order_type>(r[3].toInt<uint8_t>());
+                    o.token_type = static_cast<order_token_type>(r[4].toInt<uint8_t>());
+                    o.buy_type = static_cast<order_buy_type>(r[5].toInt<uint8_t>());
+                    o.create_time = static_cast<Time_ms>(r[6].toInt<uint64_t>());
+                    o.send_trxid = r[7].toHash<h256>();
+                    o.to_trxid = r[8].toHash<h256>();
+                    o.amount = r[9].toInt<u256>();
+                    o.price = r[10].toInt<u256>();
+                    return o;
+                }
+            }
+
+            result_archive::result_archive(const boost::filesystem::path &path)
+                    : result_archive(db::DBFactory::create(path)) {
+            }
+
+            result_archive::result_archive(std::unique_ptr<db::DatabaseFace> db) : m_db(std::move(db)) {
+                auto end = m_db->lookup(to_slice(c_end_key));
+                if (end.size() == 8) {
+                    m_end = static_cast<int64_t>(fromBigEndian<uint64_t>(end));
+                }
+            }
+
+            void result_archive::append(const std::vector<std::pair<int64_t, result_order>> &fills) {
+                if (fills.empty()) {
+                    return;
+                }
+                int64_t end = m_end;
+                auto batch = m_db->createWriteBatch();
+                for (const auto &f : fills) {
+                    batch->insert(to_slice(id_key(f.first)), to_slice(encode(f.first, f.second)));
+                    end = std::max(end, f.first + 1);
+                }
+                batch->insert(to_slice(c_end_key), to_slice(id_key(end)));
+                m_db->commit(std::move(batch));
+                m_end = end;
+            }
+
+            std::vector<result_order> result_archive::get_before(int64_t before, uint32_t size) const {
+                std::vector<result_order> ret;
+                for (int64_t id = std::min<int64_t>(before, m_end) - 1; id >= 0 && size > 0; id--, size--) {
+                    auto data = m_db->lookup(to_slice(id_key(id)));
+                    if (data.empty()) {
+                        break;
+                    }
+                    ret.push_back(decode(data));
+                }
+                return ret;
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/random.hpp>
+
+#include <brc/compactNumber.hpp>
+#include <brc/types.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace boost::multi_index;
+using namespace dev;
+using namespace dev::brc::ex;
+
+/// insert/match throughput of the order_object price index, u256 against compact_u256.
+/// usage: bench_number [orders] [rounds]
+
+template<typename NUMBER>
+struct bench_order {
+    uint64_t id;
+    order_type type;
+    NUMBER price;
+    NUMBER token_amount;
+    Time_ms create_time;
+};
+
+struct by_bench_id;
+struct by_bench_price;
+
+template<typename NUMBER>
+using bench_index = multi_index_container<
+        bench_order<NUMBER>,
+        indexed_by<
+                ordered_unique<tag<by_bench_id>,
+                        member<bench_order<NUMBER>, uint64_t, &bench_order<NUMBER>::id> >,
+                ordered_non_unique<tag<by_bench_price>,
+                        composite_key<bench_order<NUMBER>,
+                                member<bench_order<NUMBER>, order_type, &bench_order<NUMBER>::type>,
+                                member<bench_order<NUMBER>, NUMBER, &bench_order<NUMBER>::price>,
+                                member<bench_order<NUMBER>, Time_ms, &bench_order<NUMBER>::create_time>
+                        >,
+                        composite_key_compare<std::less<order_type>, std::less<NUMBER>, std::less<Time_ms> >
+                >
+        >
+>;
+
+struct bench_input {
+    u256 price;
+    u256 amount;
+};
+
+std::vector<bench_input> make_input(size_t size) {
+    boost::mt19937 gen(7);
+    boost::uniform_int<uint64_t> price(1, 5000);
+    boost::uniform_int<uint64_t> amount(1, 100000);
+    std::vector<bench_input> ret;
+    for (size_t i = 0; i < size; i++) {
+        // exchange values carry 8 decimals.
+        ret.push_back({u256(price(gen)) * 100000000, u256(amount(gen)) * 100000000});
+    }
+    return ret;
+}
+
+template<typename NUMBER>
+std::pair<double, double> run(const std::vector<bench_input> &input, size_t rounds, u256 &check) {
+    // convert outside the timed loops, only the index and the arithmetic are measured.
+    std::vector<std::pair<NUMBER, NUMBER>> values;
+    for (const auto &in : input) {
+        values.push_back(std::make_pair(NUMBER(in.price), NUMBER(in.amount)));
+    }
+
+    double insert_ms = 0, match_ms = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        bench_index<NUMBER> index;
+        auto start = std::chrono::steady_clock::now();
+        uint64_t id = 0;
+        for (const auto &v : values) {
+            index.insert(bench_order<NUMBER>{id, order_type::sell, v.first, v.second, (Time_ms) id});
+            id++;
+        }
+        auto mid = std::chrono::steady_clock::now();
+
+        // buy takers walk the sell side from the lowest price, same shape as order_book::match_only_price.
+        auto &by_price = index.template get<by_bench_price>();
+        NUMBER total = 0;
+        const NUMBER zero = 0;
+        for (const auto &v : values) {
+            NUMBER spend = v.second;
+            auto end = by_price.upper_bound(boost::make_tuple(order_type::sell, v.first));
+            auto itr = by_price.lower_bound(boost::make_tuple(order_type::sell, zero));
+            while (spend > zero && itr != end) {
+                if (itr->token_amount <= spend) {
+                    spend -= itr->token_amount;
+                    total += itr->token_amount * itr->price;
+                    itr = by_price.erase(itr);
+                } else {
+                    total += spend * itr->price;
+                    by_price.modify(itr, [&](bench_order<NUMBER> &o) { o.token_amount -= spend; });
+                    spend = 0;
+                }
+            }
+        }
+        auto stop = std::chrono::steady_clock::now();
+        insert_ms += std::chrono::duration<double, std::milli>(mid - start).count();
+        match_ms += std::chrono::duration<double, std::milli>(stop - mid).count();
+        check = to_u256(total);
+    }
+    return std::make_pair(insert_ms / rounds, match_ms / rounds);
+}
+
+void report(const char *name, size_t size, const std::pair<double, double> &ms) {
+    std::cout << name << " insert: " << ms.first << " ms (" << size / ms.first * 1000 << " ops/s)"
+              << "  match: " << ms.second << " ms (" << size / ms.second * 1000 << " ops/s)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+    auto input = make_input(size);
+    std::cout << "orders: " << size << " rounds: " << rounds << std::endl;
+
+    u256 check_u256;
+    report("u256        ", size, run<u256>(input, rounds, check_u256));
+#ifdef __SIZEOF_INT128__
+    u256 check_compact;
+    report("compact_u256", size, run<compact_u256>(input, rounds, check_compact));
+    if (check_u256 != check_compact) {
+        std::cout << "mismatch: " << check_u256 << " != " << check_compact << std::endl;
+        return 1;
+    }
+#endif
+    return 0;
+}
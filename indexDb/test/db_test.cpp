@@ -11,6 +11,9 @@
 #include <boost/random.hpp>
 #include <boost/format.hpp>
 
+#include <atomic>
+#include <thread>
+
 
 #include <brc/database.hpp>
 #include <libdevcore/Address.h>
@@ -452,4 +455,510 @@ BOOST_AUTO_TEST_SUITE(test_brc_db)
     }
 
 
+    BOOST_AUTO_TEST_CASE(db_level_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::database db(cur_dir, chainbase::database::read_write, 1024 * 1024 * 64);
+        db.add_index<order_object_index>();
+        db.add_index<order_result_object_index>();
+        db.add_index<dynamic_object_index>();
+        db.add_index<order_level_object_index>();
+
+        auto check_levels = [&]() {
+            std::map<std::tuple<order_type, order_token_type, ex_number>, std::pair<ex_number, uint64_t>> levels;
+            for (const auto &o : db.get_index<order_object_index>().indices()) {
+                auto &l = levels[std::make_tuple(o.type, o.token_type, o.price)];
+                l.first += o.token_amount;
+                l.second++;
+            }
+            const auto &index = db.get_index<order_level_object_index>().indices();
+            BOOST_CHECK_EQUAL(index.size(), levels.size());
+            for (const auto &l : index) {
+                const auto &expect = levels[std::make_tuple(l.type, l.token_type, l.price)];
+                BOOST_CHECK(expect.first == l.total_amount);
+                BOOST_CHECK_EQUAL(expect.second, l.size);
+            }
+        };
+
+        auto test = random_orders(2000);
+        size_t i = 0;
+        for (const auto &os : test) {
+            auto session = db.start_undo_session(true);
+            order_book book(db);
+            std::vector<result_order> ret;
+            book.match_only_price(os, os.price_token.begin()->first, os.price_token.begin()->second, ret);
+            if (i++ % 5) {
+                session.push();
+            }
+        }
+        check_levels();
+
+        db.undo_all();
+        check_levels();
+
+        // a database without levels gets them on open, from its committed orders only.
+        auto old_dir = cur_dir.parent_path() / bbfs::unique_path();
+        {
+            dev::brc::ex::database old_db(old_dir, chainbase::database::read_write, 1024 * 1024 * 64);
+            old_db.add_index<order_object_index>();
+            old_db.add_index<order_level_object_index>();
+            for (const auto &os : test) {
+                old_db.create<order_object>([&](order_object &obj) {
+                    obj.set_data(os, *os.price_token.begin(), os.price_token.begin()->second);
+                });
+            }
+            // a block pending at a crash.
+            auto session = old_db.start_undo_session(true);
+            auto stale = test[0];
+            stale.trxid = h256(test.size());
+            old_db.create<order_object>([&](order_object &obj) {
+                obj.set_data(stale, *stale.price_token.begin(), stale.price_token.begin()->second);
+            });
+            session.push();
+        }
+        dev::brc::ex::exchange_plugin migrated(old_dir);
+        auto orders = migrated.get_orders(UINT32_MAX);
+        BOOST_CHECK_EQUAL(orders.size(), test.size());
+        BOOST_CHECK_THROW(migrated.get_order_by_trxid({h256(test.size())}), dev::find_order_trxid_error);
+        for (auto type : {order_type::buy, order_type::sell}) {
+            for (auto token_type : {order_token_type::BRC, order_token_type::FUEL}) {
+                u256 on_book = 0;
+                for (const auto &o : orders) {
+                    if (o.type == type && o.token_type == token_type) {
+                        on_book += o.token_amount;
+                    }
+                }
+                u256 in_levels = 0;
+                for (const auto &level : migrated.get_depth(type, token_type, UINT32_MAX)) {
+                    in_levels += level.second;
+                }
+                BOOST_CHECK(on_book == in_levels);
+            }
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_block_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        auto block_dir = cur_dir / bbfs::unique_path();
+        auto single_dir = cur_dir / bbfs::unique_path();
+
+        dev::brc::ex::exchange_plugin block_db(block_dir);
+        dev::brc::ex::exchange_plugin single_db(single_dir);
+        auto test = random_orders(1000);
+
+        // a dropped block leaves nothing.
+        block_db.begin_block();
+        BOOST_CHECK(block_db.in_block());
+        for (const auto &os : test) {
+            block_db.insert_operation({os}, false, true);
+        }
+        BOOST_CHECK(!block_db.get_orders(UINT32_MAX).empty());
+        block_db.rollback();
+        BOOST_CHECK(!block_db.in_block());
+        BOOST_CHECK(block_db.get_orders(UINT32_MAX).empty());
+
+        // a committed block matches like one session each operation and survives rollback.
+        block_db.begin_block();
+        for (const auto &os : test) {
+            auto ret = block_db.insert_operation({os}, false, true);
+            BOOST_CHECK_EQUAL(ret.size(), single_db.insert_operation({os}, false, true).size());
+        }
+        block_db.commit(1);
+        BOOST_CHECK(!block_db.in_block());
+        block_db.rollback();
+        single_db.commit(1);
+
+        BOOST_CHECK_EQUAL(block_db.get_orders(UINT32_MAX).size(), single_db.get_orders(UINT32_MAX).size());
+        BOOST_CHECK_EQUAL(block_db.check_version(false), single_db.check_version(false));
+
+        // one order which throws after its fills, its rest takes a trxid on book, leaves none of them in the block.
+        dev::brc::ex::exchange_plugin fail_db(cur_dir / bbfs::unique_path());
+        auto id = h256(test.size());
+        dx::order kept = test[0];
+        kept.trxid = id;
+        kept.type = dx::order_type::sell;
+        kept.token_type = dx::order_token_type::FUEL;
+        kept.buy_type = dx::order_buy_type::only_price;
+        kept.price_token.clear();
+        kept.price_token[u256(-1) - 1] = 10;
+        dx::order filled = kept;
+        filled.sender = get_address(test.size());
+        filled.trxid = h256(test.size() + 1);
+        filled.price_token.clear();
+        filled.price_token[1] = 10;
+        dx::order failing = filled;
+        failing.sender = get_address(test.size() + 1);
+        failing.trxid = id;
+        failing.type = dx::order_type::buy;
+        failing.token_type = dx::order_token_type::BRC;
+        failing.price_token.clear();
+        failing.price_token[1] = 20;
+        fail_db.begin_block();
+        fail_db.insert_operation({kept}, false, true);
+        fail_db.insert_operation({filled}, false, true);
+        auto version = fail_db.check_version(false);
+        auto size = fail_db.get_orders(UINT32_MAX).size();
+        auto fills = fail_db.get_result_orders_by_news(UINT32_MAX).size();
+        BOOST_CHECK_THROW(fail_db.insert_operation({failing}, false, true), std::exception);
+        BOOST_CHECK_EQUAL(fail_db.check_version(false), version);
+        BOOST_CHECK_EQUAL(fail_db.get_orders(UINT32_MAX).size(), size);
+        BOOST_CHECK_EQUAL(fail_db.get_result_orders_by_news(UINT32_MAX).size(), fills);
+        fail_db.rollback();
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_query_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::exchange_plugin db(cur_dir);
+        auto test = random_orders(1000);
+        auto rest = random_orders(200);
+        for (size_t i = 0; i < test.size(); i++) {
+            test[i].trxid = h256(rest.size() + i);
+        }
+        for (const auto &os : rest) {
+            db.insert_operation({os}, false, true);
+        }
+        db.commit(1);
+        auto version = db.check_version(false);
+
+        // every resting order is found with its owner, the book is not changed.
+        for (const auto &eo : db.get_orders(UINT32_MAX)) {
+            auto os = db.get_order_by_trxid({eo.trxid});
+            BOOST_CHECK_EQUAL(os.size(), 1);
+            BOOST_CHECK(os[0].sender == eo.sender);
+            BOOST_CHECK(db.is_order_owner(eo.trxid, eo.sender));
+            BOOST_CHECK(!db.is_order_owner(eo.trxid, Address(UINT32_MAX)));
+        }
+        BOOST_CHECK(!db.is_order_owner(h256(UINT32_MAX), Address(1)));
+        BOOST_CHECK_THROW(db.get_order_by_trxid({h256(UINT32_MAX)}), find_order_trxid_error);
+        BOOST_CHECK_EQUAL(db.check_version(false), version);
+
+        // the estimate takes what a match would.
+        for (const auto &os : test) {
+            auto price = os.price_token.begin()->first;
+            auto amount = os.price_token.begin()->second;
+            auto estimate = db.estimate_fill(os.type, os.token_type, os.buy_type, price, amount);
+            u256 filled = 0;
+            for (const auto &r : db.insert_operation({os}, true, true)) {
+                filled += r.amount;
+            }
+            BOOST_CHECK(estimate.amount == filled);
+        }
+        BOOST_CHECK_EQUAL(db.check_version(false), version);
+
+        auto depth = db.get_depth(order_type::sell, order_token_type::BRC, UINT32_MAX);
+        for (size_t i = 1; i < depth.size(); i++) {
+            BOOST_CHECK(depth[i - 1].first < depth[i].first);
+        }
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_checkpoint_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::exchange_plugin db(cur_dir);
+        db.set_checkpoint_depth(4);
+        auto test = random_orders(600);
+        std::vector<std::string> versions;
+        std::vector<size_t> sizes;
+        for (size_t i = 0; i < 6; i++) {
+            db.begin_block();
+            for (size_t j = i * 100; j < (i + 1) * 100; j++) {
+                db.insert_operation({test[j]}, false, true);
+            }
+            db.commit(i + 1, h256(i + 1));
+            versions.push_back(db.check_version(false));
+            sizes.push_back(db.get_orders(UINT32_MAX).size());
+        }
+        BOOST_CHECK(db.head_checkpoint() == h256(6));
+
+        // only the newest blocks stay undoable.
+        BOOST_CHECK(!db.has_checkpoint(h256(2)));
+        BOOST_CHECK(!db.rewind_to(h256(2)));
+        BOOST_CHECK_EQUAL(db.check_version(false), versions[5]);
+        BOOST_CHECK(db.has_checkpoint(h256(3)));
+
+        // rollback keeps the committed blocks, rewind goes back to one of them.
+        auto extra = test[0];
+        extra.trxid = h256(test.size());
+        db.begin_block();
+        db.insert_operation({extra}, false, true);
+        db.rollback();
+        BOOST_CHECK_EQUAL(db.check_version(false), versions[5]);
+        BOOST_CHECK(db.rewind_to(h256(4)));
+        BOOST_CHECK(db.head_checkpoint() == h256(4));
+        BOOST_CHECK(!db.has_checkpoint(h256(5)));
+        BOOST_CHECK_EQUAL(db.check_version(false), versions[3]);
+        BOOST_CHECK_EQUAL(db.get_orders(UINT32_MAX).size(), sizes[3]);
+
+        // the block is imported again on top of the checkpoint.
+        db.begin_block();
+        for (size_t j = 400; j < 500; j++) {
+            db.insert_operation({test[j]}, false, true);
+        }
+        db.commit(5, h256(5));
+        BOOST_CHECK_EQUAL(db.check_version(false), versions[4]);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_fork_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        // the calls of BlockChain::import and syncExchange: block P, then fork A (A1, A2) and a lighter fork B
+        // (B1, B2) on P. B2 cancels the order of B1, it only validates on the exchange state of its own branch.
+        dev::brc::ex::exchange_plugin db(cur_dir);
+        auto test = random_orders(200);
+        auto side = test[0];
+        side.trxid = h256(test.size());
+        const h256 p(1), a1(2), a2(3), b1(4);
+        auto enact_a = [&](size_t block) {
+            db.begin_block();
+            for (size_t j = block * 100; j < (block + 1) * 100; j++) {
+                db.insert_operation({test[j]}, false, true);
+            }
+        };
+        auto enact_b1 = [&]() {
+            db.begin_block();
+            db.insert_operation({side}, false, true);
+        };
+        // syncExchange(a1) once a block of fork B is done: P is the newest checkpoint on the branch of A1.
+        auto restore_a1 = [&]() {
+            BOOST_CHECK(db.rewind_to(p));
+            enact_a(0);
+            db.commit(2, a1);
+        };
+        db.begin_block();
+        db.commit(1, p);
+        enact_a(0);
+        db.commit(2, a1);
+        auto version = db.check_version(false);
+        auto size = db.get_orders(UINT32_MAX).size();
+
+        // B1 is not the best block: enacted on P, dropped by Block::cleanup(false), then A1 is enacted again.
+        BOOST_CHECK(db.rewind_to(p));
+        enact_b1();
+        BOOST_CHECK_EQUAL(db.get_orders(UINT32_MAX).size(), 1);
+        db.rollback();
+        BOOST_CHECK(db.head_checkpoint() == p);
+        restore_a1();
+        BOOST_CHECK(db.head_checkpoint() == a1);
+        BOOST_CHECK(!db.has_checkpoint(b1));
+        BOOST_CHECK_EQUAL(db.check_version(false), version);
+        BOOST_CHECK_EQUAL(db.get_orders(UINT32_MAX).size(), size);
+
+        // B2 fails on the exchange head, B1 is enacted again below it.
+        BOOST_CHECK_THROW(db.cancel_order_by_trxid({side.trxid}, true), dev::find_order_trxid_error);
+        BOOST_CHECK(db.rewind_to(p));
+        enact_b1();
+        db.commit(2, b1);
+        db.begin_block();
+        BOOST_CHECK_EQUAL(db.cancel_order_by_trxid({side.trxid}, false).size(), 1);
+        db.rollback();
+        BOOST_CHECK(db.head_checkpoint() == b1);
+        restore_a1();
+        BOOST_CHECK(db.head_checkpoint() == a1);
+        BOOST_CHECK(!db.has_checkpoint(b1));
+        BOOST_CHECK_EQUAL(db.get_orders(UINT32_MAX).size(), size);
+
+        // A2 extends the head, nothing is rewound.
+        enact_a(1);
+        db.commit(3, a2);
+        BOOST_CHECK(db.head_checkpoint() == a2);
+        BOOST_CHECK(db.has_checkpoint(a1));
+        BOOST_CHECK(db.rewind_to(p));
+        BOOST_CHECK(!db.has_checkpoint(a1));
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_segment_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::segment_options options;
+        options.initial_size = 4 * 1024 * 1024;
+        options.high_water = 50;
+        options.flush_chunk = 1024 * 1024;
+        size_t orders = 0;
+        {
+            dev::brc::ex::exchange_plugin db(cur_dir, options);
+            auto test = random_orders(5000);
+            for (size_t i = 0; i < 50; i++) {
+                db.begin_block();
+                for (size_t j = i * 100; j < (i + 1) * 100; j++) {
+                    db.insert_operation({test[j]}, false, true);
+                }
+                db.commit(i + 1, h256(i + 1));
+            }
+            orders = db.get_orders(UINT32_MAX).size();
+            // the checkpoints survive the segment moving.
+            BOOST_CHECK(db.has_checkpoint(h256(50)));
+        }
+        BOOST_CHECK(bbfs::file_size(cur_dir / "shared_memory.bin") > options.initial_size);
+
+        // reopened at the grown size.
+        dev::brc::ex::exchange_plugin db(cur_dir, options);
+        BOOST_CHECK_EQUAL(db.get_orders(UINT32_MAX).size(), orders);
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_history_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::segment_options options;
+        options.hot_results = 100;
+        dev::brc::ex::exchange_plugin db(cur_dir, options);
+        db.set_checkpoint_depth(2);
+        auto test = random_orders(3000);
+        size_t fills = 0;
+        for (size_t i = 0; i < 30; i++) {
+            db.begin_block();
+            for (size_t j = i * 100; j < (i + 1) * 100; j++) {
+                fills += db.insert_operation({test[j]}, false, true).size();
+            }
+            db.commit(i + 1, h256(i + 1));
+        }
+
+        // every fill is found once, newest first, across both tiers.
+        auto all = db.get_result_orders_by_news(UINT32_MAX);
+        BOOST_CHECK_EQUAL(all.size(), fills);
+        for (size_t i = 1; i < all.size(); i++) {
+            BOOST_CHECK_EQUAL(all[i - 1].id, all[i].id + 1);
+        }
+
+        // pages continue from the id of the last fill.
+        std::vector<dx::result_order> paged;
+        int64_t before = INT64_MAX;
+        while (true) {
+            auto page = db.get_result_orders_by_news(37, before);
+            if (page.empty()) {
+                break;
+            }
+            paged.insert(paged.end(), page.begin(), page.end());
+            before = page.back().id;
+        }
+        BOOST_CHECK_EQUAL(paged.size(), all.size());
+        for (size_t i = 0; i < paged.size() && i < all.size(); i++) {
+            BOOST_CHECK(paged[i].send_trxid == all[i].send_trxid);
+            BOOST_CHECK(paged[i].amount == all[i].amount);
+        }
+
+        // a rewind stays within the blocks that were not archived.
+        BOOST_CHECK(db.rewind_to(h256(29)));
+        BOOST_CHECK_EQUAL(db.get_result_orders_by_news(UINT32_MAX).size(), all.size() - (all[0].id - db.get_result_orders_by_news(1)[0].id));
+    }
+
+
+    BOOST_AUTO_TEST_CASE(db_grow_query_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::segment_options options;
+        options.initial_size = 4 * 1024 * 1024;
+        options.high_water = 50;
+        dev::brc::ex::exchange_plugin db(cur_dir, options);
+        auto test = random_orders(5000);
+
+        // queries from other threads while blocks are imported and the segment is mapped again.
+        std::atomic<bool> done{false};
+        std::atomic<size_t> queries{0};
+        std::atomic<size_t> bad{0};
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < 4; r++) {
+            readers.emplace_back([&, r]() {
+                while (!done) {
+                    for (const auto &o : db.get_orders(50)) {
+                        auto mine = db.get_order_by_address(o.sender, 10);
+                        bad += std::count_if(mine.begin(), mine.end(),
+                                             [&](const dx::exchange_order &m) { return m.sender != o.sender; });
+                    }
+                    auto side = db.get_order_by_type(r % 2 ? order_type::buy : order_type::sell, order_token_type::BRC, 50);
+                    bad += std::count_if(side.begin(), side.end(), [&](const dx::exchange_order &o) {
+                        return o.type != (r % 2 ? order_type::buy : order_type::sell);
+                    });
+                    db.get_result_orders_by_news(50);
+                    queries++;
+                }
+            });
+        }
+        for (size_t i = 0; i < 50; i++) {
+            db.begin_block();
+            for (size_t j = i * 100; j < (i + 1) * 100; j++) {
+                db.insert_operation({test[j]}, false, true);
+            }
+            db.commit(i + 1, h256(i + 1));
+        }
+        done = true;
+        for (auto &t : readers) {
+            t.join();
+        }
+
+        BOOST_CHECK(bbfs::file_size(cur_dir / "shared_memory.bin") > options.initial_size);
+        BOOST_CHECK(queries > 0);
+        BOOST_CHECK_EQUAL(bad.load(), 0u);
+    }
+    BOOST_AUTO_TEST_CASE(db_page_test) {
+        bbfs::path cur_dir = bbfs::current_path();
+        cur_dir /= bbfs::path("data");
+        cur_dir /= bbfs::unique_path();
+
+        dev::brc::ex::exchange_plugin db(cur_dir);
+        for (const auto &os : random_orders(500)) {
+            db.insert_operation({os}, false, true);
+        }
+        db.commit(1);
+
+        auto page_all = [&](std::function<std::vector<dx::exchange_order>(const dx::order_cursor &)> get) {
+            std::vector<dx::exchange_order> paged;
+            dx::order_cursor after;
+            while (true) {
+                auto page = get(after);
+                if (page.empty()) {
+                    break;
+                }
+                paged.insert(paged.end(), page.begin(), page.end());
+                after = dx::order_cursor(page.back());
+            }
+            return paged;
+        };
+        auto same = [](const std::vector<dx::exchange_order> &l, const std::vector<dx::exchange_order> &r) {
+            BOOST_CHECK_EQUAL(l.size(), r.size());
+            for (size_t i = 0; i < l.size() && i < r.size(); i++) {
+                BOOST_CHECK(l[i].trxid == r[i].trxid);
+            }
+        };
+
+        // walking the pages gives the full listing.
+        same(page_all([&](const dx::order_cursor &c) { return db.get_orders(23, c); }), db.get_orders(UINT32_MAX));
+        same(page_all([&](const dx::order_cursor &c) {
+                 return db.get_order_by_type(order_type::sell, order_token_type::BRC, 23, c);
+             }),
+             db.get_order_by_type(order_type::sell, order_token_type::BRC, UINT32_MAX));
+        auto owner = db.get_orders(1)[0].sender;
+        same(page_all([&](const dx::order_cursor &c) { return db.get_order_by_address(owner, 2, c); }),
+             db.get_order_by_address(owner));
+
+        // the next page stays in place when the order under the cursor is gone.
+        auto all = db.get_orders(UINT32_MAX);
+        dx::order_cursor after(all[100]);
+        db.cancel_order_by_trxid({all[100].trxid}, false);
+        std::vector<dx::exchange_order> rest(all.begin() + 101, all.begin() + 131);
+        same(db.get_orders(30, after), rest);
+    }
+
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -52,6 +52,16 @@ BRCSchedule const& ChainOperationParams::scheduleForBlockNumber(u256 const& _blo
         return FrontierSchedule;
 }
 
+unsigned ChainOperationParams::accountVersionForBlockNumber(u256 const& _blockNumber) const
+{
+    if (_blockNumber >= blockRewardTrieForkBlock)
+        return 2;
+    else if (_blockNumber >= voteTrieForkBlock)
+        return 1;
+    else
+        return 0;
+}
+
 u256 ChainOperationParams::blockReward(BRCSchedule const& _schedule) const
 {
     if (_schedule.blockRewardOverwrite)
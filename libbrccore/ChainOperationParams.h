@@ -59,6 +59,8 @@ private:
     u256 m_blockReward;
 public:
     BRCSchedule const& scheduleForBlockNumber(u256 const& _blockNumber) const;
+    /// @returns the account RLP version written at _blockNumber, see voteTrieForkBlock.
+    unsigned accountVersionForBlockNumber(u256 const& _blockNumber) const;
     u256 blockReward(BRCSchedule const& _schedule) const;
     void setBlockReward(u256 const& _newBlockReward);
     u256 maximumExtraDataSize = 1024;
@@ -75,6 +77,14 @@ public:
     u256 constantinopleForkBlock = c_initBlockNumer;
     u256 daoHardforkBlock = c_initBlockNumer;
     u256 experimentalForkBlock = c_initBlockNumer;
+    /// Accounts are written with the vote trie (version 1) and the block reward trie (version 2)
+    /// encodings from these blocks on, off unless configured. Version 2 includes version 1, so the block
+    /// reward trie fork can not come before the vote trie fork.
+    u256 voteTrieForkBlock = c_infiniteBlockNumer;
+    u256 blockRewardTrieForkBlock = c_infiniteBlockNumer;
+    /// Electors are ranked by poll and vote changes roll back the candidate's poll and the elector
+    /// set from this block on, off unless configured.
+    u256 electorRankingForkBlock = c_infiniteBlockNumer;
     int chainID = 0;    // Distinguishes different chains (mainnet, Ropsten, etc).
     int networkID = 0;  // Distinguishes different sub protocols.
 
@@ -74,8 +74,10 @@ DEV_SIMPLE_EXCEPTION(ZeroSignatureTransaction);
 DEV_SIMPLE_EXCEPTION(TooMuchTransaction);
 DEV_SIMPLE_EXCEPTION(UnknownTransactionValidationError);
 DEV_SIMPLE_EXCEPTION(UnknownError);
+DEV_SIMPLE_EXCEPTION(InvalidForkOrder);
 
 DEV_SIMPLE_EXCEPTION(InvalidDatabaseKind);
+DEV_SIMPLE_EXCEPTION(InvalidDatabaseProfile);
 DEV_SIMPLE_EXCEPTION(DatabaseAlreadyOpen);
 DEV_SIMPLE_EXCEPTION(DAGCreationFailure);
 DEV_SIMPLE_EXCEPTION(DAGComputeFailure);
@@ -0,0 +1,175 @@
+#include "CodeAnalysis.h"
+#include "ThreadedCode.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::brc;
+
+thread_local h256 CodeAnalysisCache::t_codeHash;
+
+namespace
+{
+uint64_t bigEndian64(byte const* _b)
+{
+    uint64_t ret = 0;
+    for (size_t i = 0; i < 8; ++i)
+        ret = (ret << 8) | _b[i];
+    return ret;
+}
+}
+
+CodeAnalysis::CodeAnalysis(bytesConstRef _code):
+    codeSize(_code.size()),
+    code(_code.size() + 33),
+    jumpDests((_code.size() + 63) / 64)
+{
+    if (!_code.empty())
+        std::memcpy(code.data(), _code.data(), _code.size());
+
+    for (size_t pc = 0; pc < codeSize; ++pc)
+    {
+        Instruction op = Instruction(code[pc]);
+
+        // make synthetic ops in user code trigger invalid instruction if run
+        if (op == Instruction::PUSHC || op == Instruction::JUMPC || op == Instruction::JUMPCI)
+            code[pc] = (byte)Instruction::INVALID;
+
+        if (op == Instruction::JUMPDEST)
+            jumpDests[pc / 64] |= uint64_t(1) << (pc % 64);
+        else if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+        {
+            size_t const nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
+            if ((byte)op >= (byte)c_firstPooledPush)
+            {
+                // The data past the end of the code reads as the zeros of the padding.
+                byte word[32] = {};
+                std::memcpy(word + 32 - nPush, &code[pc + 1], nPush);
+                u256 val = 0;
+                for (size_t i = 0; i < 32; i += 8)
+                    val = (val << 64) | bigEndian64(word + i);
+                uint32_t const index = pool.size();
+                pool.push_back(val);
+                std::memcpy(&code[pc + 1], &index, sizeof(index));
+            }
+            pc += nPush;
+        }
+    }
+}
+
+size_t CodeAnalysis::cost() const
+{
+    return sizeof(CodeAnalysis) + code.capacity() + jumpDests.capacity() * sizeof(uint64_t) +
+           pool.capacity() * sizeof(u256);
+}
+
+shared_ptr<CodeAnalysis const> CodeAnalysisCache::analysis(h256 const& _codeHash, bytesConstRef _code)
+{
+    if (!_codeHash)
+        return make_shared<CodeAnalysis const>(_code);
+
+    {
+        ReadGuard l(x_cache);
+        auto it = m_entries.find(_codeHash);
+        if (it != m_entries.end() && it->second.analysis->codeSize == _code.size())
+        {
+            ++m_hits;
+            it->second.referenced = true;
+            return it->second.analysis;
+        }
+    }
+    ++m_misses;
+
+    // Analysed outside the lock: two threads may both analyse the same code, one result is kept.
+    auto ret = make_shared<CodeAnalysis const>(_code);
+    size_t const cost = ret->cost();
+
+    WriteGuard l(x_cache);
+    if (cost > m_budget || m_entries.count(_codeHash))
+        return ret;
+    Entry& e = m_entries[_codeHash];
+    e.analysis = ret;
+    e.cost = cost;
+    m_clock.push_back(_codeHash);
+    m_charged += cost;
+    shrink();
+    return ret;
+}
+
+shared_ptr<ThreadedCode const> CodeAnalysisCache::threadedCode(h256 const& _codeHash,
+    bytesConstRef _code,
+    function<shared_ptr<ThreadedCode const>(shared_ptr<CodeAnalysis const>)> const& _translate)
+{
+    if (_codeHash)
+    {
+        ReadGuard l(x_cache);
+        auto it = m_entries.find(_codeHash);
+        if (it != m_entries.end() && it->second.threaded && it->second.analysis->codeSize == _code.size())
+        {
+            ++m_hits;
+            it->second.referenced = true;
+            return it->second.threaded;
+        }
+    }
+
+    auto const codeAnalysis = analysis(_codeHash, _code);
+    ++m_translations;
+    auto ret = _translate(codeAnalysis);
+    if (!_codeHash)
+        return ret;
+
+    // Kept only with the analysis it was made from, which may have been evicted meanwhile.
+    WriteGuard l(x_cache);
+    auto it = m_entries.find(_codeHash);
+    if (it == m_entries.end() || it->second.analysis != codeAnalysis || it->second.threaded)
+        return ret;
+    size_t const cost = ret->cost();
+    it->second.threaded = ret;
+    it->second.cost += cost;
+    m_charged += cost;
+    shrink();
+    return ret;
+}
+
+void CodeAnalysisCache::setBudget(size_t _bytes)
+{
+    WriteGuard l(x_cache);
+    m_budget = _bytes;
+    shrink();
+}
+
+void CodeAnalysisCache::clear()
+{
+    WriteGuard l(x_cache);
+    m_entries.clear();
+    m_clock.clear();
+    m_charged = 0;
+}
+
+CodeAnalysisCache::Stats CodeAnalysisCache::stats() const
+{
+    Stats ret;
+    ret.hits = m_hits;
+    ret.misses = m_misses;
+    ret.evictions = m_evictions;
+    ret.translations = m_translations;
+    return ret;
+}
+
+void CodeAnalysisCache::shrink()
+{
+    while (m_charged > m_budget && !m_clock.empty())
+    {
+        h256 const hash = m_clock.front();
+        m_clock.pop_front();
+        auto it = m_entries.find(hash);
+        if (it->second.referenced)
+        {
+            it->second.referenced = false;
+            m_clock.push_back(hash);
+            continue;
+        }
+        m_charged -= it->second.cost;
+        m_entries.erase(it);
+        ++m_evictions;
+    }
+}
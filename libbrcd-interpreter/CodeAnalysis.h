@@ -0,0 +1,144 @@
+#pragma once
+
+#include <libbvm/Instruction.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace dev
+{
+namespace brc
+{
+
+/**
+ * @brief What the interpreters work out from a contract before running it.
+ * The code is copied and padded with 33 zero bytes, so PUSH data and the opcode after it can be
+ * read past the end without bounds checks. The synthetic interpreter opcodes are made INVALID.
+ * The data of PUSH5 to PUSH32 is decoded into the constant pool and its first four bytes are
+ * replaced by the index of the constant; the opcode stays, so tracers see the original one.
+ * The analysis never changes once made, so one is shared by every frame running the code.
+ */
+struct CodeAnalysis
+{
+    /// Smallest PUSH whose data holds a pool index.
+    static constexpr Instruction c_firstPooledPush = Instruction::PUSH5;
+
+    explicit CodeAnalysis(bytesConstRef _code);
+
+    bool isJumpDest(uint64_t _pc) const
+    {
+        return _pc < codeSize && (jumpDests[_pc / 64] >> (_pc % 64) & 1);
+    }
+
+    /// @returns the pool index written in the data of the pooled PUSH at @a _data.
+    static uint32_t poolIndex(byte const* _data)
+    {
+        uint32_t ret;
+        std::memcpy(&ret, _data, sizeof(ret));
+        return ret;
+    }
+
+    /// Approximate memory held, for the cache budget.
+    size_t cost() const;
+
+    size_t codeSize;
+    bytes code;
+    /// One bit per byte of code, set on the JUMPDEST opcodes.
+    std::vector<uint64_t> jumpDests;
+    std::vector<u256> pool;
+};
+
+struct ThreadedCode;
+
+/**
+ * @brief Process-wide cache of code analyses keyed by code hash, shared by LegacyVM and the
+ * interpreter so contracts called again in a block, or from nested calls, are analysed once.
+ * When the analyses take more than the budget, victims are picked by a CLOCK sweep over the
+ * insertion order: an analysis used since the hand last passed it gets a second chance.
+ * The translation of the code for the threaded dispatch is kept with its analysis.
+ * @threadsafe
+ */
+class CodeAnalysisCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t translations = 0;
+    };
+
+    /// @returns the analysis of @a _code, whose hash is @a _codeHash. Without a hash the code is
+    /// analysed every time.
+    std::shared_ptr<CodeAnalysis const> analysis(h256 const& _codeHash, bytesConstRef _code);
+
+    /// @returns the translation of @a _code for the threaded dispatch, made by @a _translate from
+    /// the analysis of the code the first time.
+    std::shared_ptr<ThreadedCode const> threadedCode(h256 const& _codeHash, bytesConstRef _code,
+        std::function<std::shared_ptr<ThreadedCode const>(std::shared_ptr<CodeAnalysis const>)> const&
+            _translate);
+
+    /// A budget of 0 disables the cache.
+    void setBudget(size_t _bytes);
+    void clear();
+
+    Stats stats() const;
+
+    static CodeAnalysisCache& instance() { static CodeAnalysisCache cache; return cache; }
+
+    /**
+     * The interpreter is reached through BVMC, whose messages have no code hash. The host names
+     * the hash of the code it is about to run for the duration of the scope, on its own thread.
+     */
+    class CodeHashScope
+    {
+    public:
+        explicit CodeHashScope(h256 const& _codeHash): m_previous(t_codeHash) { t_codeHash = _codeHash; }
+        ~CodeHashScope() { t_codeHash = m_previous; }
+
+        CodeHashScope(CodeHashScope const&) = delete;
+        CodeHashScope& operator=(CodeHashScope const&) = delete;
+
+    private:
+        h256 const m_previous;
+    };
+
+    /// @returns the hash named by the innermost CodeHashScope of this thread, zero if none.
+    static h256 const& currentCodeHash() { return t_codeHash; }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<CodeAnalysis const> analysis;
+        std::shared_ptr<ThreadedCode const> threaded;
+        size_t cost;
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    /// Evicts until the budget holds. Must be called with x_cache write-locked.
+    void shrink();
+
+    static thread_local h256 t_codeHash;
+
+    mutable SharedMutex x_cache;
+    std::unordered_map<h256, Entry> m_entries;
+    /// Insertion order, the hand is at the front.
+    std::deque<h256> m_clock;
+    size_t m_charged = 0;
+    size_t m_budget = 32 * 1024 * 1024;
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_evictions{0};
+    std::atomic<uint64_t> m_translations{0};
+};
+
+}
+}
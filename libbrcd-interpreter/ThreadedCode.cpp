@@ -0,0 +1,155 @@
+#include "ThreadedCode.h"
+#include "VM.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::brc;
+
+namespace
+{
+/// The cases of these set the whole of m_runGas themselves, their gas is not charged by the block.
+bool chargedByCase(Instruction _op)
+{
+    switch (_op)
+    {
+    case Instruction::SHA3:
+    case Instruction::EXP:
+    case Instruction::BALANCE:
+    case Instruction::EXTCODESIZE:
+    case Instruction::EXTCODECOPY:
+    case Instruction::BLOCKHASH:
+    case Instruction::SLOAD:
+    case Instruction::SSTORE:
+    case Instruction::LOG0:
+    case Instruction::LOG1:
+    case Instruction::LOG2:
+    case Instruction::LOG3:
+    case Instruction::LOG4:
+    case Instruction::CREATE:
+    case Instruction::CREATE2:
+    case Instruction::CALL:
+    case Instruction::CALLCODE:
+    case Instruction::DELEGATECALL:
+    case Instruction::STATICCALL:
+    case Instruction::SUICIDE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// The instructions after which a new block starts: those leaving the straight line, and those
+/// seeing or handing on the gas left, which must not include the gas of the instructions after.
+bool endsBlock(Instruction _op)
+{
+    switch (_op)
+    {
+    case Instruction::JUMP:
+    case Instruction::JUMPI:
+    case Instruction::STOP:
+    case Instruction::RETURN:
+    case Instruction::REVERT:
+    case Instruction::SUICIDE:
+    case Instruction::INVALID:
+    case Instruction::GAS:
+    case Instruction::CREATE:
+    case Instruction::CREATE2:
+    case Instruction::CALL:
+    case Instruction::CALLCODE:
+    case Instruction::DELEGATECALL:
+    case Instruction::STATICCALL:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+ThreadedCode::ThreadedCode(shared_ptr<CodeAnalysis const> _analysis,
+    bvmc_instruction_metrics const* _metrics, void const* const* _labels):
+    analysis(move(_analysis)),
+    targets(analysis->codeSize)
+{
+    byte const* const code = analysis->code.data();
+    size_t const codeSize = analysis->codeSize;
+    instrs.reserve(codeSize + 2);
+
+    auto const emit = [&](Instruction _op, uint64_t _pc, uint32_t _arg) {
+        instrs.push_back({_labels ? _labels[(byte)_op] : nullptr, _op, uint32_t(_pc), _arg});
+    };
+
+    size_t const noBlock = size_t(-1);
+    size_t block = noBlock;
+    for (uint64_t pc = 0; pc < codeSize;)
+    {
+        Instruction const op = Instruction(code[pc]);
+        if (op == Instruction::JUMPDEST)
+        {
+            block = instrs.size();
+            targets[pc] = block;
+            emit(op, pc, VMSchedule::jumpdestGas);
+            ++pc;
+            continue;
+        }
+        if (block == noBlock)
+        {
+            block = instrs.size();
+            emit(Instruction::JUMPDEST, pc, 0);
+        }
+
+        int const gas = _metrics[(byte)op].gas_cost;
+        if (gas < 0)
+        {
+            // Undefined here, the case throws.
+            emit(op, pc, 0);
+            block = noBlock;
+            ++pc;
+            continue;
+        }
+        if (!chargedByCase(op))
+            instrs[block].arg += gas;
+
+        if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+        {
+            size_t const nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
+            u256 val = 0;
+            if ((byte)op >= (byte)CodeAnalysis::c_firstPooledPush)
+                val = analysis->pool[CodeAnalysis::poolIndex(&code[pc + 1])];
+            else
+                for (size_t i = 1; i <= nPush; ++i)
+                    val = (val << 8) | code[pc + i];
+            emit(Instruction::PUSHC, pc, pool.size());
+            pool.push_back(val);
+            pc += nPush + 1;
+            continue;
+        }
+
+        // The destination pushed right before is known here, its entry once all are translated.
+        Instr const& last = instrs.back();
+        if ((op == Instruction::JUMP || op == Instruction::JUMPI) && last.op == Instruction::PUSHC &&
+            pool[last.arg] < codeSize && analysis->isJumpDest(uint64_t(pool[last.arg])))
+            emit(op == Instruction::JUMP ? Instruction::JUMPC : Instruction::JUMPCI, pc,
+                uint32_t(pool[last.arg]));
+        else
+            emit(op, pc, 0);
+
+        if (endsBlock(op))
+            block = noBlock;
+        ++pc;
+    }
+
+    // Running off the end of the code stops.
+    if (block == noBlock)
+        emit(Instruction::JUMPDEST, codeSize, 0);
+    emit(Instruction::STOP, codeSize, 0);
+
+    for (Instr& instr : instrs)
+        if (instr.op == Instruction::JUMPC || instr.op == Instruction::JUMPCI)
+            instr.arg = targets[instr.arg];
+}
+
+size_t ThreadedCode::cost() const
+{
+    return sizeof(ThreadedCode) + instrs.capacity() * sizeof(Instr) +
+           pool.capacity() * sizeof(u256) + targets.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CodeAnalysis.h"
+
+#include <bvmc/instructions.h>
+
+namespace dev
+{
+namespace brc
+{
+
+/**
+ * @brief A contract translated for the threaded dispatch of the interpreter.
+ * Every instruction is one entry holding the address of its case, so the interpreter goes from
+ * one case to the next without decoding the bytecode. Every basic block starts with a JUMPDEST
+ * entry, a real one or one made up, which charges the static gas of the whole block; the cases
+ * only charge the gas worked out when they run. The PUSH immediates are decoded into the pool
+ * and their entries are PUSHC. A JUMP or JUMPI right after the PUSH of a valid destination
+ * becomes a JUMPC or JUMPCI holding the index of the destination entry.
+ * The translation never changes once made, so one is shared by every frame running the code.
+ */
+struct ThreadedCode
+{
+    struct Instr
+    {
+        /// Address of the case, null when the interpreter dispatches with a switch.
+        void const* label;
+        Instruction op;
+        /// Offset of the instruction in the bytecode.
+        uint32_t pc;
+        /// Pool index for PUSHC, entry index for JUMPC and JUMPCI, block gas for JUMPDEST.
+        uint32_t arg;
+    };
+
+    /// @param _metrics the metrics of the interpreter, for the static gas of the instructions.
+    /// @param _labels the case addresses of the interpreter by opcode, or null.
+    ThreadedCode(std::shared_ptr<CodeAnalysis const> _analysis,
+        bvmc_instruction_metrics const* _metrics, void const* const* _labels);
+
+    /// @returns the entry starting the block at the JUMPDEST at @a _pc.
+    Instr const* target(uint64_t _pc) const { return instrs.data() + targets[_pc]; }
+
+    /// Approximate memory held, for the cache budget.
+    size_t cost() const;
+
+    /// The analysis translated, for the checks of the jump destinations.
+    std::shared_ptr<CodeAnalysis const> analysis;
+    std::vector<Instr> instrs;
+    std::vector<u256> pool;
+    /// Entry index by offset, set at the JUMPDEST offsets only.
+    std::vector<uint32_t> targets;
+};
+
+}
+}
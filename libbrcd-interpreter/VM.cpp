@@ -1,5 +1,6 @@
 #include "interpreter.h"
 #include "VM.h"
+#include "Word256.h"
 
 #include <brcd/buildinfo.h>
 
@@ -21,11 +22,13 @@ void delete_output(const bvmc_result* result)
     delete[] result->output_data;
 }
 
+template <bool Threaded>
 bvmc_result execute(bvmc_instance* _instance, bvmc_context* _context, bvmc_revision _rev,
     const bvmc_message* _msg, uint8_t const* _code, size_t _codeSize) noexcept
 {
     (void)_instance;
-    std::unique_ptr<dev::brc::VM> vm{new dev::brc::VM};
+    auto vm = dev::brc::VMPool<dev::brc::VM>::acquire();
+    vm->m_threadedDispatch = Threaded;
 
     bvmc_result result = {};
     dev::brc::owning_bytes_ref output;
@@ -88,6 +91,7 @@ bvmc_result execute(bvmc_instance* _instance, bvmc_context* _context, bvmc_revis
         result.output_size = output.size();
         result.release = delete_output;
     }
+    dev::brc::VMPool<dev::brc::VM>::release(std::move(vm));
 
     return result;
 }
@@ -101,7 +105,22 @@ extern "C" bvmc_instance* bvmc_create_interpreter() noexcept
         "interpreter",
         brcd_get_buildinfo()->project_version,
         ::destroy,
-        ::execute,
+        ::execute<false>,
+        getCapabilities,
+        nullptr,  // set_tracer
+        nullptr,  // set_option
+    };
+    return &s_instance;
+}
+
+extern "C" bvmc_instance* bvmc_create_threaded_interpreter() noexcept
+{
+    static bvmc_instance s_instance{
+        BVMC_ABI_VERSION,
+        "threaded",
+        brcd_get_buildinfo()->project_version,
+        ::destroy,
+        ::execute<true>,
         getCapabilities,
         nullptr,  // set_tracer
         nullptr,  // set_option
@@ -119,18 +138,6 @@ uint64_t VM::memNeed(u256 _offset, u256 _size)
     return toInt63(_size ? u512(_offset) + _size : u512(0));
 }
 
-template <class S>
-S divWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) / s512(_b));
-}
-
-template <class S>
-S modWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) % s512(_b));
-}
-
 
 //
 // for decoding destinations of JUMPTO, JUMPV, JUMPSUB and JUMPSUBV
@@ -232,6 +239,18 @@ void VM::fetchInstruction()
     m_copyMemSize = 0;
 }
 
+void VM::fetchTranslated()
+{
+    m_OP = m_ip->op;
+    auto const metric = c_metrics[static_cast<size_t>(m_OP)];
+    adjustStack(metric.num_stack_arguments, metric.num_stack_returned_items);
+
+    // The JUMPDEST starting the block charged the static gas.
+    m_runGas = 0;
+    m_newMemSize = m_mem.size();
+    m_copyMemSize = 0;
+}
+
 bvmc_tx_context const& VM::getTxContext()
 {
     if (!m_tx_context)
@@ -254,6 +273,10 @@ owning_bytes_ref VM::exec(bvmc_context* _context, bvmc_revision _rev, const bvmc
     m_PC = 0;
     m_pCode = _code;
     m_codeSize = _codeSize;
+    if (m_threadedDispatch)
+        m_interpret = &VM::interpretCases<true>;
+    else
+        m_interpret = &VM::interpretCases<false>;
 
     // trampoline to minimize depth of call stack when calling out
     m_bounce = &VM::initEntry;
@@ -264,12 +287,44 @@ owning_bytes_ref VM::exec(bvmc_context* _context, bvmc_revision _rev, const bvmc
     return std::move(m_output);
 }
 
+owning_bytes_ref VM::frameOutput(uint64_t _begin, uint64_t _size)
+{
+    // A pooled instance keeps its memory for the next frame, the output is a copy.
+    if (!vmPoolCapacity())
+        return owning_bytes_ref{std::move(m_mem), _begin, _size};
+    if (!_size)
+        return owning_bytes_ref{};
+    return owning_bytes_ref{bytes(m_mem.data() + _begin, m_mem.data() + _begin + _size), 0, _size};
+}
+
+void VM::reset()
+{
+    recycleBuffer(m_mem);
+    recycleBuffer(m_returnData);
+    m_output = owning_bytes_ref{};
+    m_context = nullptr;
+    m_message = nullptr;
+    m_tx_context.reset();
+    m_analysis.reset();
+    m_pCode = nullptr;
+    m_codeSize = 0;
+    m_code = nullptr;
+    m_pool = nullptr;
+    m_threaded.reset();
+    m_ip = nullptr;
+    m_nSteps = 0;
+    m_SP = m_SPP = m_stackEnd;
+}
+
 //
 // main interpreter loop and switch
 //
+template <bool Threaded>
 void VM::interpretCases()
 {
     INIT_CASES
+    if (Threaded && !m_ip)
+        translate(DISPATCH_TABLE);
     DO_CASES
     {
         //
@@ -323,7 +378,7 @@ void VM::interpretCases()
 
             uint64_t b = (uint64_t)m_SP[0];
             uint64_t s = (uint64_t)m_SP[1];
-            m_output = owning_bytes_ref{std::move(m_mem), b, s};
+            m_output = frameOutput(b, s);
             m_bounce = 0;
         }
         BREAK
@@ -341,7 +396,7 @@ void VM::interpretCases()
 
             uint64_t b = (uint64_t)m_SP[0];
             uint64_t s = (uint64_t)m_SP[1];
-            owning_bytes_ref output{std::move(m_mem), b, s};
+            owning_bytes_ref output = frameOutput(b, s);
             throwRevertInstruction(std::move(output));
         }
         BREAK;
@@ -391,7 +446,7 @@ void VM::interpretCases()
             updateMem(toInt63(m_SP[0]) + 32);
             updateIOGas();
 
-            m_SPP[0] = (u256)*(h256 const*)(m_mem.data() + (unsigned)m_SP[0]);
+            m_SPP[0] = Word256::loadBigEndian(m_mem.data() + (unsigned)m_SP[0]).toU256();
         }
         NEXT
 
@@ -401,7 +456,7 @@ void VM::interpretCases()
             updateMem(toInt63(m_SP[0]) + 32);
             updateIOGas();
 
-            *(h256*)&m_mem[(unsigned)m_SP[0]] = (h256)m_SP[1];
+            Word256::fromU256(m_SP[1]).storeBigEndian(&m_mem[(unsigned)m_SP[0]]);
         }
         NEXT
 
@@ -536,8 +591,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            u256 base = m_SP[0];
-            m_SPP[0] = exp256(base, expon);
+            m_SPP[0] = exp(Word256::fromU256(m_SP[0]), Word256::fromU256(expon)).toU256();
         }
         NEXT
 
@@ -579,7 +633,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? divWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = div(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -588,7 +642,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(divWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = sdiv(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
             --m_SP;
         }
         NEXT
@@ -598,7 +652,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? modWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = mod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -607,7 +661,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(modWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = smod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -643,7 +697,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) < u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = slt(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])) ? 1 : 0;
         }
         NEXT
 
@@ -652,7 +706,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) > u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = slt(Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[0])) ? 1 : 0;
         }
         NEXT
 
@@ -751,25 +805,9 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            static u256 const hibit = u256(1) << 255;
-            static u256 const allbits =
-                u256("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
-
-            u256 shiftee = m_SP[1];
-            if (m_SP[0] >= 256)
-            {
-                if (shiftee & hibit)
-                    m_SPP[0] = allbits;
-                else
-                    m_SPP[0] = 0;
-            }
-            else
-            {
-                unsigned amount = unsigned(m_SP[0]);
-                m_SPP[0] = shiftee >> amount;
-                if (shiftee & hibit)
-                    m_SPP[0] |= allbits << (256 - amount);
-            }
+            // Shifting by 255 already fills the word with the sign bit.
+            unsigned const amount = m_SP[0] >= 256 ? 255 : unsigned(m_SP[0]);
+            m_SPP[0] = sar(Word256::fromU256(m_SP[1]), amount).toU256();
         }
         NEXT
 
@@ -778,7 +816,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) + u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = addmod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[2])).toU256();
         }
         NEXT
 
@@ -787,7 +825,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) * u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = mulmod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[2])).toU256();
         }
         NEXT
 
@@ -1136,24 +1174,13 @@ void VM::interpretCases()
 
         CASE(PUSHC)
         {
-#if BVM_USE_CONSTANT_POOL
+            // Only in translated code, the analysis makes it INVALID in the bytecode.
             ON_OP();
             updateIOGas();
 
-            // get val at two-byte offset into const pool and advance pc by one-byte remainder
-            TRACE_OP(2, m_PC, m_OP);
-            unsigned off;
-            ++m_PC;
-            off = m_code[m_PC++] << 8;
-            off |= m_code[m_PC++];
-            m_PC += m_code[m_PC];
-            m_SPP[0] = m_pool[off];
-            TRACE_VAL(2, "Retrieved pooled const", m_SPP[0]);
-#else
-            throwBadInstruction();
-#endif
+            m_SPP[0] = m_pool[m_ip->arg];
         }
-        CONTINUE
+        NEXT
 
         CASE(PUSH1)
         {
@@ -1168,6 +1195,18 @@ void VM::interpretCases()
         CASE(PUSH2)
         CASE(PUSH3)
         CASE(PUSH4)
+        {
+            ON_OP();
+            updateIOGas();
+
+            int numBytes = (int)m_OP - (int)Instruction::PUSH1 + 1;
+            uint64_t val = 0;
+            for (++m_PC; numBytes--; ++m_PC)
+                val = (val << 8) | m_code[m_PC];
+            m_SPP[0] = val;
+        }
+        CONTINUE
+
         CASE(PUSH5)
         CASE(PUSH6)
         CASE(PUSH7)
@@ -1200,13 +1239,9 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            int numBytes = (int)m_OP - (int)Instruction::PUSH1 + 1;
-            m_SPP[0] = 0;
-            // Construct a number out of PUSH bytes.
-            // This requires the code has been copied and extended by 32 zero
-            // bytes to handle "out of code" push data here.
-            for (++m_PC; numBytes--; ++m_PC)
-                m_SPP[0] = (m_SPP[0] << 8) | m_code[m_PC];
+            // The analysis decoded the PUSH bytes into the constant pool.
+            m_SPP[0] = m_pool[CodeAnalysis::poolIndex(&m_code[m_PC + 1])];
+            m_PC += (int)m_OP - (int)Instruction::PUSH1 + 2;
         }
         CONTINUE
 
@@ -1214,7 +1249,10 @@ void VM::interpretCases()
         {
             ON_OP();
             updateIOGas();
-            m_PC = verifyJumpDest(m_SP[0]);
+            if (Threaded)
+                m_ip = m_threaded->target(verifyJumpDest(m_SP[0]));
+            else
+                m_PC = verifyJumpDest(m_SP[0]);
         }
         CONTINUE
 
@@ -1222,39 +1260,39 @@ void VM::interpretCases()
         {
             ON_OP();
             updateIOGas();
-            if (m_SP[1])
+            if (Threaded)
+            {
+                if (m_SP[1])
+                    m_ip = m_threaded->target(verifyJumpDest(m_SP[0]));
+                else
+                    ++m_ip;
+            }
+            else if (m_SP[1])
                 m_PC = verifyJumpDest(m_SP[0]);
             else
                 ++m_PC;
         }
         CONTINUE
 
+        // JUMPC and JUMPCI are only in translated code, their destination was verified there.
         CASE(JUMPC)
         {
-#if BVM_REPLACE_CONST_JUMP
             ON_OP();
             updateIOGas();
 
-            m_PC = uint64_t(m_SP[0]);
-#else
-            throwBadInstruction();
-#endif
+            m_ip = &m_threaded->instrs[m_ip->arg];
         }
         CONTINUE
 
         CASE(JUMPCI)
         {
-#if BVM_REPLACE_CONST_JUMP
             ON_OP();
             updateIOGas();
 
             if (m_SP[1])
-                m_PC = uint64_t(m_SP[0]);
+                m_ip = &m_threaded->instrs[m_ip->arg];
             else
-                ++m_PC;
-#else
-            throwBadInstruction();
-#endif
+                ++m_ip;
         }
         CONTINUE
 
@@ -1359,7 +1397,7 @@ void VM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_PC;
+            m_SPP[0] = Threaded ? m_ip->pc : m_PC;
         }
         NEXT
 
@@ -1383,7 +1421,8 @@ void VM::interpretCases()
 
         CASE(JUMPDEST)
         {
-            m_runGas = VMSchedule::jumpdestGas;
+            // In translated code it starts every block and charges the static gas of the block.
+            m_runGas = Threaded ? m_ip->arg : VMSchedule::jumpdestGas;
             ON_OP();
             updateIOGas();
         }
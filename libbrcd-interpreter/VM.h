@@ -1,8 +1,11 @@
 #pragma once
 
+#include "CodeAnalysis.h"
+#include "ThreadedCode.h"
 #include "VMConfig.h"
 
 #include <libbvm/VMFace.h>
+#include <libbvm/VMPool.h>
 
 #include <bvmc/bvmc.h>
 #include <bvmc/instructions.h>
@@ -51,7 +54,12 @@ public:
     owning_bytes_ref exec(bvmc_context* _context, bvmc_revision _rev, const bvmc_message* _msg,
         uint8_t const* _code, size_t _codeSize);
 
+    /// Gets the instance ready for the next frame, for VMPool.
+    void reset();
+
     uint64_t m_io_gas = 0;
+    /// Run the code translated for the threaded dispatch instead of the bytecode.
+    bool m_threadedDispatch = false;
 private:
     bvmc_context* m_context = nullptr;
     bvmc_revision m_rev = BVMC_FRONTIER;
@@ -60,10 +68,10 @@ private:
 
     static std::array<bvmc_instruction_metrics, 256> c_metrics;
     static void initMetrics();
-    static u256 exp256(u256 _base, u256 _exponent);
-    void copyCode(int);
     typedef void (VM::*MemFnPtr)();
     MemFnPtr m_bounce = nullptr;
+    // the interpreter loop the calls out return to
+    MemFnPtr m_interpret = nullptr;
     uint64_t m_nSteps = 0;
 
     // return bytes
@@ -74,8 +82,9 @@ private:
 
     uint8_t const* m_pCode = nullptr;
     size_t m_codeSize = 0;
-    // space for code
-    bytes m_code;
+    // analysed code, shared with every frame running it
+    std::shared_ptr<CodeAnalysis const> m_analysis;
+    uint8_t const* m_code = nullptr;
 
     /// RETURNDATA buffer for memory returned from direct subcalls.
     bytes m_returnData;
@@ -86,7 +95,11 @@ private:
     size_t stackSize() { return m_stackEnd - m_SP; }
     
     // constant pool
-    std::vector<u256> m_pool;
+    u256 const* m_pool = nullptr;
+
+    // translated code and its instruction pointer, for the threaded dispatch
+    std::shared_ptr<ThreadedCode const> m_threaded;
+    ThreadedCode::Instr const* m_ip = nullptr;
 
     // interpreter state
     Instruction m_OP;         // current operation
@@ -102,8 +115,10 @@ private:
     // initialize interpreter
     void initEntry();
     void optimize();
+    void translate(void const* const* _labels);
 
-    // interpreter loop & switch
+    // interpreter loop & switch, over the bytecode or the translated code
+    template <bool Threaded>
     void interpretCases();
 
     // interpreter cases that call out
@@ -113,6 +128,7 @@ private:
 
     void copyDataToMemory(bytesConstRef _data, u256*_sp);
     uint64_t memNeed(u256 _offset, u256 _size);
+    owning_bytes_ref frameOutput(uint64_t _begin, uint64_t _size);
 
     const bvmc_tx_context& getTxContext();
 
@@ -125,7 +141,6 @@ private:
     void throwBufferOverrun(bigint const& _enfOfAccess);
 
     std::vector<uint64_t> m_beginSubs;
-    std::vector<uint64_t> m_jumpDests;
     int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
 
     void onOperation() {}
@@ -136,6 +151,7 @@ private:
     void updateMem(uint64_t _newMem);
     void logGasMem();
     void fetchInstruction();
+    void fetchTranslated();
     
     uint64_t decodeJumpDest(const byte* const _code, uint64_t& _pc);
     uint64_t decodeJumpvDest(const byte* const _code, uint64_t& _pc, byte _voff);
@@ -72,9 +72,8 @@ int64_t VM::verifyJumpDest(u256 const& _dest, bool _throw)
     if (_dest <= 0x7FFFFFFFFFFFFFFF) {
 
         // check for within bounds and to a jump destination
-        // use binary search of array because hashtable collisions are exploitable
         uint64_t pc = uint64_t(_dest);
-        if (std::binary_search(m_jumpDests.begin(), m_jumpDests.end(), pc))
+        if (m_analysis->isJumpDest(pc))
             return pc;
     }
     if (_throw)
@@ -89,7 +88,7 @@ int64_t VM::verifyJumpDest(u256 const& _dest, bool _throw)
 
 void VM::caseCreate()
 {
-    m_bounce = &VM::interpretCases;
+    m_bounce = m_interpret;
     m_runGas = VMSchedule::createGas;
 
     // Collect arguments.
@@ -146,12 +145,15 @@ void VM::caseCreate()
     }
     else
         m_SPP[0] = 0;
-    ++m_PC;
+    if (m_threadedDispatch)
+        ++m_ip;
+    else
+        ++m_PC;
 }
 
 void VM::caseCall()
 {
-    m_bounce = &VM::interpretCases;
+    m_bounce = m_interpret;
 
     bvmc_message msg = {};
 
@@ -177,7 +179,10 @@ void VM::caseCall()
         m_SPP[0] = 0;
         m_io_gas += msg.gas;
     }
-    ++m_PC;
+    if (m_threadedDispatch)
+        ++m_ip;
+    else
+        ++m_PC;
 }
 
 bool VM::caseCallSetup(bvmc_message& o_msg, bytesRef& o_output)
@@ -8,16 +8,14 @@ namespace brc
 //
 // interpreter configuration macros for development, optimizations and tracing
 //
-// BVM_OPTIMIZE           - all optimizations off when false (TO DO - MAKE DYNAMIC)
-//
 // BVM_SWITCH_DISPATCH    - dispatch via loop and switch
 // BVM_JUMP_DISPATCH      - dispatch via a jump table - available only on GCC
 //
-// BVM_USE_CONSTANT_POOL  - constants unpacked and ready to assign to stack
-//
-// BVM_REPLACE_CONST_JUMP - pre-verified jumps to save runtime lookup
-//
 // BVM_TRACE              - provides various levels of tracing
+//
+// The cases are compiled twice, see VM::interpretCases. With Threaded false they run the
+// bytecode at m_PC; with Threaded true they run the translated code at m_ip, whose entries
+// hold the addresses of their cases when BVM_JUMP_DISPATCH is on.
 
 #ifndef BVM_JUMP_DISPATCH
 #ifdef __GNUC__
@@ -34,16 +32,6 @@ namespace brc
 #define BVM_SWITCH_DISPATCH true
 #endif
 
-#ifndef BVM_OPTIMIZE
-#define BVM_OPTIMIZE false
-#endif
-#if BVM_OPTIMIZE
-#define BVM_REPLACE_CONST_JUMP true
-#define BVM_USE_CONSTANT_POOL true
-#define BVM_DO_FIRST_PASS_OPTIMIZATION (BVM_REPLACE_CONST_JUMP || BVM_USE_CONSTANT_POOL)
-#endif
-
-
 ///////////////////////////////////////////////////////////////////////////////
 //
 // set BVM_TRACE to 3, 2, 1, or 0 for lots to no tracing to cerr
@@ -108,15 +96,22 @@ namespace brc
 #if BVM_SWITCH_DISPATCH
 
 #define INIT_CASES
-#define DO_CASES            \
-    for (;;)                \
-    {                       \
-        fetchInstruction(); \
-        switch (m_OP)       \
+#define DISPATCH_TABLE nullptr
+#define DO_CASES                    \
+    for (;;)                        \
+    {                               \
+        if (Threaded)               \
+            fetchTranslated();      \
+        else                        \
+            fetchInstruction();     \
+        switch (m_OP)               \
         {
 #define CASE(name) case Instruction::name:
-#define NEXT \
-    ++m_PC;  \
+#define NEXT          \
+    if (Threaded)     \
+        ++m_ip;       \
+    else              \
+        ++m_PC;       \
     break;
 #define CONTINUE continue;
 #define BREAK return;
@@ -129,7 +124,7 @@ namespace brc
 ///////////////////////////////////////////////////////////////////////////////
 //
 // build an indirect-threaded interpreter using a jump table of
-// label addresses (a gcc extension)
+// label addresses (a gcc extension), direct-threaded over translated code
 //
 #elif BVM_JUMP_DISPATCH
 
@@ -394,18 +389,28 @@ namespace brc
         &&SUICIDE,                              \
     };
 
-#define DO_CASES        \
-    fetchInstruction(); \
-    goto* jumpTable[(int)m_OP];
+#define DISPATCH_TABLE jumpTable
+#define DISPATCH                        \
+    if (Threaded)                       \
+    {                                   \
+        fetchTranslated();              \
+        goto* m_ip->label;              \
+    }                                   \
+    else                                \
+    {                                   \
+        fetchInstruction();             \
+        goto* jumpTable[(int)m_OP];     \
+    }
+#define DO_CASES DISPATCH
 #define CASE(name) \
     name:
-#define NEXT            \
-    ++m_PC;             \
-    fetchInstruction(); \
-    goto* jumpTable[(int)m_OP];
-#define CONTINUE        \
-    fetchInstruction(); \
-    goto* jumpTable[(int)m_OP];
+#define NEXT          \
+    if (Threaded)     \
+        ++m_ip;       \
+    else              \
+        ++m_PC;       \
+    DISPATCH
+#define CONTINUE DISPATCH
 #define BREAK return;
 #define DEFAULT
 #define WHILE_CASES
@@ -22,129 +22,23 @@ void VM::initMetrics()
     (void)done;
 }
 
-void VM::copyCode(int _extraBytes)
+void VM::optimize()
 {
-    // Copy code so that it can be safely modified and extend code by
-    // _extraBytes zero bytes to allow reading virtual data at the end
-    // of the code without bounds checks.
-    auto extendedSize = m_codeSize + _extraBytes;
-    m_code.reserve(extendedSize);
-    m_code.assign(m_pCode, m_pCode + m_codeSize);
-    m_code.resize(extendedSize);
+    m_analysis = CodeAnalysisCache::instance().analysis(
+        CodeAnalysisCache::currentCodeHash(), {m_pCode, m_codeSize});
+    m_code = m_analysis->code.data();
+    m_pool = m_analysis->pool.data();
 }
 
-void VM::optimize()
+void VM::translate(void const* const* _labels)
 {
-    copyCode(33);
-
-    size_t const nBytes = m_codeSize;
-
-    // build a table of jump destinations for use in verifyJumpDest
-    
-    TRACE_STR(1, "Build JUMPDEST table")
-    for (size_t pc = 0; pc < nBytes; ++pc)
-    {
-        Instruction op = Instruction(m_code[pc]);
-        TRACE_OP(2, pc, op);
-                
-        // make synthetic ops in user code trigger invalid instruction if run
-        if (
-            op == Instruction::PUSHC ||
-            op == Instruction::JUMPC ||
-            op == Instruction::JUMPCI
-        )
-        {
-            TRACE_OP(1, pc, op);
-            m_code[pc] = (byte)Instruction::INVALID;
-        }
-
-        if (op == Instruction::JUMPDEST)
-        {
-            m_jumpDests.push_back(pc);
-        }
-        else if (
-            (byte)Instruction::PUSH1 <= (byte)op &&
-            (byte)op <= (byte)Instruction::PUSH32
-        )
-        {
-            pc += (byte)op - (byte)Instruction::PUSH1 + 1;
-        }
-    }
-    
-#ifdef BVM_DO_FIRST_PASS_OPTIMIZATION
-    
-    TRACE_STR(1, "Do first pass optimizations")
-    for (size_t pc = 0; pc < nBytes; ++pc)
-    {
-        u256 val = 0;
-        Instruction op = Instruction(m_code[pc]);
-
-        if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
-        {
-            byte nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
-
-            // decode pushed bytes to integral value
-            val = m_code[pc+1];
-            for (uint64_t i = pc+2, n = nPush; --n; ++i) {
-                val = (val << 8) | m_code[i];
-            }
-
-        #if BVM_USE_CONSTANT_POOL
-
-            // add value to constant pool and replace PUSHn with PUSHC
-            // place offset in code as 2 bytes MSB-first
-            // followed by one byte count of remaining pushed bytes
-            if (5 < nPush)
-            {
-                uint16_t pool_off = m_pool.size();
-                TRACE_VAL(1, "stash", val);
-                TRACE_VAL(1, "... in pool at offset" , pool_off);
-                m_pool.push_back(val);
-
-                TRACE_PRE_OPT(1, pc, op);
-                m_code[pc] = byte(op = Instruction::PUSHC);
-                m_code[pc+3] = nPush - 2;
-                m_code[pc+2] = pool_off & 0xff;
-                m_code[pc+1] = pool_off >> 8;
-                TRACE_POST_OPT(1, pc, op);
-            }
-
-        #endif
-
-        #if BVM_REPLACE_CONST_JUMP
-            // replace JUMP or JUMPI to constant location with JUMPC or JUMPCI
-            // verifyJumpDest is M = log(number of jump destinations)
-            // outer loop is N = number of bytes in code array
-            // so complexity is N log M, worst case is N log N
-            size_t i = pc + nPush + 1;
-            op = Instruction(m_code[i]);
-            if (op == Instruction::JUMP)
-            {
-                TRACE_VAL(1, "Replace const JUMP with JUMPC to", val)
-                TRACE_PRE_OPT(1, i, op);
-                
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPC);
-                
-                TRACE_POST_OPT(1, i, op);
-            }
-            else if (op == Instruction::JUMPI)
-            {
-                TRACE_VAL(1, "Replace const JUMPI with JUMPCI to", val)
-                TRACE_PRE_OPT(1, i, op);
-                
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPCI);
-                
-                TRACE_POST_OPT(1, i, op);
-            }
-        #endif
-
-            pc += nPush;
-        }
-    }
-    TRACE_STR(1, "Finished optimizations")
-#endif    
+    m_threaded = CodeAnalysisCache::instance().threadedCode(CodeAnalysisCache::currentCodeHash(),
+        {m_pCode, m_codeSize}, [&](std::shared_ptr<CodeAnalysis const> _analysis) {
+            return std::make_shared<ThreadedCode const>(std::move(_analysis), c_metrics.data(), _labels);
+        });
+    m_analysis = m_threaded->analysis;
+    m_pool = m_threaded->pool.data();
+    m_ip = m_threaded->instrs.data();
 }
 
 
@@ -153,30 +47,12 @@ void VM::optimize()
 //
 void VM::initEntry()
 {
-    m_bounce = &VM::interpretCases;     
+    m_bounce = m_interpret;
     initMetrics();
-    optimize();
+    // the threaded loop translates the code on entry, it needs the addresses of its cases
+    if (!m_threadedDispatch)
+        optimize();
 }
 
-
-// Implementation of EXP.
-//
-// This implements exponentiation by squaring algorithm.
-// Is faster than boost::multiprecision::powm() because it avoids explicit
-// mod operation.
-// Do not inline it.
-u256 VM::exp256(u256 _base, u256 _exponent)
-{
-    using boost::multiprecision::limb_type;
-    u256 result = 1;
-    while (_exponent)
-    {
-        if (static_cast<limb_type>(_exponent) & 1)    // If exponent is odd.
-            result *= _base;
-        _base *= _base;
-        _exponent >>= 1;
-    }
-    return result;
-}
 }
 }
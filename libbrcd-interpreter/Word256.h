@@ -0,0 +1,409 @@
+#pragma once
+
+#include <libdevcore/Common.h>
+
+#include <cstring>
+
+namespace dev
+{
+namespace brc
+{
+
+/**
+ * @brief 256-bit VM word as four 64-bit limbs, least significant first, with the arithmetic of
+ * the VM opcodes written for it. The limbs are the layout boost keeps inside u256, so a word is
+ * loaded from and stored to the stack by copying them. The kernels are plain limb loops over
+ * unsigned __int128, which the compiler turns into add-with-carry and widening multiplies.
+ */
+struct Word256
+{
+    using u128 = unsigned __int128;
+
+    uint64_t w[4];
+
+    static Word256 zero() { return Word256{{0, 0, 0, 0}}; }
+    static Word256 one() { return Word256{{1, 0, 0, 0}}; }
+
+    static Word256 fromU256(u256 const& _v)
+    {
+        static_assert(sizeof(boost::multiprecision::limb_type) == sizeof(uint64_t),
+            "u256 limbs must be 64 bits");
+        Word256 ret = zero();
+        std::memcpy(ret.w, _v.backend().limbs(), _v.backend().size() * sizeof(uint64_t));
+        return ret;
+    }
+
+    u256 toU256() const
+    {
+        u256 ret;
+        ret.backend().resize(4, 4);
+        std::memcpy(ret.backend().limbs(), w, sizeof(w));
+        ret.backend().normalize();
+        return ret;
+    }
+
+    /// Reads 32 big-endian bytes, as MLOAD does.
+    static Word256 loadBigEndian(byte const* _b)
+    {
+        Word256 ret;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            uint64_t limb;
+            std::memcpy(&limb, _b + 8 * (3 - i), sizeof(limb));
+            ret.w[i] = __builtin_bswap64(limb);
+        }
+        return ret;
+    }
+
+    void storeBigEndian(byte* _b) const
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            uint64_t const limb = __builtin_bswap64(w[i]);
+            std::memcpy(_b + 8 * (3 - i), &limb, sizeof(limb));
+        }
+    }
+
+    bool isZero() const { return !(w[0] | w[1] | w[2] | w[3]); }
+    bool isNegative() const { return w[3] >> 63; }
+    /// @returns true if the word is below 2^64, so w[0] is all of it.
+    bool fits64() const { return !(w[1] | w[2] | w[3]); }
+};
+
+inline bool operator==(Word256 const& _a, Word256 const& _b)
+{
+    return !((_a.w[0] ^ _b.w[0]) | (_a.w[1] ^ _b.w[1]) | (_a.w[2] ^ _b.w[2]) | (_a.w[3] ^ _b.w[3]));
+}
+
+inline bool lt(Word256 const& _a, Word256 const& _b)
+{
+    for (size_t i = 4; i--;)
+        if (_a.w[i] != _b.w[i])
+            return _a.w[i] < _b.w[i];
+    return false;
+}
+
+inline bool slt(Word256 const& _a, Word256 const& _b)
+{
+    if (_a.isNegative() != _b.isNegative())
+        return _a.isNegative();
+    return lt(_a, _b);
+}
+
+inline Word256 add(Word256 const& _a, Word256 const& _b)
+{
+    Word256 ret;
+    Word256::u128 carry = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        carry += Word256::u128(_a.w[i]) + _b.w[i];
+        ret.w[i] = uint64_t(carry);
+        carry >>= 64;
+    }
+    return ret;
+}
+
+inline Word256 sub(Word256 const& _a, Word256 const& _b)
+{
+    Word256 ret;
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        Word256::u128 const d = Word256::u128(_a.w[i]) - _b.w[i] - borrow;
+        ret.w[i] = uint64_t(d);
+        borrow = uint64_t(d >> 64) & 1;
+    }
+    return ret;
+}
+
+inline Word256 negate(Word256 const& _a)
+{
+    return sub(Word256::zero(), _a);
+}
+
+/// Product modulo 2^256: only the limb products below 2^256 are formed.
+inline Word256 mul(Word256 const& _a, Word256 const& _b)
+{
+    Word256 ret = Word256::zero();
+    for (size_t i = 0; i < 4; ++i)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; i + j < 4; ++j)
+        {
+            Word256::u128 const p = Word256::u128(_a.w[i]) * _b.w[j] + ret.w[i + j] + carry;
+            ret.w[i + j] = uint64_t(p);
+            carry = uint64_t(p >> 64);
+        }
+    }
+    return ret;
+}
+
+/// Full 512-bit product into @a o_r, least significant limb first.
+inline void mulFull(Word256 const& _a, Word256 const& _b, uint64_t (&o_r)[8])
+{
+    std::memset(o_r, 0, sizeof(o_r));
+    for (size_t i = 0; i < 4; ++i)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            Word256::u128 const p = Word256::u128(_a.w[i]) * _b.w[j] + o_r[i + j] + carry;
+            o_r[i + j] = uint64_t(p);
+            carry = uint64_t(p >> 64);
+        }
+        o_r[i + 4] = carry;
+    }
+}
+
+/// Divides the @a _m limbs of @a _u by the @a _n limbs of @a _v, whose top limb is not zero,
+/// with Knuth's algorithm D. Writes the @a _m - @a _n + 1 quotient limbs to @a o_q, if not null,
+/// and the @a _n remainder limbs to @a o_r.
+inline void divmodLimbs(uint64_t const* _u, size_t _m, uint64_t const* _v, size_t _n, uint64_t* o_q,
+    uint64_t* o_r)
+{
+    using u128 = Word256::u128;
+    if (_n == 1)
+    {
+        u128 rem = 0;
+        for (size_t j = _m; j--;)
+        {
+            u128 const cur = (rem << 64) | _u[j];
+            if (o_q)
+                o_q[j] = uint64_t(cur / _v[0]);
+            rem = cur % _v[0];
+        }
+        o_r[0] = uint64_t(rem);
+        return;
+    }
+
+    // Normalise so the top bit of the divisor is set, the quotient estimates are then off by 2
+    // at most.
+    unsigned const s = __builtin_clzll(_v[_n - 1]);
+    uint64_t vn[4];
+    uint64_t un[9];
+    for (size_t i = _n - 1; i > 0; --i)
+        vn[i] = (_v[i] << s) | (s ? _v[i - 1] >> (64 - s) : 0);
+    vn[0] = _v[0] << s;
+    un[_m] = s ? _u[_m - 1] >> (64 - s) : 0;
+    for (size_t i = _m - 1; i > 0; --i)
+        un[i] = (_u[i] << s) | (s ? _u[i - 1] >> (64 - s) : 0);
+    un[0] = _u[0] << s;
+
+    for (size_t j = _m - _n + 1; j--;)
+    {
+        u128 const num = (u128(un[j + _n]) << 64) | un[j + _n - 1];
+        u128 qhat = num / vn[_n - 1];
+        u128 rhat = num - qhat * vn[_n - 1];
+        while ((qhat >> 64) || u128(uint64_t(qhat)) * vn[_n - 2] > ((rhat << 64) | un[j + _n - 2]))
+        {
+            --qhat;
+            rhat += vn[_n - 1];
+            if (rhat >> 64)
+                break;
+        }
+
+        // Multiply and subtract.
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < _n; ++i)
+        {
+            u128 const p = qhat * vn[i] + carry;
+            carry = uint64_t(p >> 64);
+            u128 const subtrahend = u128(uint64_t(p)) + borrow;
+            borrow = u128(un[i + j]) < subtrahend;
+            un[i + j] -= uint64_t(subtrahend);
+        }
+        u128 const subtrahend = u128(carry) + borrow;
+        bool const negative = u128(un[j + _n]) < subtrahend;
+        un[j + _n] -= uint64_t(subtrahend);
+
+        // The estimate was one too large, add the divisor back.
+        if (negative)
+        {
+            --qhat;
+            u128 c = 0;
+            for (size_t i = 0; i < _n; ++i)
+            {
+                c += u128(un[i + j]) + vn[i];
+                un[i + j] = uint64_t(c);
+                c >>= 64;
+            }
+            un[j + _n] += uint64_t(c);
+        }
+        if (o_q)
+            o_q[j] = uint64_t(qhat);
+    }
+
+    for (size_t i = 0; i < _n; ++i)
+        o_r[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+}
+
+/// @returns the number of limbs of @a _u up to the top non-zero one.
+inline size_t usedLimbs(uint64_t const* _u, size_t _size)
+{
+    while (_size && !_u[_size - 1])
+        --_size;
+    return _size;
+}
+
+/// Quotient and remainder, both zero for a zero divisor as in the VM.
+inline void divmod(Word256 const& _a, Word256 const& _b, Word256* o_q, Word256* o_r)
+{
+    Word256 q = Word256::zero();
+    Word256 r = Word256::zero();
+    size_t const n = usedLimbs(_b.w, 4);
+    size_t const m = usedLimbs(_a.w, 4);
+    if (n == 0)
+    {
+    }
+    else if (m < n || lt(_a, _b))
+        r = _a;
+    else if (m == 1)
+    {
+        q.w[0] = _a.w[0] / _b.w[0];
+        r.w[0] = _a.w[0] % _b.w[0];
+    }
+    else
+        divmodLimbs(_a.w, m, _b.w, n, q.w, r.w);
+    if (o_q)
+        *o_q = q;
+    if (o_r)
+        *o_r = r;
+}
+
+inline Word256 div(Word256 const& _a, Word256 const& _b)
+{
+    Word256 q;
+    divmod(_a, _b, &q, nullptr);
+    return q;
+}
+
+inline Word256 mod(Word256 const& _a, Word256 const& _b)
+{
+    Word256 r;
+    divmod(_a, _b, nullptr, &r);
+    return r;
+}
+
+/// Signed division truncated towards zero, -2^255 / -1 wraps to -2^255.
+inline Word256 sdiv(Word256 const& _a, Word256 const& _b)
+{
+    bool const negA = _a.isNegative();
+    bool const negB = _b.isNegative();
+    Word256 const q = div(negA ? negate(_a) : _a, negB ? negate(_b) : _b);
+    return negA != negB ? negate(q) : q;
+}
+
+/// Signed remainder, with the sign of the dividend.
+inline Word256 smod(Word256 const& _a, Word256 const& _b)
+{
+    bool const negA = _a.isNegative();
+    Word256 const r = mod(negA ? negate(_a) : _a, _b.isNegative() ? negate(_b) : _b);
+    return negA ? negate(r) : r;
+}
+
+/// (_a + _b) % _m over 257 bits.
+inline Word256 addmod(Word256 const& _a, Word256 const& _b, Word256 const& _m)
+{
+    size_t const n = usedLimbs(_m.w, 4);
+    if (n == 0)
+        return Word256::zero();
+    uint64_t sum[5];
+    Word256::u128 carry = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        carry += Word256::u128(_a.w[i]) + _b.w[i];
+        sum[i] = uint64_t(carry);
+        carry >>= 64;
+    }
+    sum[4] = uint64_t(carry);
+    Word256 r = Word256::zero();
+    size_t const m = usedLimbs(sum, 5);
+    if (m < n)
+        std::memcpy(r.w, sum, m * sizeof(uint64_t));
+    else
+        divmodLimbs(sum, m, _m.w, n, nullptr, r.w);
+    return r;
+}
+
+/// (_a * _b) % _m over 512 bits.
+inline Word256 mulmod(Word256 const& _a, Word256 const& _b, Word256 const& _m)
+{
+    size_t const n = usedLimbs(_m.w, 4);
+    if (n == 0)
+        return Word256::zero();
+    uint64_t product[8];
+    mulFull(_a, _b, product);
+    Word256 r = Word256::zero();
+    size_t const m = usedLimbs(product, 8);
+    if (m < n)
+        std::memcpy(r.w, product, m * sizeof(uint64_t));
+    else
+        divmodLimbs(product, m, _m.w, n, nullptr, r.w);
+    return r;
+}
+
+inline Word256 exp(Word256 _base, Word256 const& _exponent)
+{
+    Word256 ret = Word256::one();
+    size_t const limbs = usedLimbs(_exponent.w, 4);
+    for (size_t i = 0; i < limbs; ++i)
+    {
+        uint64_t e = _exponent.w[i];
+        // The squarings past the top bit of the exponent are not needed.
+        for (unsigned bit = 0; bit < 64 && (e || i + 1 < limbs); ++bit, e >>= 1)
+        {
+            if (e & 1)
+                ret = mul(ret, _base);
+            _base = mul(_base, _base);
+        }
+    }
+    return ret;
+}
+
+/// Shifts by @a _shift below 256.
+inline Word256 shl(Word256 const& _a, unsigned _shift)
+{
+    Word256 ret = Word256::zero();
+    unsigned const limbs = _shift / 64;
+    unsigned const bits = _shift % 64;
+    for (size_t i = limbs; i < 4; ++i)
+    {
+        ret.w[i] = _a.w[i - limbs] << bits;
+        if (bits && i > limbs)
+            ret.w[i] |= _a.w[i - limbs - 1] >> (64 - bits);
+    }
+    return ret;
+}
+
+inline Word256 shr(Word256 const& _a, unsigned _shift)
+{
+    Word256 ret = Word256::zero();
+    unsigned const limbs = _shift / 64;
+    unsigned const bits = _shift % 64;
+    for (size_t i = 0; i + limbs < 4; ++i)
+    {
+        ret.w[i] = _a.w[i + limbs] >> bits;
+        if (bits && i + limbs + 1 < 4)
+            ret.w[i] |= _a.w[i + limbs + 1] << (64 - bits);
+    }
+    return ret;
+}
+
+inline Word256 sar(Word256 const& _a, unsigned _shift)
+{
+    if (!_a.isNegative())
+        return shr(_a, _shift);
+    Word256 const ones{{~uint64_t(0), ~uint64_t(0), ~uint64_t(0), ~uint64_t(0)}};
+    Word256 ret = shr(_a, _shift);
+    if (_shift)
+    {
+        Word256 const fill = shl(ones, 256 - _shift);
+        for (size_t i = 0; i < 4; ++i)
+            ret.w[i] |= fill.w[i];
+    }
+    return ret;
+}
+
+}
+}
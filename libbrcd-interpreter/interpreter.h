@@ -9,6 +9,9 @@ extern "C" {
 
 BVMC_EXPORT struct bvmc_instance* bvmc_create_interpreter() BVMC_NOEXCEPT;
 
+/// The interpreter running the contracts translated for threaded dispatch.
+BVMC_EXPORT struct bvmc_instance* bvmc_create_threaded_interpreter() BVMC_NOEXCEPT;
+
 #if __cplusplus
 }
 #endif
@@ -35,43 +35,151 @@ u256 Account::originalStorageValue(u256 const& _key, OverlayDB const& _db) const
     return value;
 }
 
-void dev::brc::Account::addVote(std::pair<Address, u256> _votePair)
+boost::optional<u256> Account::voteRecord(Address const& _id, OverlayDB const& _db) const
 {
-    auto ret = m_voteDate.find(_votePair.first);
-    if(ret == m_voteDate.end())
+    if (!m_voteRoot)
     {
-        if(_votePair.second)
+        auto ret = m_voteDate.find(_id);
+        if (ret == m_voteDate.end())
+            return boost::none;
+        return ret->second;
+    }
+
+    auto it = m_voteOverlay.find(_id);
+    if (it != m_voteOverlay.end())
+        return it->second;
+
+    auto oit = m_voteOriginal.find(_id);
+    if (oit != m_voteOriginal.end())
+        return oit->second;
+
+    if (m_voteRoot == EmptyTrie)
+        return boost::none;
+
+    VoteTrieDB<OverlayDB> const votedb(const_cast<OverlayDB*>(&_db), m_voteRoot);
+    std::string const payload = votedb.at(_id);
+    boost::optional<u256> value;
+    if (payload.size())
+        value = RLP(payload).toInt<u256>();
+    m_voteOriginal[_id] = value;
+    return value;
+}
+
+std::unordered_map<Address, u256> Account::voteData(OverlayDB const& _db) const
+{
+    if (!m_voteRoot)
+        return m_voteDate;
+
+    std::unordered_map<Address, u256> ret;
+    if (m_voteRoot != EmptyTrie)
+    {
+        VoteTrieDB<OverlayDB> const votedb(const_cast<OverlayDB*>(&_db), m_voteRoot);
+        for (auto const& i : votedb)
+            ret[i.first] = RLP(i.second).toInt<u256>();
+    }
+    for (auto const& i : m_voteOverlay)
+    {
+        if (i.second)
+            ret[i.first] = *i.second;
+        else
+            ret.erase(i.first);
+    }
+    return ret;
+}
+
+u256 Account::voteAll(OverlayDB const& _db) const
+{
+    u256 vote_num = 0;
+    for (auto const& val : voteData(_db))
+        vote_num += val.second;
+    return vote_num;
+}
+
+void dev::brc::Account::addVote(std::pair<Address, u256> _votePair, OverlayDB const& _db)
+{
+    if (!m_voteRoot)
+    {
+        auto ret = m_voteDate.find(_votePair.first);
+        if(ret == m_voteDate.end())
         {
-            m_voteDate.insert(_votePair);
+            if(_votePair.second)
+                m_voteDate.insert(_votePair);
             changed();
             return;
         }
+        if(ret->second + _votePair.second > 0)
+            ret->second += _votePair.second;
+        else
+            m_voteDate.erase(ret);
+        changed();
+        return;
+    }
+
+    auto ret = voteRecord(_votePair.first, _db);
+    if(!ret)
+    {
+        if(_votePair.second)
+            m_voteOverlay[_votePair.first] = _votePair.second;
+        changed();
+        return;
     }
-    if(ret->second + _votePair.second > 0)
-        ret->second += _votePair.second;
+    if(*ret + _votePair.second > 0)
+        m_voteOverlay[_votePair.first] = *ret + _votePair.second;
     else
-        m_voteDate.erase(ret);
+        m_voteOverlay[_votePair.first] = boost::none;
 	changed();
 }
 
 void dev::brc::Account::addBlockRewardRecoding(std::pair<u256, u256> _pair)
 {
+    if (m_blockRewardRoot)
+    {
+        // the trie is not read here, the stored value is added on commit.
+        m_blockRewardDelta[_pair.first] += _pair.second;
+        changed();
+        return;
+    }
     u256 _rewardNum = m_BlockReward[_pair.first];
     _rewardNum += _pair.second;
     m_BlockReward[_pair.first] = _rewardNum;
     changed();
 }
 
-void dev::brc::Account::manageSysVote(Address const& _otherAddr, bool _isLogin, u256 _tickets)
+std::unordered_map<u256, u256> Account::blockReward(OverlayDB const& _db) const
+{
+    if (!m_blockRewardRoot)
+        return m_BlockReward;
+
+    std::unordered_map<u256, u256> ret;
+    if (m_blockRewardRoot != EmptyTrie)
+    {
+        BlockRewardTrieDB<OverlayDB> const rewarddb(const_cast<OverlayDB*>(&_db), m_blockRewardRoot);
+        for (auto const& i : rewarddb)
+            ret[u256(i.first)] = RLP(i.second).toInt<u256>();
+    }
+    for (auto const& i : m_blockRewardDelta)
+        ret[i.first] += i.second;
+    return ret;
+}
+
+void dev::brc::Account::manageSysVote(Address const& _otherAddr, bool _isLogin, u256 _tickets, OverlayDB const& _db)
 {
 	// 该接口 保留票数为0的数据  当是成为或者撤销竞选人是否，_tickets 为0
-	auto ret = m_voteDate.find(_otherAddr);
-	if(_isLogin && ret == m_voteDate.end())
+	auto ret = voteRecord(_otherAddr, _db);
+	if(_isLogin && !ret)
+	{
+		if (m_voteRoot)
+			m_voteOverlay[_otherAddr] = _tickets;
+		else
+			m_voteDate[_otherAddr] = _tickets;
+	}
+	else if(!_isLogin && ret)
 	{
-		m_voteDate[_otherAddr] = _tickets;
+		if (m_voteRoot)
+			m_voteOverlay[_otherAddr] = boost::none;
+		else
+			m_voteDate.erase(_otherAddr);
 	}
-	else if(!_isLogin && ret != m_voteDate.end())
-		m_voteDate.erase(ret);
 	changed();
 }
 
@@ -228,10 +336,12 @@ AccountMap dev::brc::jsonToAccountMap(std::string const& _json, u256 const& _def
         {
 			ret[a] = Account(0, 0);
 			js::mArray creater = accountMaskJson.at(c_genesisVarlitor).get_array();
+			// a new account keeps its records in memory, the db is never read.
+			OverlayDB const emptyDB;
 			for(auto const& val : creater)
 			{
 			    Address _addr= Address(val.get_str());
-				ret[a].manageSysVote(_addr, true, 0);
+				ret[a].manageSysVote(_addr, true, 0, emptyDB);
 			}
         }
 
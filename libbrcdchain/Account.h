@@ -6,6 +6,7 @@
 #include <libbrccore/Common.h>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
 
 namespace dev
 {
@@ -64,7 +65,8 @@ public:
 
     /// Explicit constructor for wierd cases of construction or a contract account.
     Account(u256 _nonce, u256 _balance, h256 _contractRoot, h256 _codeHash, u256 _ballot,
-        u256 _poll, u256 _BRC, u256 _FBRC, u256 _FBalance, Changedness _c, u256 _assetInjectStatus = 0)
+        u256 _poll, u256 _BRC, u256 _FBRC, u256 _FBalance, Changedness _c, u256 _assetInjectStatus = 0,
+        h256 _voteRoot = h256(), h256 _blockRewardRoot = h256())
       : m_isAlive(true),
         m_isUnchanged(_c == Unchanged),
         m_nonce(_nonce),
@@ -76,7 +78,9 @@ public:
         m_BRC(_BRC),
         m_FBRC(_FBRC),
         m_FBalance(_FBalance),
-		m_assetInjectStatus(_assetInjectStatus)
+		m_assetInjectStatus(_assetInjectStatus),
+        m_voteRoot(_voteRoot),
+        m_blockRewardRoot(_blockRewardRoot)
     {
         assert(_contractRoot);
     }
@@ -112,7 +116,12 @@ public:
         m_ballot = 0;
 		m_assetInjectStatus = 0;
         m_voteDate.clear();
+        m_voteRoot = h256();
+        m_voteOverlay.clear();
+        m_voteOriginal.clear();
 		m_BlockReward.clear();
+        m_blockRewardRoot = h256();
+        m_blockRewardDelta.clear();
         changed();
     }
 
@@ -267,19 +276,47 @@ public:
     bytes const& code() const { return m_codeCache; }
 
     // VoteDate 投票数据
-    u256 voteAll()const { u256 vote_num = 0; for(auto val : m_voteDate) vote_num += val.second; return vote_num; }
-    u256 vote(Address const& _id) const { auto ret = m_voteDate.find(_id); if(ret == m_voteDate.end()) return 0; return ret->second; }
-    void addVote(std::pair<Address, u256> _votePair);
-    std::unordered_map<Address, u256> const& voteData() const { return m_voteDate; }
+    // an account written after the vote trie fork keeps its records in the vote trie (voteRoot()), they are
+    // loaded on demand like storage and changes go to the overlay. older accounts keep the whole map in memory.
+    u256 voteAll(OverlayDB const& _db) const;
+    u256 vote(Address const& _id, OverlayDB const& _db) const { auto ret = voteRecord(_id, _db); return ret ? *ret : 0; }
+    /// @returns true if @a _id has a record, also when its votes are 0.
+    bool hasVote(Address const& _id, OverlayDB const& _db) const { return !!voteRecord(_id, _db); }
+    void addVote(std::pair<Address, u256> _votePair, OverlayDB const& _db);
+    /// @returns all vote records, walks the whole vote trie.
+    std::unordered_map<Address, u256> voteData(OverlayDB const& _db) const;
+    /// Set records decoded from the legacy account encoding.
     void setVoteDate(std::unordered_map<Address, u256> const& _vote) { m_voteDate.clear(); m_voteDate.insert(_vote.begin(), _vote.end()); }
     // 系统管理竞选人/验证人
-	void manageSysVote(Address const& _otherAddr, bool _isLogin, u256 _tickets);
+	void manageSysVote(Address const& _otherAddr, bool _isLogin, u256 _tickets, OverlayDB const& _db);
 
+    /// @returns true if the records are kept in the vote trie.
+    bool hasVoteTrie() const { return !!m_voteRoot; }
+    /// @returns the records of an account without vote trie.
+    std::unordered_map<Address, u256> const& legacyVoteData() const { return m_voteDate; }
+    /// @returns the root of the vote trie the overlay is based on.
+    h256 const& voteRoot() const { return m_voteRoot; }
+    /// @returns changed vote records, a removed record has no value.
+    std::unordered_map<Address, boost::optional<u256>> const& voteOverlay() const { return m_voteOverlay; }
 
+
+	// block reward history, block number => reward. like the vote records an account written after the
+	// block reward trie fork keeps it in a trie (blockRewardRoot()), which is only walked by the query paths.
 	void addBlockRewardRecoding(std::pair<u256, u256> _pair);
 
+	/// Set the history decoded from the legacy account encoding.
 	void setBlockReward(std::unordered_map<u256, u256> const& _blockReward) { m_BlockReward.clear(); m_BlockReward.insert(_blockReward.begin(), _blockReward.end()); }
-	std::unordered_map<u256, u256> const& blockReward() const { return m_BlockReward; }
+	/// @returns the whole history, walks the block reward trie.
+	std::unordered_map<u256, u256> blockReward(OverlayDB const& _db) const;
+
+	/// @returns true if the history is kept in the block reward trie.
+	bool hasBlockRewardTrie() const { return !!m_blockRewardRoot; }
+	/// @returns the history of an account without block reward trie.
+	std::unordered_map<u256, u256> const& legacyBlockReward() const { return m_BlockReward; }
+	/// @returns the root of the block reward trie.
+	h256 const& blockRewardRoot() const { return m_blockRewardRoot; }
+	/// @returns rewards added since the account was loaded, they are added to the trie on commit.
+	std::unordered_map<u256, u256> const& blockRewardDelta() const { return m_blockRewardDelta; }
 
 private:
     /// Note that we've altered the account.
@@ -333,8 +370,26 @@ private:
     */
     std::unordered_map<Address, u256> m_voteDate;
 
+    /// @returns the record of @a _id, overlay first then the vote trie.
+    boost::optional<u256> voteRecord(Address const& _id, OverlayDB const& _db) const;
+
+    /// The base vote trie root, m_voteOverlay is overlaid on it. Null if the account has no vote trie.
+    h256 m_voteRoot;
+
+    /// Changed vote records, boost::none for a removed one.
+    std::unordered_map<Address, boost::optional<u256>> m_voteOverlay;
+
+    /// The cache of unmodifed vote records.
+    mutable std::unordered_map<Address, boost::optional<u256>> m_voteOriginal;
+
 	std::unordered_map<u256, u256> m_BlockReward;
 
+	/// The block reward trie root, null if the account has no block reward trie.
+	h256 m_blockRewardRoot;
+
+	/// Rewards added on top of m_blockRewardRoot.
+	std::unordered_map<u256, u256> m_blockRewardDelta;
+
     /// The map with is overlaid onto whatever storage is implied by the m_storageRoot in the trie.
     mutable std::unordered_map<u256, u256> m_storageOverlay;
 
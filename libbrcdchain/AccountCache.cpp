@@ -0,0 +1,83 @@
+#include "AccountCache.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::brc;
+
+shared_ptr<Account const> SharedAccountCache::find(h256 const& _root, Address const& _addr) const
+{
+    ReadGuard l(x_cache);
+    auto git = m_generations.find(_root);
+    if (git != m_generations.end())
+    {
+        auto it = git->second.accounts.find(_addr);
+        if (it != git->second.accounts.end())
+        {
+            ++m_hits;
+            return it->second;
+        }
+    }
+    ++m_misses;
+    return nullptr;
+}
+
+bool SharedAccountCache::contains(h256 const& _root, Address const& _addr) const
+{
+    ReadGuard l(x_cache);
+    auto git = m_generations.find(_root);
+    return git != m_generations.end() && git->second.accounts.count(_addr);
+}
+
+void SharedAccountCache::insert(h256 const& _root, Address const& _addr, Account const& _account, size_t _cost)
+{
+    auto snapshot = make_shared<Account const>(_account);
+
+    WriteGuard l(x_cache);
+    if (_cost > m_budget)
+        return;
+    auto git = m_generations.find(_root);
+    if (git == m_generations.end())
+    {
+        git = m_generations.emplace(_root, Generation()).first;
+        m_roots.push_back(_root);
+    }
+    if (!git->second.accounts.emplace(_addr, move(snapshot)).second)
+        return;
+    git->second.charged += _cost;
+    m_charged += _cost;
+    shrink();
+}
+
+void SharedAccountCache::setBudget(size_t _bytes)
+{
+    WriteGuard l(x_cache);
+    m_budget = _bytes;
+    shrink();
+}
+
+void SharedAccountCache::clear()
+{
+    WriteGuard l(x_cache);
+    m_generations.clear();
+    m_roots.clear();
+    m_charged = 0;
+}
+
+SharedAccountCache::Stats SharedAccountCache::stats() const
+{
+    Stats ret;
+    ret.hits = m_hits;
+    ret.misses = m_misses;
+    return ret;
+}
+
+void SharedAccountCache::shrink()
+{
+    while (m_charged > m_budget && !m_roots.empty())
+    {
+        auto git = m_generations.find(m_roots.front());
+        m_charged -= git->second.charged;
+        m_generations.erase(git);
+        m_roots.pop_front();
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "Account.h"
+#include <libdevcore/Address.h>
+#include <libdevcore/Guards.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace dev
+{
+namespace brc
+{
+
+/**
+ * @brief CLOCK index over the unchanged entries of the State account cache.
+ * Every entry is charged the approximate memory of its decoded account. When the charged total
+ * passes the budget, victims are picked by a CLOCK sweep: an entry used since the hand last
+ * passed it gets a second chance, so hot accounts stay decoded while cold ones are dropped.
+ * The index only picks victims, the owner erases them from its own map.
+ */
+class AccountCacheIndex
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    /// Starts tracking @a _addr, or refreshes it if already tracked.
+    void insert(Address const& _addr, size_t _cost)
+    {
+        auto it = m_position.find(_addr);
+        if (it != m_position.end())
+        {
+            Entry& e = m_entries[it->second];
+            m_charged = m_charged - e.cost + _cost;
+            e.cost = _cost;
+            e.referenced = true;
+            return;
+        }
+        m_position.emplace(_addr, m_entries.size());
+        m_entries.push_back(Entry{_addr, _cost, false});
+        m_charged += _cost;
+    }
+
+    /// Notes a use of @a _addr, it survives the next pass of the hand.
+    void touch(Address const& _addr)
+    {
+        auto it = m_position.find(_addr);
+        if (it != m_position.end())
+            m_entries[it->second].referenced = true;
+    }
+
+    bool overBudget(size_t _budget) const { return m_charged > _budget && !m_entries.empty(); }
+
+    /// Stops tracking the entry under the hand that is due for eviction and returns its address.
+    /// Must only be called when overBudget().
+    Address evict()
+    {
+        while (true)
+        {
+            if (m_hand >= m_entries.size())
+                m_hand = 0;
+            Entry& e = m_entries[m_hand];
+            if (!e.referenced)
+                break;
+            e.referenced = false;
+            ++m_hand;
+        }
+        Address const victim = m_entries[m_hand].address;
+        remove(m_hand);
+        ++m_stats.evictions;
+        return victim;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_position.clear();
+        m_charged = 0;
+        m_hand = 0;
+    }
+
+    size_t size() const { return m_entries.size(); }
+    size_t charged() const { return m_charged; }
+
+    void noteHit() { ++m_stats.hits; }
+    void noteMiss() { ++m_stats.misses; }
+    Stats const& stats() const { return m_stats; }
+
+private:
+    struct Entry
+    {
+        Address address;
+        size_t cost;
+        bool referenced;
+    };
+
+    /// Fills the slot with the last entry, the hand stays put and looks at it next.
+    void remove(size_t _index)
+    {
+        m_charged -= m_entries[_index].cost;
+        m_position.erase(m_entries[_index].address);
+        if (_index + 1 != m_entries.size())
+        {
+            m_entries[_index] = m_entries.back();
+            m_position[m_entries[_index].address] = _index;
+        }
+        m_entries.pop_back();
+    }
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<Address, size_t> m_position;
+    size_t m_charged = 0;
+    size_t m_hand = 0;
+    Stats m_stats;
+};
+
+/**
+ * @brief Process-wide cache of decoded accounts keyed by state root and address.
+ * An account at a given root never changes, so every State opened at that root, such as the
+ * copies held by Block and Client or the pending block rebuilt after an import, can take it from
+ * here instead of walking the trie and decoding it again. States copy the snapshot into their own
+ * cache before using it: Account fills its storage and vote caches in const methods, so the
+ * snapshots themselves are never used in place.
+ * Accounts are kept per root. When the budget is exceeded, the oldest roots are dropped whole.
+ */
+class SharedAccountCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    /// @returns the account at @a _root, or null if it is not cached.
+    std::shared_ptr<Account const> find(h256 const& _root, Address const& _addr) const;
+    bool contains(h256 const& _root, Address const& _addr) const;
+
+    /// Caches @a _account, which must be the unchanged account at @a _root, charged @a _cost bytes.
+    void insert(h256 const& _root, Address const& _addr, Account const& _account, size_t _cost);
+
+    void setBudget(size_t _bytes);
+    void clear();
+
+    Stats stats() const;
+
+    static SharedAccountCache& instance() { static SharedAccountCache cache; return cache; }
+
+private:
+    struct Generation
+    {
+        std::unordered_map<Address, std::shared_ptr<Account const>> accounts;
+        size_t charged = 0;
+    };
+
+    /// Drops the oldest roots until the budget holds.
+    void shrink();
+
+    mutable SharedMutex x_cache;
+    std::unordered_map<h256, Generation> m_generations;
+    /// Oldest first.
+    std::deque<h256> m_roots;
+    size_t m_charged = 0;
+    size_t m_budget = 64 * 1024 * 1024;
+    mutable std::atomic<uint64_t> m_hits{0};
+    mutable std::atomic<uint64_t> m_misses{0};
+};
+
+}
+}
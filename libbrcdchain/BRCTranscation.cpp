@@ -116,32 +116,14 @@ bool dev::brc::BRCTranscation::verifyPendingOrder(Address const& _form, ex::exch
 }
 
 
-bool dev::brc::BRCTranscation::verifyCancelPendingOrder(ex::exchange_plugin& _exdb, Address _addr, h256 _hash)
+bool dev::brc::BRCTranscation::verifyCancelPendingOrder(ex::exchange_plugin const& _exdb, Address _addr, h256 _hash)
 {
 	if (_hash == h256(0))
 	{
 		return false;
 	}
 
-	std::vector <ex::order> _resultV;
-	try
-	{
-		const std::vector<h256> _HashV = { {_hash} };
-		_resultV = _exdb.cancel_order_by_trxid(_HashV, true);
-	}
-	catch (const boost::exception& e)
-	{
-		cwarn << "cancelpendingorder error" << boost::diagnostic_information(e);
-		return false;
-	}
-
-	for (auto val : _resultV)
-	{
-		if (_addr != val.sender)
-		{
-			return false;
-		}
-	}
-
-	return true;
+	// read only, the book is not touched until the cancel is executed.
+	// a database error is not an answer about the order, it goes up instead of rejecting the cancel.
+	return _exdb.is_order_owner(_hash, _addr);
 }
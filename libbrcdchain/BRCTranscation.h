@@ -39,7 +39,7 @@ namespace dev {
                                     ex::order_token_type _token_type, ex::order_buy_type _buy_type, u256 _pendingOrderNum,
                                     u256 _pendingOrderPrice, h256 _pendingOrderHash = h256(0));
 
-            bool verifyCancelPendingOrder(ex::exchange_plugin &_exdb, Address _addr, h256 _HashV);
+            bool verifyCancelPendingOrder(ex::exchange_plugin const &_exdb, Address _addr, h256 _HashV);
 
         private:
             State &m_state;
@@ -109,6 +109,8 @@ void Block::resetCurrent(int64_t _timestamp) {
     // m_currentBlock.setTimestamp(max(m_previousBlock.timestamp() + 1, _timestamp));
     m_currentBytes.clear();
     sealEngine()->populateFromParent(m_currentBlock, m_previousBlock);
+    m_state.setAccountVersion(sealEngine()->chainParams().accountVersionForBlockNumber(m_currentBlock.number()));
+    m_state.setElectorRankingFork(m_currentBlock.number() >= sealEngine()->chainParams().electorRankingForkBlock);
     // TODO: check.
 
 //    m_state.exdb().rollback();
@@ -444,6 +446,8 @@ u256 Block::enact(VerifiedBlockRef const &_block, BlockChain const &_bc) {
     // Populate m_currentBlock with the correct values.
     m_currentBlock.noteDirty();
     m_currentBlock = _block.info;
+    m_state.setAccountVersion(_bc.chainParams().accountVersionForBlockNumber(m_currentBlock.number()));
+    m_state.setElectorRankingFork(m_currentBlock.number() >= _bc.chainParams().electorRankingForkBlock);
 
     //    cnote << "playback begins:" << m_currentBlock.hash() << "(without: " <<
     //    m_currentBlock.hash(WithoutSeal) << ")"; cnote << m_state;
@@ -616,6 +620,9 @@ ExecutionResult Block::execute(LastBlockHashesFace const &_lh, Transaction const
     // Uncommitting is a non-trivial operation - only do it once we've verified as much of the
     // transaction as possible.
     uncommitToSeal();
+    // exchange operations of the block share one session, closed by cleanup() or rollback.
+    if (_p == Permanence::Committed)
+        m_state.exdb().begin_block();
     std::pair<ExecutionResult, TransactionReceipt> resultReceipt = m_state.execute(EnvInfo(info(), _lh, gasUsed()),
                                                                                    *m_sealEngine, _t, _p, _onOp);
 
@@ -826,7 +833,7 @@ LogBloom Block::logBloom() const {
     return ret;
 }
 
-void Block::cleanup() {
+void Block::cleanup(bool _exchangeCheckpoint) {
     // Commit the new trie to disk.
     //            LOG(m_logger) << "Committing to disk: stateRoot " << m_currentBlock.stateRoot() <<
     //            " = "
@@ -842,7 +849,11 @@ void Block::cleanup() {
     }
 
     m_state.db().commit();  // TODO: State API for this?
-    m_state.exdb().commit(info().number() + 1);
+    // a block off the best chain does not keep its exchange changes, the best block stays the exchange head.
+    if (_exchangeCheckpoint)
+        m_state.exdb().commit(info().number() + 1, info().hash());
+    else
+        m_state.exdb().rollback();
 
     LOG(m_logger) << "Committed: stateRoot " << m_currentBlock.stateRoot() << " = " << rootHash()
                   << " = " << toHex(asBytes(db().lookup(rootHash())));
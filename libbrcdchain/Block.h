@@ -246,7 +246,8 @@ public:
     u256 enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc);
 
     /// Returns back to a pristine state after having done a playback.
-    void cleanup();
+    /// The exchange changes of the block are kept as its checkpoint if @a _exchangeCheckpoint, else dropped.
+    void cleanup(bool _exchangeCheckpoint = true);
 
     /// Sets m_currentBlock to a clean state, (i.e. no change from m_previousBlock) and
     /// optionally modifies the timestamp.
@@ -4,7 +4,7 @@
 #include "GenesisInfo.h"
 #include "ImportPerformanceLogger.h"
 #include "State.h"
-#include "ThreadPackTransactions.h"
+#include "VerifierPool.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/Common.h>
 #include <libdevcore/DBFactory.h>
@@ -30,6 +30,27 @@ namespace fs = boost::filesystem;
 namespace {
     std::string const c_chainStart{"chainStart"};
     db::Slice const c_sliceChainStart{c_chainStart};
+
+    /// Every so many blocks the state written in the background is synced before the block is
+    /// recorded, bounding what a crash loses with --db-commit-pipeline.
+    unsigned const c_stateCheckpointInterval = 1000;
+
+    /// Block bodies are appended in bulk and read by hash.
+    std::vector<db::DatabaseFamily> const c_blocksFamilies{{"default", true, true, true}};
+    /// Receipts are large, written with every block and seldom read, they stay out of the block cache
+    /// and the compactions of the details and hashes read on every import.
+    std::vector<db::DatabaseFamily> const c_extrasFamilies{
+            {"default", true, true, false}, {"receipts", false, false, true}};
+
+    std::unique_ptr<db::DatabaseFace> openBlocks(fs::path const &_path) {
+        return db::DBFactory::create(_path, c_blocksFamilies, [](db::Slice) { return size_t(0); });
+    }
+
+    std::unique_ptr<db::DatabaseFace> openExtras(fs::path const &_path) {
+        return db::DBFactory::create(_path, c_extrasFamilies, [](db::Slice _key) {
+            return size_t(_key.size() == h256::size + 1 && (byte) _key[h256::size] == ExtraReceipts ? 1 : 0);
+        });
+    }
 }
 
 std::ostream &dev::brc::operator<<(std::ostream &_out, BlockChain const &_bc) {
@@ -204,8 +225,8 @@ unsigned BlockChain::open(fs::path const &_path, WithExisting _we) {
     }
 
     try {
-        m_blocksDB = db::DBFactory::create(chainPath / fs::path("blocks"));
-        m_extrasDB = db::DBFactory::create(extrasPath / fs::path("extras"));
+        m_blocksDB = openBlocks(chainPath / fs::path("blocks"));
+        m_extrasDB = openExtras(extrasPath / fs::path("extras"));
     }
     catch (db::DatabaseError const &ex) {
         // Check the exact reason of errror, in case of IOError we can display user-friendly message
@@ -309,8 +330,8 @@ void BlockChain::rebuild(fs::path const &_path, std::function<void(unsigned, uns
     // Keep extras DB around, but under a temp name
     m_extrasDB.reset();
     fs::rename(extrasPath / fs::path("extras"), extrasPath / fs::path("extras.old"));
-    std::unique_ptr<db::DatabaseFace> oldExtrasDB(db::DBFactory::create(extrasPath / fs::path("extras.old")));
-    m_extrasDB = db::DBFactory::create(extrasPath / fs::path("extras"));
+    std::unique_ptr<db::DatabaseFace> oldExtrasDB(openExtras(extrasPath / fs::path("extras.old")));
+    m_extrasDB = openExtras(extrasPath / fs::path("extras"));
 
     // Open a fresh state DB
 
@@ -619,15 +640,38 @@ BlockChain::import(VerifiedBlockRef const &_block, OverlayDB const &_db, ex::exc
     BlockReceipts br;
     u256 td;
     try {
-        // Check transactions are valid and that they result in a state equivalent to our state_root.
-        // Get total difficulty increase and update state, checking it.
-        Block s(*this, _db, _exdb);
-        auto tdIncrease = s.enactOn(_block, *this);
-        for (unsigned i = 0; i < s.pending().size(); ++i)
-            br.receipts.push_back(s.receipt(i));
-        s.cleanup();
-        td = pd.totalDifficulty + tdIncrease;
+        // Every block is enacted on the exchange state of its parent, the blocks after the parent are undone.
+        // The exchange state stays that of the best block: only a block which becomes the best block keeps
+        // its exchange changes, after any other block the previous head is enacted again.
+        // The total difficulty increase of a block is its difficulty, see Block::enactOn.
+        bool const isBest = isNewBest(_block.info, pd.totalDifficulty + _block.info.difficulty());
+        h256 const exchangeHead = _exdb.head_checkpoint();
+        try {
+            // Check transactions are valid and that they result in a state equivalent to our state_root.
+            // Get total difficulty increase and update state, checking it.
+            if (exchangeHead != _block.info.parentHash())
+                syncExchange(_block.info.parentHash(), _db, _exdb);
+            Block s(*this, _db, _exdb);
+            auto tdIncrease = s.enactOn(_block, *this);
+            for (unsigned i = 0; i < s.pending().size(); ++i)
+                br.receipts.push_back(s.receipt(i));
+            s.cleanup(isBest);
+            td = pd.totalDifficulty + tdIncrease;
+            if (!isBest && _exdb.head_checkpoint() != exchangeHead && !syncExchange(exchangeHead, _db, _exdb))
+                cwarn << "Exchange state not restored to " << exchangeHead;
+        }
+        catch (...) {
+            // a bad block leaves the exchange state of the best block behind it.
+            _exdb.rollback();
+            if (_exdb.head_checkpoint() != exchangeHead && !syncExchange(exchangeHead, _db, _exdb))
+                cwarn << "Exchange state not restored to " << exchangeHead;
+            throw;
+        }
         performanceLogger.onStageFinished("enactment");
+        if (_block.info.number() % c_stateCheckpointInterval == 0) {
+            _db.sync();
+            performanceLogger.onStageFinished("stateCheckpoint");
+        }
 		
 #if BRC_PARANOIA
         checkConsistency();
@@ -649,6 +693,47 @@ BlockChain::import(VerifiedBlockRef const &_block, OverlayDB const &_db, ex::exc
     return insertBlockAndExtras(_block, ref(receipts), td, performanceLogger);
 }
 
+bool BlockChain::isNewBest(BlockHeader const &_info, u256 const &_totalDifficulty) const {
+    h256 const last = currentHash();
+    return _totalDifficulty > details(last).totalDifficulty || (m_sealEngine->chainParams().tieBreakingGas &&
+                                                                _totalDifficulty == details(last).totalDifficulty &&
+                                                                _info.gasUsed() > info(last).gasUsed());
+}
+
+bool BlockChain::syncExchange(h256 const &_hash, OverlayDB const &_db, ex::exchange_plugin &_exdb) {
+    if (_exdb.head_checkpoint() == _hash)
+        return true;
+    // the blocks after the newest kept checkpoint of the branch, newest first.
+    h256s replay;
+    h256 h = _hash;
+    while (!_exdb.has_checkpoint(h)) {
+        if (replay.size() >= _exdb.checkpoint_depth() || h == m_genesisHash || !isKnown(h)) {
+            LOG(m_loggerDetail) << "No exchange checkpoint below " << _hash;
+            return false;
+        }
+        replay.push_back(h);
+        h = info(h).parentHash();
+    }
+    LOG(m_loggerDetail) << "Rewinding exchange state to " << h;
+    if (!_exdb.rewind_to(h))
+        return false;
+    try {
+        for (auto i = replay.rbegin(); i != replay.rend(); ++i) {
+            LOG(m_loggerDetail) << "Enacting exchange state of " << *i << " again";
+            bytes const b = block(*i);
+            Block s(*this, _db, _exdb);
+            s.enactOn(verifyBlock(&b, m_onBad, ImportRequirements::OutOfOrderChecks), *this);
+            s.cleanup();
+        }
+    }
+    catch (Exception const &ex) {
+        cwarn << "Exchange state of " << _hash << " not rebuilt: " << boost::diagnostic_information(ex);
+        _exdb.rollback();
+        return false;
+    }
+    return true;
+}
+
 ImportRoute
 BlockChain::insertWithoutParent(bytes const &_block, bytesConstRef _receipts, u256 const &_totalDifficulty) {
     VerifiedBlockRef const block = verifyBlock(&_block, m_onBad, ImportRequirements::OutOfOrderChecks);
@@ -726,9 +811,7 @@ BlockChain::insertBlockAndExtras(VerifiedBlockRef const &_block, bytesConstRef _
     bool isImportedAndBest = false;
     // This might be the new best block...
     h256 last = currentHash();
-    if (_totalDifficulty > details(last).totalDifficulty || (m_sealEngine->chainParams().tieBreakingGas &&
-                                                             _totalDifficulty == details(last).totalDifficulty &&
-                                                             _block.info.gasUsed() > info(last).gasUsed())) {
+    if (isNewBest(_block.info, _totalDifficulty)) {
         // don't include bi.hash() in treeRoute, since it's not yet in details DB...
         // just tack it on afterwards.
         unsigned commonIndex;
@@ -773,11 +856,16 @@ BlockChain::insertBlockAndExtras(VerifiedBlockRef const &_block, bytesConstRef _
             {
                 bytes blockBytes;
                 RLP blockRLP(*i == _block.info.hash() ? _block.block : &(blockBytes = block(*i)));
+                std::vector<bytesConstRef> transactions;
+                transactions.reserve(blockRLP[1].itemCount());
+                for (auto const &tr : blockRLP[1])
+                    transactions.push_back(tr.data());
+                h256s const transactionHashes = sha3Batch(transactions);
                 TransactionAddress ta;
                 ta.blockHash = tbi.hash();
-                for (ta.index = 0; ta.index < blockRLP[1].itemCount(); ++ta.index)
+                for (ta.index = 0; ta.index < transactionHashes.size(); ++ta.index)
                     extrasWriteBatch->insert(
-                            toSlice(sha3(blockRLP[1][ta.index].data()), ExtraTransactionAddress),
+                            toSlice(transactionHashes[ta.index], ExtraTransactionAddress),
                             (db::Slice) dev::ref(ta.rlp()));
             }
 
@@ -1142,6 +1230,10 @@ void BlockChain::garbageCollect(bool _force) {
     m_cacheUsage.push_front(std::unordered_set<CacheID>{});
 }
 
+std::string BlockChain::databaseStats() const {
+    return "blocks:\n" + m_blocksDB->stats() + "extras:\n" + m_extrasDB->stats();
+}
+
 void BlockChain::checkConsistency() {
     DEV_WRITE_GUARDED(x_details) { m_details.clear(); }
 
@@ -1337,7 +1429,7 @@ Block BlockChain::genesisBlock(OverlayDB const &_db, ex::exchange_plugin const&_
     Block ret(*this, _db, _exdb, BaseState::Empty);
     if (!_db.exists(r)) {
         ret.noteChain(*this);
-        dev::brc::commit(m_params.genesisState, ret.mutableState().m_state);        // bit horrible. maybe consider a better way of constructing it?
+        dev::brc::commit(m_params.genesisState, ret.mutableState().m_state, m_params.accountVersionForBlockNumber(0));        // bit horrible. maybe consider a better way of constructing it?
 		ret.mutableState().systemPendingorder(ret.info().timestamp());
 		ret.mutableState().db().commit();
 
@@ -1416,7 +1508,6 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
             }
             ++i;
         }
-    i = 0;
     if(_ir & (ImportRequirements::TransactionBasic | ImportRequirements::TransactionSignatures))
 	{
 
@@ -1427,64 +1518,42 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
 								  << errinfo_block(_block.toBytes()));
 		}
 
-        if(r[1].itemCount() > 300)
-		{
-			// more thread to do
-			size_t th_num = r[1].itemCount() / 200 + 1;   //test for : the transaction num:150 for one thread todo
-			th_num = (th_num % 2 != 0) ? th_num - 1 : th_num;
-			th_num = th_num > 8 ? 8 : th_num;
-			//th_num = 6;
-			std::vector<bytes> v_trxb;
-               for(auto val : r[1])
-				v_trxb.push_back(val.data().toBytes());
-			std::vector<Transaction> ret_t;
-			Task<bytes, Transaction> task_t(th_num);
-
-            try 
-			{
-			    task_t.go_task(v_trxb, ret_t, [&_ir](bytes const& b){
-				    return  Transaction(b, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None);
-			    });
-			}
-            catch(Exception& ex)
-			{
-				ex << errinfo_phase(1);
-				ex << errinfo_transactionIndex(i);
-				addBlockInfo(ex, h, _block.toBytes());
-				if(_onBad)
-					_onBad(ex);
-				throw;
-			}
-			res.transactions.clear();
-			res.transactions = ret_t;
-		}
-        else
-		{
-			double p_time = 0;
-			double v_time = 0;
-			for(RLP const& tr : r[1])
-			{
-				bytesConstRef d = tr.data();
-				try
-				{
-					Transaction t(d, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None);
-					m_sealEngine->verifyTransaction(_ir, t, h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
-					res.transactions.push_back(t);
-				}
-				catch(Exception& ex)
-				{
-					ex << errinfo_phase(1);
-					ex << errinfo_transactionIndex(i);
-					ex << errinfo_transaction(d.toBytes());
-					addBlockInfo(ex, h, _block.toBytes());
-					if(_onBad)
-						_onBad(ex);
-					throw;
-				}
-				++i;
-			}
-		}
-		
+        // Slices of _block, every transaction is decoded in place on the verifier pool.
+        std::vector<bytesConstRef> slices;
+        slices.reserve(r[1].itemCount());
+        for(RLP const& tr : r[1])
+            slices.push_back(tr.data());
+        CheckTransaction const check = (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None;
+        // Blocks of more than 300 transactions have always been accepted without the seal engine's
+        // transaction rules, which stays so to accept the same blocks.
+        bool const verifyRules = slices.size() <= 300;
+        res.transactions.resize(slices.size());
+        try
+        {
+            VerifierPool::instance().run(slices.size(), [&](size_t _i){
+                try
+                {
+                    Transaction t(slices[_i], check);
+                    if(verifyRules)
+                        m_sealEngine->verifyTransaction(_ir, t, h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
+                    res.transactions[_i] = std::move(t);
+                }
+                catch(Exception& ex)
+                {
+                    ex << errinfo_transactionIndex(_i);
+                    ex << errinfo_transaction(slices[_i].toBytes());
+                    throw;
+                }
+            });
+        }
+        catch(Exception& ex)
+        {
+            ex << errinfo_phase(1);
+            addBlockInfo(ex, h, _block.toBytes());
+            if(_onBad)
+                _onBad(ex);
+            throw;
+        }
 	}
     res.block = bytesConstRef(_block);
     return res;
@@ -284,6 +284,9 @@ public:
     /// Deallocate unused data.
     void garbageCollect(bool _force = false);
 
+    /// @returns the internal statistics of the blocks and extras databases, for the logs.
+    std::string databaseStats() const;
+
     /// Change the function that is called with a bad block.
     void setOnBad(std::function<void(Exception&)> _t) { m_onBad = _t; }
 
@@ -325,6 +328,12 @@ private:
     void close();
 
     ImportRoute insertBlockAndExtras(VerifiedBlockRef const& _block, bytesConstRef _receipts, u256 const& _totalDifficulty, ImportPerformanceLogger& _performanceLogger);
+    /// @returns true if a block of @a _info and @a _totalDifficulty becomes the best block on insertion.
+    bool isNewBest(BlockHeader const& _info, u256 const& _totalDifficulty) const;
+    /// Bring the exchange state to the end of block @a _hash: rewind to the newest checkpoint on its branch,
+    /// then enact the blocks after it again. @returns false, and leaves the exchange where it is, if its branch
+    /// has no kept checkpoint or a block fails.
+    bool syncExchange(h256 const& _hash, OverlayDB const& _db, ex::exchange_plugin& _exdb);
     void checkBlockIsNew(VerifiedBlockRef const& _block) const;
     void checkBlockTimestamp(BlockHeader const& _header) const;
 
@@ -67,9 +67,16 @@ ChainParams ChainParams::loadConfig(
     setOptionalU256Parameter(cp.constantinopleForkBlock, c_constantinopleForkBlock);
     setOptionalU256Parameter(cp.daoHardforkBlock, c_daoHardforkBlock);
     setOptionalU256Parameter(cp.experimentalForkBlock, c_experimentalForkBlock);
+    setOptionalU256Parameter(cp.voteTrieForkBlock, c_voteTrieForkBlock);
+    setOptionalU256Parameter(cp.blockRewardTrieForkBlock, c_blockRewardTrieForkBlock);
+    setOptionalU256Parameter(cp.electorRankingForkBlock, c_electorRankingForkBlock);
     setOptionalU256Parameter(cp.minimumDifficulty, c_minimumDifficulty);
     setOptionalU256Parameter(cp.difficultyBoundDivisor, c_difficultyBoundDivisor);
     setOptionalU256Parameter(cp.durationLimit, c_durationLimit);
+    // account version 2 also writes the vote trie, see accountVersionForBlockNumber.
+    if (cp.blockRewardTrieForkBlock < cp.voteTrieForkBlock)
+        BOOST_THROW_EXCEPTION(InvalidForkOrder() << errinfo_comment(
+                c_blockRewardTrieForkBlock + " must not be before " + c_voteTrieForkBlock));
 
     if (params.count(c_chainID))
         cp.chainID = int(u256(fromBigEndian<u256>(fromHex(params.at(c_chainID).get_str()))));
@@ -263,7 +270,7 @@ h256 ChainParams::calculateStateRoot(bool _force) const
     {
         // TODO: use hash256
         //stateRoot = hash256(toBytesMap(gs));
-        dev::brc::commit(genesisState, state);
+        dev::brc::commit(genesisState, state, accountVersionForBlockNumber(0));
         stateRoot = state.root();
     }
     return stateRoot;
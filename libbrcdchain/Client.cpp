@@ -443,6 +443,7 @@ void Client::syncTransactionQueue()
 void Client::onDeadBlocks(h256s const& _blocks, h256Hash& io_changed)
 {
     // insert transactions that we are declaring the dead part of the chain
+    Transactions dead;
     for (auto const& h: _blocks)
     {
         LOG(m_loggerDetail) << "Dead block: " << h;
@@ -450,9 +451,17 @@ void Client::onDeadBlocks(h256s const& _blocks, h256Hash& io_changed)
         {
             //LOG(m_loggerDetail) << "Resubmitting dead-block transaction "<< Transaction(t, CheckTransaction::None);
             //ctrace << "Resubmitting dead-block transaction " << Transaction(t, CheckTransaction::None);
-            m_tq.import(t, IfDropped::Retry);
+            try
+            {
+                dead.emplace_back(t, CheckTransaction::Cheap);
+            }
+            catch (Exception const&)
+            {
+                // malformed, the queue would refuse it as well.
+            }
         }
     }
+    m_tq.import(dead, IfDropped::Retry);
 
     for (auto const& h: _blocks)
         appendFromBlock(h, BlockPolarity::Dead, io_changed);
@@ -743,6 +752,12 @@ void Client::tick()
         if (m_report.ticks == 15)
             LOG(m_loggerDetail) << activityReport();
     }
+    if (chrono::system_clock::now() - m_lastDatabaseStats > chrono::minutes(1))
+    {
+        LOG(m_loggerDetail) << "State database:\n" << m_stateDB.stats();
+        LOG(m_loggerDetail) << "Chain databases:\n" << bc().databaseStats();
+        m_lastDatabaseStats = chrono::system_clock::now();
+    }
 }
 
 void Client::checkWatchGarbage()
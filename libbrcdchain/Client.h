@@ -343,6 +343,8 @@ protected:
                                             ///< When did we last both doing GC on the watches?
     mutable std::chrono::system_clock::time_point m_lastTick = std::chrono::system_clock::now();
                                             ///< When did we last tick()?
+    std::chrono::system_clock::time_point m_lastDatabaseStats = std::chrono::system_clock::now();
+                                            ///< When did we last log the database statistics?
 
     unsigned m_syncAmount = 50;             ///< Number of blocks to sync in each go.
 
@@ -134,6 +134,25 @@ Json::Value dev::brc::ClientBase::successPendingOrderMessage(uint32_t _getSize,
 	return blockByNumber(_block).mutableState().successPendingOrderMsg(_getSize);
 }
 
+Json::Value dev::brc::ClientBase::pendingOrderPoolPage(uint8_t _order_type, uint8_t _order_token_type,
+    uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const
+{
+    return blockByNumber(_block).mutableState().pendingOrderPoolPage(
+        _order_type, _order_token_type, _getSize, _cursor);
+}
+
+Json::Value dev::brc::ClientBase::pendingOrderPoolForAddrPage(
+    Address _a, uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const
+{
+    return blockByNumber(_block).mutableState().pendingOrderPoolForAddrPage(_a, _getSize, _cursor);
+}
+
+Json::Value dev::brc::ClientBase::successPendingOrderPage(
+    uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const
+{
+    return blockByNumber(_block).mutableState().successPendingOrderPage(_getSize, _cursor);
+}
+
 Json::Value dev::brc::ClientBase::obtainVoteMessage(Address _a, BlockNumber _block) const
 {
 	return blockByNumber(_block).mutableState().electorMessage(_a);
@@ -64,6 +64,9 @@ public:
 	using Interface::pendingOrderPoolMessage;
 	using Interface::pendingOrderPoolForAddrMessage;
 	using Interface::successPendingOrderMessage;
+	using Interface::pendingOrderPoolPage;
+	using Interface::pendingOrderPoolForAddrPage;
+	using Interface::successPendingOrderPage;
 
     u256 balanceAt(Address _a, BlockNumber _block) const override;
     u256 ballotAt(Address _a, BlockNumber _block) const override;
@@ -78,6 +81,11 @@ public:
     Json::Value pendingOrderPoolMessage(uint8_t _order_type, uint8_t _order_token_type, u256 _getSize, BlockNumber _block) const override;
     Json::Value pendingOrderPoolForAddrMessage(Address _a, uint32_t _getSize, BlockNumber _block) const override;
 	Json::Value successPendingOrderMessage(uint32_t _getSize, BlockNumber _block) const override;
+    Json::Value pendingOrderPoolPage(uint8_t _order_type, uint8_t _order_token_type, uint32_t _getSize,
+        std::string const& _cursor, BlockNumber _block) const override;
+    Json::Value pendingOrderPoolForAddrPage(
+        Address _a, uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const override;
+    Json::Value successPendingOrderPage(uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const override;
 	
 	Json::Value obtainVoteMessage(Address _a, BlockNumber _block) const override;
 	Json::Value votedMessage(Address _a, BlockNumber _block) const override;
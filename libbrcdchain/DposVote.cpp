@@ -46,8 +46,7 @@ bool dev::brc::DposVote::verifyVote(Address const & _from, Address const & _to,
 				_ex_info = " Accout not is Candidate";
 				return false;
 			}
-            std::unordered_map<Address, u256> _vote = m_state.voteDate(SysElectorAddress);
-			if(_vote.find(_from) != _vote.end())
+			if(m_state.hasVote(SysElectorAddress, _from))
 			{
 				_ex_info = " Accout early is Candidate";
 				return false;
@@ -65,8 +64,7 @@ bool dev::brc::DposVote::verifyVote(Address const & _from, Address const & _to,
 				_ex_info = " Accout not is Candidate";
 				return false;
 			}
-            std::unordered_map<Address, u256> _vote = m_state.voteDate(SysElectorAddress);
-			if(_vote.find(_from) == _vote.end())
+			if(!m_state.hasVote(SysElectorAddress, _from))
 			{
 				_ex_info = " Accout not is Candidate";
 				return false;
@@ -84,8 +82,7 @@ bool dev::brc::DposVote::verifyVote(Address const & _from, Address const & _to,
                 return false;
             }
             //验证 竞选人是否存在
-            std::unordered_map<Address, u256> _vote = m_state.voteDate(SysElectorAddress);
-            if(_vote.find(_to) == _vote.end())
+            if(!m_state.hasVote(SysElectorAddress, _to))
             {
                 //LOG(m_logger) << "the Elector:" << _to << " don't have !";
 				_ex_info = "the Elector:" + toString(_to) +" not exist !";
@@ -97,9 +94,7 @@ bool dev::brc::DposVote::verifyVote(Address const & _from, Address const & _to,
         case dev::brc::EUnDelegate:
         {
             //撤销投票
-            std::unordered_map<Address, u256> _vote = m_state.voteDate(_from);
-            auto ret = _vote.find(_to);
-            if(ret == _vote.end() || ret->second < tickets)
+            if(!m_state.hasVote(_from, _to) || m_state.voteAdress(_from, _to) < tickets)
             {
                 _ex_info= " Address:" + toString(_from) + " not voted:" +  toString(tickets) + " tickets to :" + toString( _to);
                 return false;
@@ -115,6 +110,14 @@ bool dev::brc::DposVote::verifyVote(Address const & _from, Address const & _to,
 
 void dev::brc::DposVote::getSortElectors(std::vector<Address>& _electors, size_t _num, std::vector<Address> _ignore) const
 {
+    if(m_state.electorRankingFork())
+    {
+        //根据投票数量排序 由State维护排名, 这里只取前 _num 个
+        std::vector<Address> const _v = m_state.sortedElectors(_num, _ignore);
+        _electors.insert(_electors.end(), _v.begin(), _v.end());
+        return;
+    }
+    // 分叉前的结果: _num > 1 时为空, 否则为全部竞选人
     std::unordered_map<Address, u256> _eletors_temp = getElectors();
     for (auto it : _ignore)
     {
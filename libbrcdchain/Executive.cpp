@@ -263,8 +263,8 @@ void Executive::initialize(Transaction const& _transaction)
         else
         {
             m_callParameters_v.clear();
-            RLP _r(m_t.data());
-            std::vector<bytes> _ops = _r.toVector<bytes>();
+            std::vector<transationTool::decoded_operation> const _ops =
+                transationTool::decode_operations(&m_t.data());
 			if(_ops.empty())
 			{
 
@@ -277,15 +277,14 @@ void Executive::initialize(Transaction const& _transaction)
 					<< errinfo_comment(m_t.sender().hex()));
 			}
 
-            for (auto val : _ops)
+            for (auto const& val : _ops)
             {
 				std::string _ret = "";
-                transationTool::op_type _type = transationTool::operation::get_type(val);
-                switch (_type)
+                switch (val.type)
                 {
                 case transationTool::vote:
                 {
-                    transationTool::vote_operation _vote_op = transationTool::vote_operation(val);
+                    transationTool::vote_operation const& _vote_op = val.get<transationTool::vote_operation>();
                     size_t _tickets = 0;
                     LOG(m_execLogger) << BrcYellow " init transation _from:" << _vote_op.m_from
                                       << " _to:" << _vote_op.m_to
@@ -336,8 +335,8 @@ void Executive::initialize(Transaction const& _transaction)
                 case transationTool::brcTranscation:
                 {
 					bigint totalCost = gasCost;
-                    transationTool::transcation_operation _transcation_op =
-                        transationTool::transcation_operation(val);
+                    transationTool::transcation_operation const& _transcation_op =
+                        val.get<transationTool::transcation_operation>();
                     if (m_s.balance(m_t.sender()) < totalCost)
                     {
                         LOG(m_execLogger)
@@ -377,8 +376,8 @@ void Executive::initialize(Transaction const& _transaction)
                 break;
                 case transationTool::pendingOrder:
                 {
-                    transationTool::pendingorder_opearaion _pengdingorder_op =
-                        transationTool::pendingorder_opearaion(val);
+                    transationTool::pendingorder_opearaion const& _pengdingorder_op =
+                        val.get<transationTool::pendingorder_opearaion>();
 					bigint totalCost = gasCost;
                     if (m_s.balance(m_t.sender()) < totalCost)
                     { 
@@ -424,8 +423,8 @@ void Executive::initialize(Transaction const& _transaction)
                 break;
 				case transationTool::cancelPendingOrder:
                 {
-					transationTool::cancelPendingorder_operation  _cancel_op =
-                        transationTool::cancelPendingorder_operation(val);
+					transationTool::cancelPendingorder_operation const& _cancel_op =
+                        val.get<transationTool::cancelPendingorder_operation>();
 					bigint totalCost = gasCost;
                     if (m_s.balance(m_t.sender()) < totalCost)
                     {
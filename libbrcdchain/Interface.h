@@ -132,6 +132,19 @@ public:
 	{
 		return successPendingOrderMessage(_getSize, m_default);
 	}
+    Json::Value pendingOrderPoolPage(
+        uint8_t _order_type, uint8_t _order_token_type, uint32_t _getSize, std::string const& _cursor) const
+    {
+        return pendingOrderPoolPage(_order_type, _order_token_type, _getSize, _cursor, m_default);
+    }
+    Json::Value pendingOrderPoolForAddrPage(Address _a, uint32_t _getSize, std::string const& _cursor) const
+    {
+        return pendingOrderPoolForAddrPage(_a, _getSize, _cursor, m_default);
+    }
+    Json::Value successPendingOrderPage(uint32_t _getSize, std::string const& _cursor) const
+    {
+        return successPendingOrderPage(_getSize, _cursor, m_default);
+    }
 
     virtual u256 balanceAt(Address _a, BlockNumber _block) const = 0;
     virtual u256 ballotAt(Address _a, BlockNumber _block) const = 0;
@@ -149,6 +162,14 @@ public:
         uint8_t _order_type, uint8_t _order_toke_type, u256 getSize, BlockNumber _block) const = 0;
     virtual Json::Value pendingOrderPoolForAddrMessage(
         Address _a, uint32_t _getSize, BlockNumber _block) const = 0;
+    /// Paged variants of the order queries: {"orders": [...], "next": cursor}, pass "next" back
+    /// as @a _cursor for the following page. An empty cursor starts from the first order.
+    virtual Json::Value pendingOrderPoolPage(uint8_t _order_type, uint8_t _order_token_type,
+        uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const = 0;
+    virtual Json::Value pendingOrderPoolForAddrPage(
+        Address _a, uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const = 0;
+    virtual Json::Value successPendingOrderPage(
+        uint32_t _getSize, std::string const& _cursor, BlockNumber _block) const = 0;
 		
 	virtual Json::Value obtainVoteMessage(Address _a, BlockNumber _block) const = 0;
 	virtual Json::Value votedMessage(Address _a, BlockNumber _block) const = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <libdevcore/Address.h>
 #include <libdevcore/TrieDB.h>
 
 namespace dev
@@ -14,5 +15,13 @@ template <class KeyType, class DB>
 using SecureTrieDB = SpecificTrieDB<HashedGenericTrieDB<DB>, KeyType>;
 #endif
 
+/// Vote records of an account, keyed by the plain voted address so the records can be walked.
+template <class DB>
+using VoteTrieDB = SpecificTrieDB<GenericTrieDB<DB>, Address>;
+
+/// Block reward history of an account, keyed by the big endian block number.
+template <class DB>
+using BlockRewardTrieDB = SpecificTrieDB<GenericTrieDB<DB>, h256>;
+
 }  // namespace brc
 }  // namespace dev
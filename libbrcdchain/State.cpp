@@ -9,6 +9,7 @@
 #include <libdevcore/Assertions.h>
 #include <libdevcore/CommonJS.h>
 #include <libdevcore/DBFactory.h>
+#include <libdevcore/PipelinedDB.h>
 #include <libdevcore/TrieHash.h>
 #include <boost/filesystem.hpp>
 #include <boost/timer.hpp>
@@ -23,6 +24,64 @@ namespace fs = boost::filesystem;
 #define BRCNUM 1000
 #define COOKIENUM 100000000000
 
+namespace {
+/// Versions of the account RLP, appended as the 13th item from version 1 on.
+/// 0 (12 items): field 6 and 11 are nested RLP lists of the vote records and block reward history.
+/// 1: field 6 is the root of the vote trie.
+/// 2: field 11 is the root of the block reward trie as well.
+unsigned const c_voteTrieVersion = 1;
+unsigned const c_blockRewardTrieVersion = 2;
+
+/// Read by every vote and election, never evicted from the account cache.
+bool isPinnedAccount(Address const& _addr) {
+    return _addr == SysElectorAddress || _addr == SysVarlitorAddress || _addr == SysCanlitorAddress;
+}
+
+/// Rough memory of a decoded account, the legacy vote and reward maps dominate for old accounts.
+size_t approximateAccountSize(Account const& _account) {
+    size_t const c_mapNode = 64;
+    return sizeof(Address) + sizeof(Account) + _account.code().size() +
+           _account.legacyVoteData().size() * (sizeof(Address) + sizeof(u256) + c_mapNode) +
+           _account.legacyBlockReward().size() * (2 * sizeof(u256) + c_mapNode);
+}
+
+/// Trie nodes are read by random hash all the time, the aux entries written by OverlayDB under
+/// their hash followed by 255 hardly ever.
+std::vector<db::DatabaseFamily> const c_stateFamilies{{"default", true, true, false}, {"aux", false, false, false}};
+
+size_t stateFamily(db::Slice _key)
+{
+    return _key.size() == h256::size + 1 && (byte)_key[h256::size] == 255 ? 1 : 0;
+}
+
+/// Continuation token of an order page: hex RLP of the key of its last order.
+std::string orderCursorToString(ex::order_cursor const& _c)
+{
+    RLPStream s(5);
+    s << _c.trxid << (uint8_t)_c.type << (uint8_t)_c.token_type << _c.price << (uint64_t)_c.create_time;
+    return toHex(s.out());
+}
+
+ex::order_cursor orderCursorFromString(std::string const& _s)
+{
+    ex::order_cursor c;
+    if (_s.empty())
+        return c;
+    bytes const data = fromHex(_s, WhenError::Throw);
+    RLP r(data, RLP::VeryStrict);
+    c.trxid = r[0].toHash<h256>(RLP::VeryStrict);
+    c.type = (ex::order_type)r[1].toInt<uint8_t>();
+    c.token_type = (ex::order_token_type)r[2].toInt<uint8_t>();
+    c.price = r[3].toInt<u256>();
+    c.create_time = (int64_t)r[4].toInt<uint64_t>();
+    return c;
+}
+}
+
+/// About 4000 accounts without legacy maps.
+size_t State::s_accountCacheBudget = 4 * 1024 * 1024;
+ex::segment_options State::s_exdbOptions;
+
 
 State::State(u256 const& _accountStartNonce, OverlayDB const& _db, ex::exchange_plugin const& _exdb,
     BaseState _bs)
@@ -38,11 +97,16 @@ State::State(State const &_s)
         : m_db(_s.m_db),
           m_exdb(_s.m_exdb),
           m_state(&m_db, _s.m_state.root(), Verification::Skip),
-          m_cache(_s.m_cache),
-          m_unchangedCacheEntries(_s.m_unchangedCacheEntries),
           m_nonExistingAccountsCache(_s.m_nonExistingAccountsCache),
           m_touched(_s.m_touched),
-          m_accountStartNonce(_s.m_accountStartNonce) {}
+          m_accountStartNonce(_s.m_accountStartNonce),
+          m_accountVersion(_s.m_accountVersion),
+          m_electorRanking(_s.m_electorRanking),
+          m_electorPolls(_s.m_electorPolls),
+          m_electorRankingValid(_s.m_electorRankingValid),
+          m_electorRankingFork(_s.m_electorRankingFork) {
+    copyChangedAccounts(_s);
+}
 
 OverlayDB State::openDB(fs::path const &_basePath, h256 const &_genesisHash, WithExisting _we) {
     fs::path path = _basePath.empty() ? db::databasePath() : _basePath;
@@ -60,7 +124,10 @@ OverlayDB State::openDB(fs::path const &_basePath, h256 const &_genesisHash, Wit
     }
 
     try {
-        std::unique_ptr<db::DatabaseFace> db = db::DBFactory::create(path / fs::path("state"));
+        std::unique_ptr<db::DatabaseFace> db =
+                db::DBFactory::create(path / fs::path("state"), c_stateFamilies, stateFamily);
+        if (db::isDiskDatabase() && db::commitPipelineDepth())
+            db.reset(new db::PipelinedDB(std::move(db), db::commitPipelineDepth()));
         clog(VerbosityTrace, "statedb") << "Opened state DB.";
         return OverlayDB(std::move(db));
     }
@@ -87,7 +154,7 @@ ex::exchange_plugin State::openExdb(boost::filesystem::path const &_path, WithEx
         fs::remove_all(_path);
     }
     try {
-        ex::exchange_plugin exdb = ex::exchange_plugin(_path);
+        ex::exchange_plugin exdb = ex::exchange_plugin(_path, s_exdbOptions);
         return exdb;
     }
     catch (const std::exception &) {
@@ -102,7 +169,7 @@ void State::populateFrom(AccountMap const &_map) {
     if (it != m_cache.end())
         a = it->second;
 	cerror << "State::populateFrom ";
-    brc::commit(_map, m_state);
+    brc::commit(_map, m_state, m_accountVersion);
     commit(State::CommitBehaviour::KeepEmptyAccounts);
 }
 
@@ -131,25 +198,52 @@ State &State::operator=(State const &_s) {
     m_db = _s.m_db;
     m_exdb = _s.m_exdb;
     m_state.open(&m_db, _s.m_state.root(), Verification::Skip);
-    m_cache = _s.m_cache;
-    m_unchangedCacheEntries = _s.m_unchangedCacheEntries;
+    copyChangedAccounts(_s);
     m_nonExistingAccountsCache = _s.m_nonExistingAccountsCache;
     m_touched = _s.m_touched;
     m_accountStartNonce = _s.m_accountStartNonce;
+    m_accountVersion = _s.m_accountVersion;
+    m_electorRanking = _s.m_electorRanking;
+    m_electorPolls = _s.m_electorPolls;
+    m_electorRankingValid = _s.m_electorRankingValid;
+    m_electorRankingFork = _s.m_electorRankingFork;
     return *this;
 }
 
+void State::copyChangedAccounts(State const &_s) {
+    // the unchanged accounts are at the root of _s, the copy takes them from the shared cache.
+    m_cache.clear();
+    m_unchangedCacheEntries.clear();
+    for (auto const &i : _s.m_cache)
+        if (i.second.isDirty())
+            m_cache.emplace(i.first, i.second);
+}
+
 Account const *State::account(Address const &_a) const {
     return const_cast<State *>(this)->account(_a);
 }
 
 Account *State::account(Address const &_addr) {
     auto it = m_cache.find(_addr);
-    if (it != m_cache.end())
+    if (it != m_cache.end()) {
+        m_unchangedCacheEntries.noteHit();
+        m_unchangedCacheEntries.touch(_addr);
         return &it->second;
+    }
 
-    if (m_nonExistingAccountsCache.count(_addr))
+    if (m_nonExistingAccountsCache.count(_addr)) {
+        m_unchangedCacheEntries.noteHit();
         return nullptr;
+    }
+
+    m_unchangedCacheEntries.noteMiss();
+    if (auto shared = SharedAccountCache::instance().find(m_state.root(), _addr)) {
+        clearCacheIfTooLarge();
+        auto i = m_cache.emplace(_addr, *shared);
+        if (!isPinnedAccount(_addr))
+            m_unchangedCacheEntries.insert(_addr, approximateAccountSize(i.first->second));
+        return &i.first->second;
+    }
 
     // Populate basic info.
     string stateBack = m_state.at(_addr);
@@ -162,24 +256,36 @@ Account *State::account(Address const &_addr) {
 
     RLP state(stateBack);
 
-    const bytes _b = state[6].toBytes();
-    RLP vote(_b);
-    size_t num = vote[0].toInt<size_t>();
+    unsigned const version = state.itemCount() > 12 ? state[12].toInt<unsigned>() : 0;
+    h256 voteRoot;
     std::unordered_map<Address, u256> _vote;
-    for (size_t j = 1; j <= num; j++) {
-        std::pair<Address, u256> _pair = vote[j].toPair<Address, u256>();
-        _vote.insert(_pair);
+    if (version >= c_voteTrieVersion)
+        voteRoot = state[6].toHash<h256>();
+    else {
+        // legacy encoding, the records are moved to a vote trie when the account is written after the fork.
+        const bytes _b = state[6].toBytes();
+        RLP vote(_b);
+        size_t num = vote[0].toInt<size_t>();
+        for (size_t j = 1; j <= num; j++) {
+            std::pair<Address, u256> _pair = vote[j].toPair<Address, u256>();
+            _vote.insert(_pair);
+        }
     }
 
-	const bytes _bBlockReward = state[11].toBytes();
-	RLP _rlpBlockReward(_bBlockReward);
-	num = _rlpBlockReward[0].toInt<size_t>();
+    h256 blockRewardRoot;
 	std::unordered_map<u256, u256> _blockReward;
-	for (size_t k = 1; k <= num; k++)
-	{
-		std::pair<u256, u256> _blockpair = _rlpBlockReward[k].toPair<u256, u256>();
-        _blockReward.insert(_blockpair);
-	}
+    if (version >= c_blockRewardTrieVersion)
+        blockRewardRoot = state[11].toHash<h256>();
+    else {
+        const bytes _bBlockReward = state[11].toBytes();
+        RLP _rlpBlockReward(_bBlockReward);
+        size_t num = _rlpBlockReward[0].toInt<size_t>();
+        for (size_t k = 1; k <= num; k++)
+        {
+            std::pair<u256, u256> _blockpair = _rlpBlockReward[k].toPair<u256, u256>();
+            _blockReward.insert(_blockpair);
+        }
+    }
 
     auto i = m_cache.emplace(std::piecewise_construct, std::forward_as_tuple(_addr),
                              std::forward_as_tuple(state[0].toInt<u256>(), state[1].toInt<u256>(),
@@ -188,28 +294,20 @@ Account *State::account(Address const &_addr) {
                                                    state[5].toInt<u256>(), state[7].toInt<u256>(),
                                                    state[8].toInt<u256>(),
                                                    state[9].toInt<u256>(),
-								 Account::Unchanged, state[10].toInt<u256>()));
+								 Account::Unchanged, state[10].toInt<u256>(), voteRoot, blockRewardRoot));
     i.first->second.setVoteDate(_vote);
 	i.first->second.setBlockReward(_blockReward);
 
-    m_unchangedCacheEntries.push_back(_addr);
+    size_t const cost = approximateAccountSize(i.first->second);
+    SharedAccountCache::instance().insert(m_state.root(), _addr, i.first->second, cost);
+    if (!isPinnedAccount(_addr))
+        m_unchangedCacheEntries.insert(_addr, cost);
     return &i.first->second;
 }
 
 void State::clearCacheIfTooLarge() const {
-    // TODO: Find a good magic number
-    while (m_unchangedCacheEntries.size() > 1000) {
-        // Remove a random element
-        // FIXME: Do not use random device as the engine. The random device should be only used to
-        // seed other engine.
-        size_t const randomIndex = std::uniform_int_distribution<size_t>(
-                0, m_unchangedCacheEntries.size() - 1)(dev::s_fixedHashEngine);
-
-        Address const addr = m_unchangedCacheEntries[randomIndex];
-        swap(m_unchangedCacheEntries[randomIndex], m_unchangedCacheEntries.back());
-        m_unchangedCacheEntries.pop_back();
-
-        auto cacheEntry = m_cache.find(addr);
+    while (m_unchangedCacheEntries.overBudget(s_accountCacheBudget)) {
+        auto cacheEntry = m_cache.find(m_unchangedCacheEntries.evict());
         if (cacheEntry != m_cache.end() && !cacheEntry->second.isDirty())
             m_cache.erase(cacheEntry);
     }
@@ -218,7 +316,12 @@ void State::clearCacheIfTooLarge() const {
 void State::commit(CommitBehaviour _commitBehaviour) {
     if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
         removeEmptyAccounts();
-    m_touched += dev::brc::commit(m_cache, m_state);
+    m_touched += dev::brc::commit(m_cache, m_state, m_accountVersion);
+    // what was not written is the same at the new root, hand it to the next block.
+    SharedAccountCache &shared = SharedAccountCache::instance();
+    for (auto const &i : m_cache)
+        if (!i.second.isDirty() && !shared.contains(m_state.root(), i.first))
+            shared.insert(m_state.root(), i.first, i.second, approximateAccountSize(i.second));
     m_changeLog.clear();
     m_cache.clear();
     m_unchangedCacheEntries.clear();
@@ -296,6 +399,7 @@ void State::setRoot(h256 const &_r) {
     m_cache.clear();
     m_unchangedCacheEntries.clear();
     m_nonExistingAccountsCache.clear();
+    m_electorRankingValid = false;
     //  m_touched.clear();
     m_state.setRoot(_r);
 }
@@ -716,47 +820,55 @@ void State::freezeAmount(Address const& _addr, u256 _pendingOrderNum, u256 _pend
     }
 }
 
+Json::Value State::exchangeOrderJson(ex::exchange_order const& _o) {
+    Json::Value _value;
+    _value["Address"] = toJS(_o.sender);
+    _value["Hash"] = toJS(_o.trxid);
+    _value["price"] = std::string(_o.price);
+    _value["token_amount"] = std::string(_o.token_amount);
+    _value["source_amount"] = std::string(_o.source_amount);
+    _value["create_time"] = toJS(_o.create_time);
+    std::tuple<std::string, std::string, std::string> _resultTuple = enumToString(_o.type, _o.token_type,
+                                                                                  (ex::order_buy_type) 0);
+    _value["order_type"] = get<0>(_resultTuple);
+    _value["order_token_type"] = get<1>(_resultTuple);
+    return _value;
+}
+
+Json::Value State::resultOrderJson(ex::result_order const& _o) {
+    Json::Value _value;
+    _value["Address"] = toJS(_o.sender);
+    _value["Acceptor"] = toJS(_o.acceptor);
+    _value["Hash"] = toJS(_o.send_trxid);
+    _value["AcceptorHash"] = toJS(_o.to_trxid);
+    _value["price"] = std::string(_o.price);
+    _value["amount"] = std::string(_o.amount);
+    _value["create_time"] = toJS(_o.create_time);
+    std::tuple<std::string, std::string, std::string> _resultTuple = enumToString(_o.type, _o.token_type,
+                                                                                  _o.buy_type);
+    _value["order_type"] = get<0>(_resultTuple);
+    _value["order_token_type"] = get<1>(_resultTuple);
+    _value["order_buy_type"] = get<2>(_resultTuple);
+    return _value;
+}
+
 Json::Value State::pendingOrderPoolMsg(uint8_t _order_type, uint8_t _order_token_type, u256 getSize) {
     std::vector<exchange_order> _v = m_exdb.get_order_by_type(
             (order_type) _order_type, (order_token_type) _order_token_type, (uint32_t) getSize);
 
     Json::Value _JsArray;
-    for (auto val : _v) {
-        Json::Value _value;
-        _value["Address"] = toJS(val.sender);
-        _value["Hash"] = toJS(val.trxid);
-        _value["price"] = std::string(val.price);
-        _value["token_amount"] = std::string(val.token_amount);
-        _value["source_amount"] = std::string(val.source_amount);
-        _value["create_time"] = toJS(val.create_time);
-        std::tuple<std::string, std::string, std::string> _resultTuple = enumToString(val.type, val.token_type,
-                                                                                      (ex::order_buy_type) 0);
-        _value["order_type"] = get<0>(_resultTuple);
-        _value["order_token_type"] = get<1>(_resultTuple);
-        _JsArray.append(_value);
-    }
+    for (auto const& val : _v)
+        _JsArray.append(exchangeOrderJson(val));
 
     return _JsArray;
 }
 
 Json::Value State::pendingOrderPoolForAddrMsg(Address _a, uint32_t _getSize) {
-    std::vector<exchange_order> _v = m_exdb.get_order_by_address(_a);
+    std::vector<exchange_order> _v = m_exdb.get_order_by_address(_a, _getSize);
     Json::Value _JsArray;
 
-    for (auto val : _v) {
-        Json::Value _value;
-        _value["Address"] = toJS(val.sender);
-        _value["Hash"] = toJS(val.trxid);
-		_value["price"] = std::string(val.price);
-        _value["token_amount"] = std::string(val.token_amount);
-        _value["source_amount"] = std::string(val.source_amount);
-        _value["create_time"] = toJS(val.create_time);
-        std::tuple<std::string, std::string, std::string> _resultTuple = enumToString(val.type, val.token_type,
-                                                                                      (ex::order_buy_type) 0);
-        _value["order_type"] = get<0>(_resultTuple);
-        _value["order_token_type"] = get<1>(_resultTuple);
-        _JsArray.append(_value);
-    }
+    for (auto const& val : _v)
+        _JsArray.append(exchangeOrderJson(val));
 
     return _JsArray;
 }
@@ -765,26 +877,44 @@ Json::Value State::successPendingOrderMsg(uint32_t _getSize) {
     std::vector<result_order> _v = m_exdb.get_result_orders_by_news(_getSize);
     Json::Value _JsArray;
 
-    for (auto val : _v) {
-        Json::Value _value;
-        _value["Address"] = toJS(val.sender);
-        _value["Acceptor"] = toJS(val.acceptor);
-        _value["Hash"] = toJS(val.send_trxid);
-        _value["AcceptorHash"] = toJS(val.to_trxid);
-        _value["price"] = std::string(val.price);
-		_value["amount"] = std::string(val.amount);
-        _value["create_time"] = toJS(val.create_time);
-        std::tuple<std::string, std::string, std::string> _resultTuple = enumToString(val.type, val.token_type,
-                                                                                      val.buy_type);
-        _value["order_type"] = get<0>(_resultTuple);
-        _value["order_token_type"] = get<1>(_resultTuple);
-        _value["order_buy_type"] = get<2>(_resultTuple);
-        _JsArray.append(_value);
-    }
+    for (auto const& val : _v)
+        _JsArray.append(resultOrderJson(val));
 
     return _JsArray;
 }
 
+Json::Value State::pendingOrderPoolPage(
+    uint8_t _order_type, uint8_t _order_token_type, uint32_t _getSize, std::string const& _cursor) {
+    std::vector<exchange_order> _v = m_exdb.get_order_by_type(
+            (order_type) _order_type, (order_token_type) _order_token_type, _getSize, orderCursorFromString(_cursor));
+    return orderPageJson(_v, _getSize);
+}
+
+Json::Value State::pendingOrderPoolForAddrPage(Address _a, uint32_t _getSize, std::string const& _cursor) {
+    std::vector<exchange_order> _v = m_exdb.get_order_by_address(_a, _getSize, orderCursorFromString(_cursor));
+    return orderPageJson(_v, _getSize);
+}
+
+Json::Value State::successPendingOrderPage(uint32_t _getSize, std::string const& _cursor) {
+    int64_t _before = _cursor.empty() ? INT64_MAX : std::stoll(_cursor);
+    std::vector<result_order> _v = m_exdb.get_result_orders_by_news(_getSize, _before);
+    Json::Value _page;
+    _page["orders"] = Json::Value(Json::arrayValue);
+    for (auto const& val : _v)
+        _page["orders"].append(resultOrderJson(val));
+    _page["next"] = _v.size() == _getSize && !_v.empty() ? std::to_string(_v.back().id) : std::string();
+    return _page;
+}
+
+Json::Value State::orderPageJson(std::vector<ex::exchange_order> const& _v, uint32_t _getSize) {
+    Json::Value _page;
+    _page["orders"] = Json::Value(Json::arrayValue);
+    for (auto const& val : _v)
+        _page["orders"].append(exchangeOrderJson(val));
+    _page["next"] = _v.size() == _getSize && !_v.empty() ? orderCursorToString(_v.back()) : std::string();
+    return _page;
+}
+
 std::tuple<std::string, std::string, std::string>
 State::enumToString(ex::order_type type, ex::order_token_type token_type, ex::order_buy_type buy_type) {
     std::string _type, _token_type, _buy_type;
@@ -1056,19 +1186,24 @@ void State::rollback(size_t _savepoint) {
                 break;
             case Change::Touch:
                 account.untouch();
-                m_unchangedCacheEntries.emplace_back(change.address);
+                if (!isPinnedAccount(change.address))
+                    m_unchangedCacheEntries.insert(change.address, approximateAccountSize(account));
                 break;
             case Change::Ballot:
                 account.addBallot(0 - change.value);
                 break;
             case Change::Poll:
+            {
                 account.addPoll(0 - change.value);
+                notePollChanged(change.address);
                 break;
+            }
             case Change::Vote:
-                account.addVote(change.vote);
+                account.addVote(change.vote, m_db);
                 break;
             case Change::SysVoteData:
-                account.manageSysVote(change.sysVotedate.first, !change.sysVotedate.second, 0);
+                account.manageSysVote(change.sysVotedate.first, !change.sysVotedate.second, 0, m_db);
+                noteElectorChanged(change.address, change.sysVotedate.first, !change.sysVotedate.second);
                 break;
             case Change::FBRC:
                 account.addFBRC(0 - change.value);
@@ -1107,9 +1242,11 @@ std::pair<ExecutionResult, TransactionReceipt> State::execute(EnvInfo const &_en
     switch (_p) {
         case Permanence::Reverted:
             m_cache.clear();
+            m_electorRankingValid = false;
             break;
         case Permanence::Committed:
             removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().EIP158ForkBlock;
+            m_accountVersion = _sealEngine.chainParams().accountVersionForBlockNumber(_envInfo.number());
             commit(removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts :
                    State::CommitBehaviour::KeepEmptyAccounts);
             break;
@@ -1163,6 +1300,7 @@ u256 dev::brc::State::poll(Address const &_addr) const {
 void dev::brc::State::addPoll(Address const &_addr, u256 const &_value) {
     if (Account *a = account(_addr)) {
         a->addPoll(_value);
+        notePollChanged(_addr);
     } else
         BOOST_THROW_EXCEPTION(InvalidAddressAddr() << errinfo_interface("State::addPoll()"));
 
@@ -1189,12 +1327,12 @@ Json::Value dev::brc::State::accoutMessage(Address const &_addr) {
 		jv["FBalance"] = toJS(a->FBalance());
 		jv["BRC"] = toJS(a->BRC());
 		jv["FBRC"] = toJS(a->FBRC());
-		jv["vote"] = toJS(a->voteAll());
+		jv["vote"] = toJS(a->voteAll(m_db));
 		jv["ballot"] = toJS(a->ballot());
         jv["poll"] = toJS(a->poll());
 		jv["nonce"] = toJS(a->nonce());
         Json::Value _array;
-        for (auto val : a->voteData()) {
+        for (auto val : a->voteData(m_db)) {
             Json::Value _v;
             _v["Address"] = toJS(val.first);
             _v["vote_num"] = toJS(val.second);
@@ -1202,9 +1340,10 @@ Json::Value dev::brc::State::accoutMessage(Address const &_addr) {
         }
         jv["vote"] = _array;
 		Json::Value _rewardArray;
-		if (a->blockReward().size() > 0)
+		auto const blockReward = a->blockReward(m_db);
+		if (blockReward.size() > 0)
 		{
-			for (auto it : a->blockReward())
+			for (auto it : blockReward)
 			{
 				Json::Value _vReward;
 				_vReward["blockNum"] = toJS(it.first);
@@ -1222,10 +1361,9 @@ Json::Value dev::brc::State::votedMessage(Address const& _addr) const
 	Json::Value jv;
 	if(auto a = account(_addr))
 	{
-		std::unordered_map<Address, u256> const& _data = a->voteData();
 		Json::Value _arry;
 		int _num = 0;
-		for(auto val : a->voteData())
+		for(auto val : a->voteData(m_db))
 		{
 			Json::Value _v;
 			_v["address"] = toJS(val.first);
@@ -1334,7 +1472,7 @@ u256 dev::brc::State::transactionForCookie(uint8_t _type)
 dev::u256 dev::brc::State::voteAll(Address const& _id) const
 {
     if (auto a = account(_id))
-        return a->voteAll();
+        return a->voteAll(m_db);
     else
         return 0;
 }
@@ -1342,12 +1480,19 @@ dev::u256 dev::brc::State::voteAll(Address const& _id) const
 
 dev::u256 dev::brc::State::voteAdress(Address const &_id, Address const &_recivedAddr) const {
     if (auto a = account(_id))
-        return a->vote(_recivedAddr);
+        return a->vote(_recivedAddr, m_db);
     else
         return 0;
 }
 
 
+bool dev::brc::State::hasVote(Address const &_id, Address const &_recivedAddr) const {
+    if (auto a = account(_id))
+        return a->hasVote(_recivedAddr, m_db);
+    return false;
+}
+
+
 void dev::brc::State::addVote(Address const &_id, Address const &_recivedAddr, u256 _value) {
     //此为投票接口  没有投票人地址失败   投票人票数不足 失败
     Account *a = account(_id);
@@ -1360,15 +1505,17 @@ void dev::brc::State::addVote(Address const &_id, Address const &_recivedAddr, u
         a->addBallot(0 - _value);
         //加票
         rec_a->addPoll(_value);
+        notePollChanged(_recivedAddr);
         //添加记录
-        a->addVote(std::make_pair(_recivedAddr, _value));
+        a->addVote(std::make_pair(_recivedAddr, _value), m_db);
     } else
         BOOST_THROW_EXCEPTION(InvalidAddressAddr() << errinfo_interface("State::addvote()"));
 
     if (_value) {
         m_changeLog.emplace_back(_id, std::make_pair(_recivedAddr, _value));
         m_changeLog.emplace_back(Change::Ballot, _id, 0 - _value);
-        m_changeLog.emplace_back(Change::Poll, _id, _value);
+        // the voter's poll was undone before the elector ranking fork.
+        m_changeLog.emplace_back(Change::Poll, m_electorRankingFork ? _recivedAddr : _id, _value);
     }
 }
 
@@ -1379,27 +1526,28 @@ void dev::brc::State::subVote(Address const &_id, Address const &_recivedAddr, u
     Account *a = account(_id);
     if (a && rec_a) {
         // 验证投票将记录
-        if (a->vote(_recivedAddr) < _value)
+        if (a->vote(_recivedAddr, m_db) < _value)
             BOOST_THROW_EXCEPTION(NotEnoughVoteLog() << errinfo_interface("State::subVote()"));
-        a->addVote(std::make_pair(_recivedAddr, 0 - _value));
+        a->addVote(std::make_pair(_recivedAddr, 0 - _value), m_db);
         a->addBallot(_value);
         if (rec_a->poll() < _value)
             _value = rec_a->poll();
         rec_a->addPoll(0 - _value);
+        notePollChanged(_recivedAddr);
     } else
         BOOST_THROW_EXCEPTION(InvalidAddressAddr() << errinfo_interface("State::subVote()"));
 
     if (_value) {
         m_changeLog.emplace_back(_id, std::make_pair(_recivedAddr, 0 - _value));
         m_changeLog.emplace_back(Change::Ballot, _id, _value);
-        m_changeLog.emplace_back(Change::Poll, _id, 0 - _value);
+        m_changeLog.emplace_back(Change::Poll, m_electorRankingFork ? _recivedAddr : _id, 0 - _value);
     }
 }
 
 
 std::unordered_map<dev::Address, dev::u256> dev::brc::State::voteDate(Address const &_id) const {
     if (auto a = account(_id))
-        return a->voteData();
+        return a->voteData(m_db);
     else {
         return std::unordered_map<Address, u256>();
     }
@@ -1415,8 +1563,9 @@ void dev::brc::State::addSysVoteDate(Address const &_sysAddress, Address const &
     }
     if (!a)
         BOOST_THROW_EXCEPTION(InvalidAddressAddr() << errinfo_interface("State::addSysVoteDate()"));
-    sysAddr->manageSysVote(_id, true, 0);
-    m_changeLog.emplace_back(_sysAddress, std::make_pair(_id, true));
+    sysAddr->manageSysVote(_id, true, 0, m_db);
+    noteElectorChanged(_sysAddress, _id, true);
+    m_changeLog.emplace_back(_sysAddress, std::make_pair(_id, true), m_electorRankingFork ? Change::SysVoteData : Change::Vote);
 }
 
 
@@ -1427,8 +1576,59 @@ void dev::brc::State::subSysVoteDate(Address const &_sysAddress, Address const &
         BOOST_THROW_EXCEPTION(InvalidSysAddress() << errinfo_interface("State::subSysVoteDate()"));
     if (!a)
         BOOST_THROW_EXCEPTION(InvalidAddressAddr() << errinfo_interface("State::subSysVoteDate()"));
-    sysAddr->manageSysVote(_id, false, 0);
-    m_changeLog.emplace_back(_sysAddress, std::make_pair(_id, false));
+    sysAddr->manageSysVote(_id, false, 0, m_db);
+    noteElectorChanged(_sysAddress, _id, false);
+    m_changeLog.emplace_back(_sysAddress, std::make_pair(_id, false), m_electorRankingFork ? Change::SysVoteData : Change::Vote);
+}
+
+
+std::vector<Address> dev::brc::State::sortedElectors(size_t _num, std::vector<Address> const &_ignore) const {
+    if (!m_electorRankingValid) {
+        // one full scan, the ranking is maintained incrementally from here on.
+        m_electorRanking.clear();
+        m_electorPolls.clear();
+        for (auto const &i : voteDate(SysElectorAddress)) {
+            u256 const p = poll(i.first);
+            m_electorRanking.emplace(p, i.first);
+            m_electorPolls[i.first] = p;
+        }
+        m_electorRankingValid = true;
+    }
+    std::vector<Address> ret;
+    for (auto const &i : m_electorRanking) {
+        if (ret.size() >= _num)
+            break;
+        if (std::find(_ignore.begin(), _ignore.end(), i.second) == _ignore.end())
+            ret.push_back(i.second);
+    }
+    return ret;
+}
+
+void dev::brc::State::notePollChanged(Address const &_id) const {
+    if (!m_electorRankingValid)
+        return;
+    auto it = m_electorPolls.find(_id);
+    if (it == m_electorPolls.end())
+        return;
+    u256 const p = poll(_id);
+    m_electorRanking.erase({it->second, _id});
+    m_electorRanking.emplace(p, _id);
+    it->second = p;
+}
+
+void dev::brc::State::noteElectorChanged(Address const &_sysAddress, Address const &_id, bool _isElector) const {
+    if (!m_electorRankingValid || _sysAddress != SysElectorAddress)
+        return;
+    auto it = m_electorPolls.find(_id);
+    if (it != m_electorPolls.end()) {
+        m_electorRanking.erase({it->second, _id});
+        m_electorPolls.erase(it);
+    }
+    if (_isElector) {
+        u256 const p = poll(_id);
+        m_electorRanking.emplace(p, _id);
+        m_electorPolls[_id] = p;
+    }
 }
 
 
@@ -1542,25 +1742,33 @@ State &dev::brc::createIntermediateState(
 }
 
 template<class DB>
-AddressHash dev::brc::commit(AccountMap const &_cache, SecureTrieDB<Address, DB> &_state) {
+AddressHash dev::brc::commit(AccountMap const &_cache, SecureTrieDB<Address, DB> &_state, unsigned _accountVersion) {
     AddressHash ret;
+    // the account and storage keys are hashed together when written, an empty value removes.
+    std::vector<std::pair<Address, bytes>> accountWrites;
     for (auto const &i : _cache)
         if (i.second.isDirty()) {
             if (!i.second.isAlive())
-                _state.remove(i.first);
+                accountWrites.emplace_back(i.first, bytes());
             else {
-                RLPStream s(12);
+                unsigned version = _accountVersion;
+                if (i.second.hasBlockRewardTrie())
+                    version = c_blockRewardTrieVersion;
+                else if (i.second.hasVoteTrie())
+                    version = std::max(version, c_voteTrieVersion);
+                bool const voteTrie = version >= c_voteTrieVersion;
+                RLPStream s(voteTrie ? 13 : 12);
                 s << i.second.nonce() << i.second.balance();
                 if (i.second.storageOverlay().empty()) {
                     assert(i.second.baseRoot());
                     s.append(i.second.baseRoot());
                 } else {
                     SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
+                    std::vector<std::pair<h256, bytes>> storageWrites;
+                    storageWrites.reserve(i.second.storageOverlay().size());
                     for (auto const &j : i.second.storageOverlay())
-                        if (j.second)
-                            storageDB.insert(j.first, rlp(j.second));
-                        else
-                            storageDB.remove(j.first);
+                        storageWrites.emplace_back(j.first, j.second ? rlp(j.second) : bytes());
+                    storageDB.apply(storageWrites);
                     assert(storageDB.root());
                     s.append(storageDB.root());
                 }
@@ -1575,42 +1783,81 @@ AddressHash dev::brc::commit(AccountMap const &_cache, SecureTrieDB<Address, DB>
                     s << i.second.codeHash();
                 s << i.second.ballot();
                 s << i.second.poll();
-                {
+                if (!voteTrie) {
                     RLPStream _s;
-                    size_t num = i.second.voteData().size();
+                    size_t num = i.second.legacyVoteData().size();
                     _s.appendList(num + 1);
                     _s << num;
-                    for (auto val : i.second.voteData()) {
+                    for (auto val : i.second.legacyVoteData()) {
                         _s.append<Address, u256>(std::make_pair(val.first, val.second));
                     }
                     s << _s.out();
+                } else if (!i.second.hasVoteTrie()) {
+                    // first write after the fork, move the legacy records to a new trie.
+                    VoteTrieDB<DB> voteDB(_state.db(), EmptyTrie);
+                    for (auto const &j : i.second.legacyVoteData())
+                        voteDB.insert(j.first, rlp(j.second));
+                    s << voteDB.root();
+                } else if (i.second.voteOverlay().empty())
+                    s << i.second.voteRoot();
+                else {
+                    // only the changed records are written, the trie keeps the rest.
+                    VoteTrieDB<DB> voteDB(_state.db(), i.second.voteRoot());
+                    for (auto const &j : i.second.voteOverlay())
+                        if (j.second)
+                            voteDB.insert(j.first, rlp(*j.second));
+                        else
+                            voteDB.remove(j.first);
+                    s << voteDB.root();
                 }
                 s << i.second.BRC();
                 s << i.second.FBRC();
                 s << i.second.FBalance();
                 s << i.second.assetInjectStatus();
+				if (version < c_blockRewardTrieVersion)
 				{
 					RLPStream _rlp;
-					size_t _num = i.second.blockReward().size();
+					size_t _num = i.second.legacyBlockReward().size();
 					_rlp.appendList(_num + 1);
 					_rlp << _num;
-					for (auto it : i.second.blockReward())
+					for (auto it : i.second.legacyBlockReward())
 					{
 						_rlp.append<u256, u256>(std::make_pair(it.first, it.second));
 					}
 					s << _rlp.out();
 				}
+                else if (!i.second.hasBlockRewardTrie()) {
+                    // first write after the fork, move the legacy history to a new trie.
+                    BlockRewardTrieDB<DB> rewardDB(_state.db(), EmptyTrie);
+                    for (auto const &j : i.second.legacyBlockReward())
+                        rewardDB.insert(h256(j.first), rlp(j.second));
+                    s << rewardDB.root();
+                } else if (i.second.blockRewardDelta().empty())
+                    s << i.second.blockRewardRoot();
+                else {
+                    // the rewards of the current block are added to the stored value.
+                    BlockRewardTrieDB<DB> rewardDB(_state.db(), i.second.blockRewardRoot());
+                    for (auto const &j : i.second.blockRewardDelta()) {
+                        std::string const stored = rewardDB.at(h256(j.first));
+                        u256 const value = stored.empty() ? j.second : RLP(stored).toInt<u256>() + j.second;
+                        rewardDB.insert(h256(j.first), rlp(value));
+                    }
+                    s << rewardDB.root();
+                }
+                if (voteTrie)
+                    s << version;
 
-                _state.insert(i.first, &s.out());
+                accountWrites.emplace_back(i.first, s.out());
             }
             ret.insert(i.first);
         }
+    _state.apply(accountWrites);
     return ret;
 }
 
 
 template AddressHash dev::brc::commit<OverlayDB>(
-        AccountMap const &_cache, SecureTrieDB<Address, OverlayDB> &_state);
+        AccountMap const &_cache, SecureTrieDB<Address, OverlayDB> &_state, unsigned _accountVersion);
 
 template AddressHash dev::brc::commit<StateCacheDB>(
-        AccountMap const &_cache, SecureTrieDB<Address, StateCacheDB> &_state);
+        AccountMap const &_cache, SecureTrieDB<Address, StateCacheDB> &_state, unsigned _accountVersion);
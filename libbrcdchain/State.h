@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Account.h"
+#include "AccountCache.h"
 #include "GasPricer.h"
 #include "SecureTrieDB.h"
 #include "Transaction.h"
@@ -148,7 +149,8 @@ struct Change
     {
         vote = std::make_pair(_vote.first, _vote.second);
     }
-    Change(Address const& _addr, std::pair<Address, bool> _sysVote) : kind(Vote), address(_addr)
+    /// Logged as a Vote before the elector ranking fork.
+    Change(Address const& _addr, std::pair<Address, bool> _sysVote, Kind _kind = SysVoteData) : kind(_kind), address(_addr)
     {
         sysVotedate = std::make_pair(_sysVote.first, _sysVote.second);
     }
@@ -222,6 +224,8 @@ public:
     OverlayDB& db() { return m_db; }
 
     static ex::exchange_plugin openExdb(boost::filesystem::path const& _path, WithExisting _we = WithExisting::Trust);
+    /// The segment sizing and write-back of the exchange database openExdb() opens.
+    static ex::segment_options& exdbOptions() { return s_exdbOptions; }
     ex::exchange_plugin const& exdb() const { return m_exdb; }
     ex::exchange_plugin& exdb() { return m_exdb; }
 
@@ -319,8 +323,18 @@ public:
 
 	Json::Value successPendingOrderMsg(uint32_t _getSize);
 
+	/// One page of the *Msg queries as {"orders": [...], "next": token}. The token continues after
+	/// the last order and is empty on the last page; an empty _cursor starts from the top.
+	Json::Value pendingOrderPoolPage(uint8_t _order_type, uint8_t _order_token_type, uint32_t _getSize, std::string const& _cursor);
+	Json::Value pendingOrderPoolForAddrPage(Address _a, uint32_t _getSize, std::string const& _cursor);
+	Json::Value successPendingOrderPage(uint32_t _getSize, std::string const& _cursor);
+
 	std::tuple<std::string, std::string, std::string> enumToString(ex::order_type _type, ex::order_token_type _token_type, ex::order_buy_type _buy_type);
 
+	Json::Value exchangeOrderJson(ex::exchange_order const& _o);
+	Json::Value resultOrderJson(ex::result_order const& _o);
+	Json::Value orderPageJson(std::vector<ex::exchange_order> const& _v, uint32_t _getSize);
+
 
 
     //投票数相关接口 自己拥有可以操作的票数
@@ -366,6 +380,8 @@ private:
     u256 voteAll(Address const& _id) const;
     //获取给指定Address的投票数
     u256 voteAdress(Address const& _id, Address const& _recivedAddr) const;
+    //是否有给指定Address的投票记录 票数可以为0
+    bool hasVote(Address const& _id, Address const& _recivedAddr) const;
     //投票
     void addVote(Address const& _id, Address const& _recivedAddr, u256 _value);
     //撤销投票
@@ -375,6 +391,12 @@ private:
     //竞选人，验证人管理
     void addSysVoteDate(Address const& _sysAddress, Address const& _id);
     void subSysVoteDate(Address const& _sysAddress, Address const& _id);
+    //按得票数排序的竞选人, 跳过 _ignore 中的地址, 最多 _num 个
+    std::vector<Address> sortedElectors(size_t _num, std::vector<Address> const& _ignore) const;
+    /// Moves _id in the elector ranking after its poll changed.
+    void notePollChanged(Address const& _id) const;
+    /// Adds/removes _id to/from the elector ranking after the elector set changed.
+    void noteElectorChanged(Address const& _sysAddress, Address const& _id, bool _isElector) const;
 
 public:
     void transferBallotBuy(Address const& _from, Address const& _to, u256 const& _value);
@@ -463,6 +485,14 @@ public:
     /// Resets any uncommitted changes to the cache.
     void setRoot(h256 const& _root);
 
+    /// The account RLP version written on commit, follows the account encoding forks.
+    void setAccountVersion(unsigned _version) { m_accountVersion = _version; }
+    unsigned accountVersion() const { return m_accountVersion; }
+
+    /// Whether the elector ranking fork is in force, see ChainOperationParams::electorRankingForkBlock.
+    void setElectorRankingFork(bool _on) { if (_on != m_electorRankingFork) m_electorRankingValid = false; m_electorRankingFork = _on; }
+    bool electorRankingFork() const { return m_electorRankingFork; }
+
     /// Get the account start nonce. May be required.
     u256 const& accountStartNonce() const { return m_accountStartNonce; }
     u256 const& requireAccountStartNonce() const;
@@ -477,6 +507,17 @@ public:
 
     ChangeLog const& changeLog() const { return m_changeLog; }
 
+    /// Sets the approximate memory, in bytes, the unchanged accounts of each State may take
+    /// before they are evicted. The system DPoS accounts are never evicted.
+    static void setAccountCacheBudget(size_t _bytes) { s_accountCacheBudget = _bytes; }
+    static size_t accountCacheBudget() { return s_accountCacheBudget; }
+
+    /// Sets the approximate memory, in bytes, of the decoded accounts shared by all States.
+    static void setSharedAccountCacheBudget(size_t _bytes) { SharedAccountCache::instance().setBudget(_bytes); }
+
+    /// @returns the hit, miss and eviction counts of the account cache of this State.
+    AccountCacheIndex::Stats const& accountCacheStats() const { return m_unchangedCacheEntries.stats(); }
+
 private:
     /// Turns all "touched" empty accounts into non-alive accounts.
     void removeEmptyAccounts();
@@ -489,7 +530,10 @@ private:
     /// The pointer is valid until the next access to the state or account.
     Account* account(Address const& _addr);
 
-    /// Purges non-modified entries in m_cache if it grows too large.
+    /// Copies the changed entries of the cache of @a _s, the rest is reloaded on demand.
+    void copyChangedAccounts(State const& _s);
+
+    /// Purges non-modified entries in m_cache while they take more than the account cache budget.
     void clearCacheIfTooLarge() const;
 
     void createAccount(Address const& _address, Account const&& _account);
@@ -509,7 +553,7 @@ private:
     /// been changed.
     mutable std::unordered_map<Address, Account> m_cache;
     /// Tracks entries in m_cache that can potentially be purged if it grows too large.
-    mutable std::vector<Address> m_unchangedCacheEntries;
+    mutable AccountCacheIndex m_unchangedCacheEntries;
     /// Tracks addresses that are known to not exist.
     mutable std::set<Address> m_nonExistingAccountsCache;
     /// Tracks all addresses touched so far.
@@ -517,10 +561,26 @@ private:
 
     u256 m_accountStartNonce;
 
+    /// The lowest account RLP version commit() writes.
+    unsigned m_accountVersion = 0;
+
+    /// The elector set ranked by poll, highest first, ties by address. Built on the first
+    /// sortedElectors() and kept in step by the vote interfaces and rollback(), so it outlives
+    /// commit(). Dropped whenever the cache is discarded.
+    using ElectorRank = std::pair<u256, Address>;
+    mutable std::set<ElectorRank, std::greater<ElectorRank>> m_electorRanking;
+    /// The poll each ranked elector is filed under.
+    mutable std::unordered_map<Address, u256> m_electorPolls;
+    mutable bool m_electorRankingValid = false;
+    bool m_electorRankingFork = false;
+
     friend std::ostream& operator<<(std::ostream& _out, State const& _s);
     ChangeLog m_changeLog;
 
     mutable Logger m_loggerError{createLogger(VerbosityError, "State")};
+
+    static size_t s_accountCacheBudget;
+    static ex::segment_options s_exdbOptions;
 };
 
 std::ostream& operator<<(std::ostream& _out, State const& _s);
@@ -528,8 +588,10 @@ std::ostream& operator<<(std::ostream& _out, State const& _s);
 State& createIntermediateState(
     State& o_s, Block const& _block, unsigned _txIndex, BlockChain const& _bc);
 
+/// @param _accountVersion the lowest account RLP version to write, an account is never written below the
+/// version it was loaded with.
 template <class DB>
-AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state);
+AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, unsigned _accountVersion = 0);
 
 }  // namespace brc
 }  // namespace dev
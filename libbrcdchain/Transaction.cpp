@@ -120,3 +120,46 @@ Transaction::Transaction(bytesConstRef _rlpData, CheckTransaction _checkSig)
     m_type = VoteMassage;
     m_value = _flag;
 }*/
+
+std::vector<transationTool::decoded_operation> transationTool::decode_operations(bytesConstRef _data)
+{
+    std::vector<decoded_operation> ret;
+    RLP const ops(_data);
+    if (!ops.isList())
+        return ret;
+    ret.resize(ops.itemCount());
+    size_t i = 0;
+    for (auto const& item : ops)
+    {
+        decoded_operation& d = ret[i++];
+        RLP op;
+        try
+        {
+            op = RLP(item.toBytesConstRef());
+            d.type = (op_type)op[0].toInt<uint8_t>();
+        }
+        catch (boost::exception const&)
+        {
+            d.type = null;
+            continue;
+        }
+        switch (d.type)
+        {
+        case vote:
+            d.op = vote_operation(op);
+            break;
+        case brcTranscation:
+            d.op = transcation_operation(op);
+            break;
+        case pendingOrder:
+            d.op = pendingorder_opearaion(op);
+            break;
+        case cancelPendingOrder:
+            d.op = cancelPendingorder_operation(op);
+            break;
+        default:
+            break;
+        }
+    }
+    return ret;
+}
@@ -8,6 +8,7 @@
 #include <libdevcore/RLP.h>
 #include <libdevcore/SHA3.h>
 #include <boost/preprocessor/seq.hpp>
+#include <boost/variant.hpp>
 
 //#include "brc/types.hpp"
 #include <brc/types.hpp>
@@ -61,9 +62,9 @@ namespace transationTool
 #define UNSERIALIZE_MACRO(r, data, i, elem) \
     elem = data[i].convert<decltype(elem)>(RLP::LaissezFaire);
 #define OPERATION_UNSERIALIZE(CALSS, MEMBERS)                    \
-    CALSS(const bytes& Data)                                     \
+    CALSS(const bytes& Data) : CALSS(RLP(Data)) {}               \
+    explicit CALSS(const RLP& rlp)                               \
     {                                                            \
-        RLP rlp(Data);                                           \
         BOOST_PP_SEQ_FOR_EACH_I(UNSERIALIZE_MACRO, rlp, MEMBERS) \
     }
 
@@ -167,8 +168,8 @@ struct pendingorder_opearaion : public operation
     {}
 
 //	OPERATION_UNSERIALIZE(pendingorder_opearaion, (m_type)(m_from)(m_Pendingorder_type)(m_Pendingorder_Token_type)(m_Pendingorder_buy_type)(m_Pendingorder_num)(m_Pendingorder_price))
-	pendingorder_opearaion(const bytes& Data){
-        RLP rlp(Data);
+	pendingorder_opearaion(const bytes& Data) : pendingorder_opearaion(RLP(Data)) {}
+	explicit pendingorder_opearaion(const RLP& rlp){
         m_type = rlp[0].convert<uint8_t>(RLP::LaissezFaire);
         m_from = rlp[1].convert<Address>(RLP::LaissezFaire);
         m_Pendingorder_type = (ex::order_type)rlp[2].convert<uint8_t>(RLP::LaissezFaire);
@@ -218,6 +219,24 @@ struct contract_operation : public operation
 	OPERATION_SERIALIZE((m_date))
 };
 
+/// One operation of a BRC transaction, parsed once by decode_operations.
+/// @a op is blank when @a type is not one of the operations below.
+struct decoded_operation
+{
+    op_type type = null;
+    boost::variant<boost::blank, vote_operation, transcation_operation, pendingorder_opearaion,
+        cancelPendingorder_operation>
+        op;
+
+    template <class T>
+    T const& get() const { return boost::get<T>(op); }
+};
+
+/// Decodes the operations of the BRC transaction data @a _data. Every operation is read straight
+/// from its slice of @a _data. As for operation::get_type, an operation whose type can't be read
+/// has type null. @returns nothing if @a _data is not a list.
+std::vector<decoded_operation> decode_operations(bytesConstRef _data);
+
 }  // namespace transationTool
 
 enum class CodeDeposit
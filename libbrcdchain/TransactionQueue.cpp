@@ -2,24 +2,24 @@
 
 #include <libdevcore/Log.h>
 #include <libbrccore/Exceptions.h>
+#include "VerifierPool.h"
 #include "Transaction.h"
 using namespace std;
 using namespace dev;
 using namespace dev::brc;
 
 const size_t c_maxVerificationQueueSize = 100000;
+/// Most transactions the verifier takes from the verification queue at once.
+const size_t c_maxVerificationBatch = 1024;
 
 TransactionQueue::TransactionQueue(unsigned _limit, unsigned _futureLimit):
-    m_current(PriorityCompare { *this }),
     m_limit(_limit),
     m_futureLimit(_futureLimit)
 {
-    unsigned verifierThreads = std::max(thread::hardware_concurrency(), 3U) - 2U;
-    for (unsigned i = 0; i < verifierThreads; ++i)
-        m_verifiers.emplace_back([=](){
-            setThreadName("txcheck" + toString(i));
-            this->verifierBody();
-        });
+    m_verifier = thread([=](){
+        setThreadName("txcheck");
+        this->verifierBody();
+    });
 }
 
 TransactionQueue::~TransactionQueue()
@@ -27,8 +27,7 @@ TransactionQueue::~TransactionQueue()
     DEV_GUARDED(x_queue)
         m_aborting = true;
     m_queueReady.notify_all();
-    for (auto& i: m_verifiers)
-        i.join();
+    m_verifier.join();
 }
 
 ImportResult TransactionQueue::import(bytesConstRef _transactionRLP, IfDropped _ik)
@@ -44,8 +43,9 @@ ImportResult TransactionQueue::import(bytesConstRef _transactionRLP, IfDropped _
     }
 }
 
-ImportResult TransactionQueue::check_WITH_LOCK(h256 const& _h, IfDropped _ik)
+ImportResult TransactionQueue::check_WITH_LOCK(h256 const& _h, IfDropped _ik) const
 {
+    ReadGuard l(x_index);
     if (m_known.count(_h))
         return ImportResult::AlreadyKnown;
 
@@ -59,28 +59,49 @@ ImportResult TransactionQueue::import(Transaction const& _transaction, IfDropped
 {
     if (_transaction.hasZeroSignature())
         return ImportResult::ZeroSignature;
+    // Operations Executive::initialize would refuse, it decodes them the same way.
+    if (_transaction.isVoteTranction())
+    {
+        auto const ops = transationTool::decode_operations(&_transaction.data());
+        if (ops.empty() || std::any_of(ops.begin(), ops.end(), [](transationTool::decoded_operation const& _op){
+                return _op.op.which() == 0;
+            }))
+            return ImportResult::Malformed;
+    }
+    // Perform EC recovery before taking the lock, a no-op when VerifierPool did it already.
+    if (!_transaction.safeSender())
+        return ImportResult::Malformed;
     // Check if we already know this transaction.
     h256 h = _transaction.sha3(WithSignature);
 
     ImportResult ret;
     {
-        UpgradableGuard l(m_lock);
+        Bucket& b = bucket(_transaction.from());
+        WriteGuard l(b.lock);
         auto ir = check_WITH_LOCK(h, _ik);
         if (ir != ImportResult::Success)
             return ir;
 
-        {
-            _transaction.safeSender();  // Perform EC recovery outside of the write lock
-            UpgradeGuard ul(l);
-            ret = manageImport_WITH_LOCK(h, _transaction);
-        }
+        ret = manageImport_WITH_LOCK(b, h, _transaction);
     }
+    if (ret == ImportResult::Success)
+        trim();
+    return ret;
+}
+
+std::vector<ImportResult> TransactionQueue::import(Transactions const& _transactions, IfDropped _ik)
+{
+    VerifierPool::instance().recover(_transactions);
+    std::vector<ImportResult> ret;
+    ret.reserve(_transactions.size());
+    for (auto const& t: _transactions)
+        ret.push_back(import(t, _ik));
     return ret;
 }
 
 Transactions TransactionQueue::topTransactions(unsigned _limit, h256Hash const& _avoid) const
 {
-    ReadGuard l(m_lock);
+    ReadGuard l(x_index);
     Transactions ret;
 	if(_limit == 0)
 		_limit = m_current.size();
@@ -92,19 +113,19 @@ Transactions TransactionQueue::topTransactions(unsigned _limit, h256Hash const&
 
 h256Hash TransactionQueue::knownTransactions() const
 {
-    ReadGuard l(m_lock);
+    ReadGuard l(x_index);
     return m_known;
 }
 
-ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction)
+ImportResult TransactionQueue::manageImport_WITH_LOCK(Bucket& _b, h256 const& _h, Transaction const& _transaction)
 {
     try
     {
         assert(_h == _transaction.sha3());
         // Remove any prior transaction with the same nonce but a lower gas price.
         // Bomb out if there's a prior transaction with higher gas price.
-        auto cs = m_currentByAddressAndNonce.find(_transaction.from());
-        if (cs != m_currentByAddressAndNonce.end())
+        auto cs = _b.current.find(_transaction.from());
+        if (cs != _b.current.end())
         {
             auto t = cs->second.find(_transaction.nonce());
             if (t != cs->second.end())
@@ -114,13 +135,13 @@ ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transactio
                 else
                 {
                     h256 dropped = (*t->second).transaction.sha3();
-                    remove_WITH_LOCK(dropped);
+                    remove_WITH_LOCK(_b, dropped);
                     m_onReplaced(dropped);
                 }
             }
         }
-        auto fs = m_future.find(_transaction.from());
-        if (fs != m_future.end())
+        auto fs = _b.future.find(_transaction.from());
+        if (fs != _b.future.end())
         {
             auto t = fs->second.find(_transaction.nonce());
             if (t != fs->second.end())
@@ -132,20 +153,14 @@ ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transactio
                     fs->second.erase(t);
                     --m_futureSize;
                     if (fs->second.empty())
-                        m_future.erase(fs);
+                        _b.future.erase(fs);
                 }
             }
         }
         // If valid, append to transactions.
-        insertCurrent_WITH_LOCK(make_pair(_h, _transaction));
+        insertCurrent_WITH_LOCK(_b, make_pair(_h, _transaction));
         LOG(m_loggerDetail) << "Queued vaguely legit-looking transaction " << _h;
 
-        while (m_current.size() > m_limit)
-        {
-            LOG(m_loggerDetail) << "Dropping out of bounds transaction " << _h;
-            remove_WITH_LOCK(m_current.rbegin()->transaction.sha3());
-        }
-
         m_onReady();
     }
     catch (Exception const& _e)
@@ -162,87 +177,151 @@ ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transactio
     return ImportResult::Success;
 }
 
+void TransactionQueue::trim()
+{
+    while (true)
+    {
+        h256 victim;
+        Address from;
+        {
+            ReadGuard l(x_index);
+            if (m_current.size() <= m_limit)
+                return;
+            Transaction const& t = m_current.rbegin()->transaction;
+            victim = t.sha3();
+            from = t.from();
+        }
+        // It may be gone by the time we hold its bucket, then the next one is looked at.
+        Bucket& b = bucket(from);
+        WriteGuard l(b.lock);
+        LOG(m_loggerDetail) << "Dropping out of bounds transaction " << victim;
+        remove_WITH_LOCK(b, victim);
+    }
+}
+
 u256 TransactionQueue::maxNonce(Address const& _a) const
 {
-    ReadGuard l(m_lock);
-    return maxNonce_WITH_LOCK(_a);
+    Bucket const& b = bucket(_a);
+    ReadGuard l(b.lock);
+    return maxNonce_WITH_LOCK(b, _a);
 }
 
-u256 TransactionQueue::maxNonce_WITH_LOCK(Address const& _a) const
+u256 TransactionQueue::maxNonce_WITH_LOCK(Bucket const& _b, Address const& _a) const
 {
     u256 ret = 0;
-    auto cs = m_currentByAddressAndNonce.find(_a);
-    if (cs != m_currentByAddressAndNonce.end() && !cs->second.empty())
+    auto cs = _b.current.find(_a);
+    if (cs != _b.current.end() && !cs->second.empty())
         ret = cs->second.rbegin()->first + 1;
-    auto fs = m_future.find(_a);
-    if (fs != m_future.end() && !fs->second.empty())
+    auto fs = _b.future.find(_a);
+    if (fs != _b.future.end() && !fs->second.empty())
         ret = std::max(ret, fs->second.rbegin()->first + 1);
     return ret;
 }
 
-void TransactionQueue::insertCurrent_WITH_LOCK(std::pair<h256, Transaction> const& _p)
+void TransactionQueue::insertCurrent_WITH_LOCK(Bucket& _b, std::pair<h256, Transaction> const& _p)
 {
-    
-    if (m_currentByHash.count(_p.first))
-    {
-        cwarn << "Transaction hash" << _p.first << "already in current?!";
-        return;
-    }
+    DEV_READ_GUARDED(x_index)
+        if (m_currentByHash.count(_p.first))
+        {
+            cwarn << "Transaction hash" << _p.first << "already in current?!";
+            return;
+        }
     Transaction const& t = _p.second;
     // Insert into current
-    auto inserted = m_currentByAddressAndNonce[t.from()].insert(std::make_pair(t.nonce(), PriorityQueue::iterator()));
-    PriorityQueue::iterator handle = m_current.emplace(VerifiedTransaction(t));
-    inserted.first->second = handle;
-    m_currentByHash[_p.first] = handle;
+    auto& queue = _b.current[t.from()];
+    bool const lowest = queue.empty() || t.nonce() < queue.begin()->first;
+    auto inserted = queue.insert(std::make_pair(t.nonce(), PriorityQueue::iterator()));
+    u256 const height = t.nonce() - queue.begin()->first;
+    DEV_WRITE_GUARDED(x_index)
+    {
+        PriorityQueue::iterator handle = m_current.emplace(VerifiedTransaction(t, height));
+        inserted.first->second = handle;
+        m_currentByHash[_p.first] = handle;
+        m_known.insert(_p.first);
+        if (lowest)
+            rebase_WITH_LOCK(queue);
+    }
 
     // Move following transactions from future to current
-    makeCurrent_WITH_LOCK(t);
-    m_known.insert(_p.first);
+    makeCurrent_WITH_LOCK(_b, t);
 }
 
-bool TransactionQueue::remove_WITH_LOCK(h256 const& _txHash)
+bool TransactionQueue::remove_WITH_LOCK(Bucket& _b, h256 const& _txHash)
 {
+    WriteGuard l(x_index);
     auto t = m_currentByHash.find(_txHash);
     if (t == m_currentByHash.end())
         return false;
 
     Address from = (*t->second).transaction.from();
-    auto it = m_currentByAddressAndNonce.find(from);
-    assert (it != m_currentByAddressAndNonce.end());
-    it->second.erase((*t->second).transaction.nonce());
+    auto it = _b.current.find(from);
+    assert (it != _b.current.end());
+    u256 const nonce = (*t->second).transaction.nonce();
+    it->second.erase(nonce);
     m_current.erase(t->second);
     m_currentByHash.erase(t);
     if (it->second.empty())
-        m_currentByAddressAndNonce.erase(it);
+        _b.current.erase(it);
+    else if (nonce < it->second.begin()->first)
+        rebase_WITH_LOCK(it->second);
     m_known.erase(_txHash);
     return true;
 }
 
+void TransactionQueue::rebase_WITH_LOCK(std::map<u256, PriorityQueue::iterator>& _queue)
+{
+    // The heights are part of the keys of m_current, so the entries whose height changes are taken
+    // out and put back.
+    u256 const base = _queue.begin()->first;
+    for (auto& n: _queue)
+    {
+        if (n.second->height == n.first - base)
+            continue;
+        VerifiedTransaction& t = const_cast<VerifiedTransaction&>(*n.second); // set has only const iterators. Since we are moving out of container that's fine
+        VerifiedTransaction moved(std::move(t));
+        moved.height = n.first - base;
+        m_current.erase(n.second);
+        n.second = m_current.emplace(std::move(moved));
+        m_currentByHash[(*n.second).transaction.sha3()] = n.second;
+    }
+}
+
 unsigned TransactionQueue::waiting(Address const& _a) const
 {
-    ReadGuard l(m_lock);
+    Bucket const& b = bucket(_a);
+    ReadGuard l(b.lock);
     unsigned ret = 0;
-    auto cs = m_currentByAddressAndNonce.find(_a);
-    if (cs != m_currentByAddressAndNonce.end())
+    auto cs = b.current.find(_a);
+    if (cs != b.current.end())
         ret = cs->second.size();
-    auto fs = m_future.find(_a);
-    if (fs != m_future.end())
+    auto fs = b.future.find(_a);
+    if (fs != b.future.end())
         ret += fs->second.size();
     return ret;
 }
 
 void TransactionQueue::setFuture(h256 const& _txHash)
 {
-    WriteGuard l(m_lock);
+    Address from;
+    DEV_READ_GUARDED(x_index)
+    {
+        auto it = m_currentByHash.find(_txHash);
+        if (it == m_currentByHash.end())
+            return;
+        from = (*it->second).transaction.from();
+    }
+
+    Bucket& b = bucket(from);
+    WriteGuard l(b.lock);
+    WriteGuard il(x_index);
     auto it = m_currentByHash.find(_txHash);
     if (it == m_currentByHash.end())
         return;
 
     VerifiedTransaction const& st = *(it->second);
 
-    Address from = st.transaction.from();
-    auto& queue = m_currentByAddressAndNonce[from];
-    auto& target = m_future[from];
+    auto& queue = b.current[from];
+    auto& target = b.future[from];
     auto cutoff = queue.lower_bound(st.transaction.nonce());
     for (auto m = cutoff; m != queue.end(); ++m)
     {
@@ -254,23 +333,26 @@ void TransactionQueue::setFuture(h256 const& _txHash)
     }
     queue.erase(cutoff, queue.end());
     if (queue.empty())
-        m_currentByAddressAndNonce.erase(from);
+        b.current.erase(from);
 }
 
-void TransactionQueue::makeCurrent_WITH_LOCK(Transaction const& _t)
+void TransactionQueue::makeCurrent_WITH_LOCK(Bucket& _b, Transaction const& _t)
 {
     bool newCurrent = false;
-    auto fs = m_future.find(_t.from());
-    if (fs != m_future.end())
+    auto fs = _b.future.find(_t.from());
+    if (fs != _b.future.end())
     {
         u256 nonce = _t.nonce() + 1;
         auto fb = fs->second.find(nonce);
         if (fb != fs->second.end())
         {
             auto ft = fb;
+            auto& queue = _b.current[_t.from()];
+            WriteGuard l(x_index);
             while (ft != fs->second.end() && ft->second.transaction.nonce() == nonce)
             {
-                auto inserted = m_currentByAddressAndNonce[_t.from()].insert(std::make_pair(ft->second.transaction.nonce(), PriorityQueue::iterator()));
+                auto inserted = queue.insert(std::make_pair(ft->second.transaction.nonce(), PriorityQueue::iterator()));
+                ft->second.height = nonce - queue.begin()->first;
                 PriorityQueue::iterator handle = m_current.emplace(move(ft->second));
                 inserted.first->second = handle;
                 m_currentByHash[(*handle).transaction.sha3()] = handle;
@@ -281,20 +363,20 @@ void TransactionQueue::makeCurrent_WITH_LOCK(Transaction const& _t)
             }
             fs->second.erase(fb, ft);
             if (fs->second.empty())
-                m_future.erase(_t.from());
+                _b.future.erase(_t.from());
         }
     }
 
-    while (m_futureSize > m_futureLimit)
+    while (m_futureSize > m_futureLimit && !_b.future.empty())
     {
         // TODO: priority queue for future transactions
-        // For now just drop random chain end
+        // For now just drop random chain end of this bucket
         --m_futureSize;
         LOG(m_loggerDetail) << "Dropping out of bounds future transaction "
-                            << m_future.begin()->second.rbegin()->second.transaction.sha3();
-        m_future.begin()->second.erase(--m_future.begin()->second.end());
-        if (m_future.begin()->second.empty())
-            m_future.erase(m_future.begin());
+                            << _b.future.begin()->second.rbegin()->second.transaction.sha3();
+        _b.future.begin()->second.erase(--_b.future.begin()->second.end());
+        if (_b.future.begin()->second.empty())
+            _b.future.erase(_b.future.begin());
     }
 
     if (newCurrent)
@@ -303,37 +385,67 @@ void TransactionQueue::makeCurrent_WITH_LOCK(Transaction const& _t)
 
 void TransactionQueue::drop(h256 const& _txHash)
 {
-    UpgradableGuard l(m_lock);
-
-    if (!m_known.count(_txHash))
-        return;
+    Address from;
+    DEV_WRITE_GUARDED(x_index)
+    {
+        if (!m_known.count(_txHash))
+            return;
+
+        m_dropped.insert(_txHash);
+        auto it = m_currentByHash.find(_txHash);
+        if (it == m_currentByHash.end())
+            return;
+        from = (*it->second).transaction.from();
+    }
 
-    UpgradeGuard ul(l);
-    m_dropped.insert(_txHash);
-    remove_WITH_LOCK(_txHash);
+    Bucket& b = bucket(from);
+    WriteGuard l(b.lock);
+    remove_WITH_LOCK(b, _txHash);
 }
 
 void TransactionQueue::dropGood(Transaction const& _t)
 {
-    WriteGuard l(m_lock);
-    makeCurrent_WITH_LOCK(_t);
-    if (!m_known.count(_t.sha3()))
+    Bucket& b = bucket(_t.from());
+    WriteGuard l(b.lock);
+    makeCurrent_WITH_LOCK(b, _t);
+    if (check_WITH_LOCK(_t.sha3(), IfDropped::Retry) != ImportResult::AlreadyKnown)
         return;
-    remove_WITH_LOCK(_t.sha3());
+    remove_WITH_LOCK(b, _t.sha3());
 }
 
 void TransactionQueue::clear()
 {
-    WriteGuard l(m_lock);
+    std::vector<WriteGuard> buckets;
+    buckets.reserve(c_buckets);
+    for (auto& b: m_buckets)
+    {
+        buckets.emplace_back(b.lock);
+        b.current.clear();
+        b.future.clear();
+    }
+    WriteGuard l(x_index);
     m_known.clear();
     m_current.clear();
     m_dropped.clear();
-    m_currentByAddressAndNonce.clear();
     m_currentByHash.clear();
-    m_future.clear();
     m_futureSize = 0;
 }
 
+TransactionQueue::Status TransactionQueue::status() const
+{
+    Status ret;
+    DEV_GUARDED(x_queue)
+        ret.unverified = m_unverified.size();
+    ret.future = 0;
+    for (auto const& b: m_buckets)
+        DEV_READ_GUARDED(b.lock)
+            ret.future += b.future.size();
+    ReadGuard l(x_index);
+    ret.dropped = m_dropped.size();
+    ret.current = m_currentByHash.size();
+    return ret;
+}
+
 void TransactionQueue::enqueue(RLP const& _data, h512 const& _nodeId)
 {
     bool queued = false;
@@ -360,23 +472,54 @@ void TransactionQueue::verifierBody()
 {
     while (!m_aborting)
     {
-        UnverifiedTransaction work;
+        std::vector<UnverifiedTransaction> work;
 
         {
             unique_lock<Mutex> l(x_queue);
             m_queueReady.wait(l, [&](){ return !m_unverified.empty() || m_aborting; });
             if (m_aborting)
                 return;
-            work = move(m_unverified.front());
-            m_unverified.pop_front();
+            size_t const count = std::min(m_unverified.size(), c_maxVerificationBatch);
+            work.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                work.emplace_back(move(m_unverified.front()));
+                m_unverified.pop_front();
+            }
         }
 
+        // Decoded in place on the pool, a transaction that fails to decode is left empty.
+        std::vector<Transaction> decoded(work.size());
+        std::vector<char> good(work.size(), 0);
+        VerifierPool::instance().run(work.size(), [&](size_t i){
+            try
+            {
+                decoded[i] = Transaction(work[i].transaction, CheckTransaction::Cheap); //Signature will be checked later
+                good[i] = 1;
+            }
+            catch (...)
+            {
+                // not reported to onImport.
+                cwarn << "Bad transaction:" << boost::current_exception_diagnostic_information();
+            }
+        });
+
+        Transactions transactions;
+        std::vector<h512> nodeIds;
+        transactions.reserve(work.size());
+        nodeIds.reserve(work.size());
+        for (size_t i = 0; i < work.size(); ++i)
+            if (good[i])
+            {
+                transactions.push_back(move(decoded[i]));
+                nodeIds.push_back(work[i].nodeId);
+            }
+
         try
         {
-            
-            Transaction t(work.transaction, CheckTransaction::Cheap); //Signature will be checked later
-            ImportResult ir = import(t);
-            m_onImport(ir, t.sha3(), work.nodeId);
+            std::vector<ImportResult> const results = import(transactions);
+            for (size_t i = 0; i < transactions.size(); ++i)
+                m_onImport(results[i], transactions[i].sha3(), nodeIds[i]);
         }
         catch (...)
         {
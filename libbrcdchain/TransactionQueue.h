@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <functional>
 #include <condition_variable>
 #include <thread>
@@ -18,6 +19,10 @@ namespace brc
 /**
  * @brief A queue of Transactions, each stored as RLP.
  * Maintains a transaction queue sorted by nonce diff and gas price.
+ * The transactions of each sender live in one of c_buckets buckets, each with its own lock, so
+ * imports from different senders run in parallel. The price-ordered index has a lock of its own
+ * that is only held for index updates and for topTransactions.
+ * Lock order: bucket, then index. Only clear() holds more than one bucket, in ascending order.
  * @threadsafe
  */
 class TransactionQueue
@@ -48,6 +53,12 @@ public:
     /// @returns Import result code.
     ImportResult import(Transaction const& _tx, IfDropped _ik = IfDropped::Ignore);
 
+    /// Verify and add transactions to the queue synchronously. The senders are recovered in parallel first.
+    /// @param _txs Trasnactions data.
+    /// @param _ik Set to Retry to force re-addinga transactions that were previously dropped.
+    /// @returns Import result code of each transaction.
+    std::vector<ImportResult> import(Transactions const& _txs, IfDropped _ik = IfDropped::Ignore);
+
     /// Remove transaction from the queue
     /// @param _txHash Trasnaction hash
     void drop(h256 const& _txHash);
@@ -86,7 +97,7 @@ public:
         size_t dropped;
     };
     /// @returns the status of the transaction queue.
-    Status status() const { Status ret; DEV_GUARDED(x_queue) { ret.unverified = m_unverified.size(); } ReadGuard l(m_lock); ret.dropped = m_dropped.size(); ret.current = m_currentByHash.size(); ret.future = m_future.size(); return ret; }
+    Status status() const;
 
     /// @returns the transacrtion limits on current/future.
     Limits limits() const { return Limits{m_limit, m_futureLimit}; }
@@ -108,13 +119,14 @@ private:
     /// Verified and imported transaction
     struct VerifiedTransaction
     {
-        VerifiedTransaction(Transaction const& _t): transaction(_t) {}
-        VerifiedTransaction(VerifiedTransaction&& _t): transaction(std::move(_t.transaction)) {}
+        VerifiedTransaction(Transaction const& _t, u256 const& _height = 0): transaction(_t), height(_height) {}
+        VerifiedTransaction(VerifiedTransaction&& _t): transaction(std::move(_t.transaction)), height(_t.height) {}
 
         VerifiedTransaction(VerifiedTransaction const&) = delete;
         VerifiedTransaction& operator=(VerifiedTransaction const&) = delete;
 
         Transaction transaction;  ///< Transaction data
+        u256 height;              ///< Nonce above the lowest current nonce of the sender
     };
 
     /// Transaction pending verification
@@ -141,49 +153,64 @@ private:
 
     struct PriorityCompare
     {
-        TransactionQueue& queue;
         /// Compare transaction by nonce height and gas price.
         bool operator()(VerifiedTransaction const& _first, VerifiedTransaction const& _second) const
         {
-            u256 const& height1 = _first.transaction.nonce() - queue.m_currentByAddressAndNonce[_first.transaction.sender()].begin()->first;
-            u256 const& height2 = _second.transaction.nonce() - queue.m_currentByAddressAndNonce[_second.transaction.sender()].begin()->first;
-            return height1 < height2 || (height1 == height2 && _first.transaction.gasPrice() > _second.transaction.gasPrice());
+            return _first.height < _second.height || (_first.height == _second.height && _first.transaction.gasPrice() > _second.transaction.gasPrice());
         }
     };
 
-    // Use a set with dynamic comparator for minmax priority queue. The comparator takes into account min account nonce. Updating it does not affect the order.
+    // Use a set for minmax priority queue. The height is kept in the entry and updated by rebase_WITH_LOCK when the lowest
+    // current nonce of the sender changes, so the order never depends on the state of other senders and the transactions
+    // of a sender always come in nonce order.
     using PriorityQueue = std::multiset<VerifiedTransaction, PriorityCompare>;
 
+    /// The transactions of the senders that hash to it.
+    struct Bucket
+    {
+        mutable SharedMutex lock;
+        std::unordered_map<Address, std::map<u256, PriorityQueue::iterator>> current;	///< Transactions grouped by account and nonce
+        std::unordered_map<Address, std::map<u256, VerifiedTransaction>> future;		///< Future transactions
+    };
+
+    static unsigned const c_buckets = 16;
+
+    Bucket& bucket(Address const& _a) { return m_buckets[std::hash<Address>()(_a) % c_buckets]; }
+    Bucket const& bucket(Address const& _a) const { return m_buckets[std::hash<Address>()(_a) % c_buckets]; }
+
     ImportResult import(bytesConstRef _tx, IfDropped _ik = IfDropped::Ignore);
-    ImportResult check_WITH_LOCK(h256 const& _h, IfDropped _ik);
-    ImportResult manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction);
 
-    void insertCurrent_WITH_LOCK(std::pair<h256, Transaction> const& _p);
-    void makeCurrent_WITH_LOCK(Transaction const& _t);
-    bool remove_WITH_LOCK(h256 const& _txHash);
-    u256 maxNonce_WITH_LOCK(Address const& _a) const;
+    /// The functions below need the lock of the bucket of the sender and take the index lock themselves.
+    ImportResult check_WITH_LOCK(h256 const& _h, IfDropped _ik) const;
+    ImportResult manageImport_WITH_LOCK(Bucket& _b, h256 const& _h, Transaction const& _transaction);
+    void insertCurrent_WITH_LOCK(Bucket& _b, std::pair<h256, Transaction> const& _p);
+    void makeCurrent_WITH_LOCK(Bucket& _b, Transaction const& _t);
+    bool remove_WITH_LOCK(Bucket& _b, h256 const& _txHash);
+    /// Updates the heights of the current transactions of a sender to its lowest nonce. Needs the index lock too.
+    void rebase_WITH_LOCK(std::map<u256, PriorityQueue::iterator>& _queue);
+    u256 maxNonce_WITH_LOCK(Bucket const& _b, Address const& _a) const;
+
+    /// Drops the lowest priority transactions while there are more than m_limit. Takes no lock on entry.
+    void trim();
     void verifierBody();
 
-    mutable SharedMutex m_lock;  ///< General lock.
-    h256Hash m_known;            ///< Headers of transactions in both sets.
+    std::array<Bucket, c_buckets> m_buckets;
+    std::atomic<unsigned> m_futureSize = {0};									///< Current number of future transactions
 
-    std::unordered_map<h256, std::function<void(ImportResult)>> m_callbacks;	///< Called once.
+    mutable SharedMutex x_index;												///< Guards the members below.
+    h256Hash m_known;            ///< Headers of transactions in both sets.
     h256Hash m_dropped;															///< Transactions that have previously been dropped
-
     PriorityQueue m_current;
     std::unordered_map<h256, PriorityQueue::iterator> m_currentByHash;			///< Transaction hash to set ref
-    std::unordered_map<Address, std::map<u256, PriorityQueue::iterator>> m_currentByAddressAndNonce; ///< Transactions grouped by account and nonce
-    std::unordered_map<Address, std::map<u256, VerifiedTransaction>> m_future;	/// Future transactions
 
     Signal<> m_onReady;															///< Called when a subsequent call to import transactions will return a non-empty container. Be nice and exit fast.
     Signal<ImportResult, h256 const&, h512 const&> m_onImport;					///< Called for each import attempt. Arguments are result, transaction id an node id. Be nice and exit fast.
     Signal<h256 const&> m_onReplaced;											///< Called whan transction is dropped during a call to import() to make room for another transaction.
     unsigned m_limit;															///< Max number of pending transactions
     unsigned m_futureLimit;														///< Max number of future transactions
-    unsigned m_futureSize = 0;													///< Current number of future transactions
 
     std::condition_variable m_queueReady;										///< Signaled when m_unverified has a new entry.
-    std::vector<std::thread> m_verifiers;
+    std::thread m_verifier;														///< Drains m_unverified in batches, decoded and senders recovered on the VerifierPool.
     std::deque<UnverifiedTransaction> m_unverified;  ///< Pending verification queue
     mutable Mutex x_queue;                           ///< Verification queue mutex
     std::atomic<bool> m_aborting = {false};          ///< Exit condition for verifier.
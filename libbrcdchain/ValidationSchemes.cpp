@@ -47,6 +47,9 @@ namespace dev {
             string const c_eWASMForkBlock = "eWASMForkBlock";
             string const c_constantinopleForkBlock = "constantinopleForkBlock";
             string const c_experimentalForkBlock = "experimentalForkBlock";
+            string const c_voteTrieForkBlock = "voteTrieForkBlock";
+            string const c_blockRewardTrieForkBlock = "blockRewardTrieForkBlock";
+            string const c_electorRankingForkBlock = "electorRankingForkBlock";
             string const c_accountStartNonce = "accountStartNonce";
             string const c_maximumExtraDataSize = "maximumExtraDataSize";
             string const c_tieBreakingGas = "tieBreakingGas";
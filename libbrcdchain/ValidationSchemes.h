@@ -46,6 +46,9 @@ extern std::string const c_byzantiumForkBlock;
 extern std::string const c_eWASMForkBlock;
 extern std::string const c_constantinopleForkBlock;
 extern std::string const c_experimentalForkBlock;
+extern std::string const c_voteTrieForkBlock;
+extern std::string const c_blockRewardTrieForkBlock;
+extern std::string const c_electorRankingForkBlock;
 extern std::string const c_accountStartNonce;
 extern std::string const c_maximumExtraDataSize;
 extern std::string const c_tieBreakingGas;
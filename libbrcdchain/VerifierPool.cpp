@@ -0,0 +1,131 @@
+#include "VerifierPool.h"
+
+#include <libdevcore/Log.h>
+#include <algorithm>
+
+using namespace std;
+using namespace dev;
+using namespace dev::brc;
+
+namespace
+{
+/// Smallest range taken by a thread at a time, batches up to this size run on the caller.
+size_t const c_minRange = 4;
+}
+
+VerifierPool::VerifierPool(unsigned _threads)
+{
+    // The caller of run() works too.
+    unsigned workers = max(_threads, 2U) - 1;
+    for (unsigned i = 0; i < workers; ++i)
+        m_workers.emplace_back([=](){
+            setThreadName("verify" + toString(i));
+            this->workerBody();
+        });
+}
+
+VerifierPool::~VerifierPool()
+{
+    DEV_GUARDED(x_batches)
+        m_aborting = true;
+    m_batchReady.notify_all();
+    for (auto& i: m_workers)
+        i.join();
+}
+
+void VerifierPool::run(size_t _count, std::function<void(size_t)> const& _job)
+{
+    if (_count <= c_minRange || m_workers.empty())
+    {
+        for (size_t i = 0; i < _count; ++i)
+            _job(i);
+        return;
+    }
+
+    auto batch = make_shared<Batch>(_count, _job, m_workers.size() + 1);
+    DEV_GUARDED(x_batches)
+        m_batches.push_back(batch);
+    m_batchReady.notify_all();
+
+    work(*batch);
+
+    DEV_GUARDED(x_batches)
+    {
+        auto it = find(m_batches.begin(), m_batches.end(), batch);
+        if (it != m_batches.end())
+            m_batches.erase(it);
+    }
+    unique_lock<Mutex> l(batch->x_done);
+    batch->finished.wait(l, [&](){ return batch->done == _count; });
+    if (batch->error)
+        rethrow_exception(batch->error);
+}
+
+void VerifierPool::recover(Transactions const& _txs)
+{
+    run(_txs.size(), [&](size_t i){ _txs[i].safeSender(); });
+}
+
+void VerifierPool::work(Batch& _batch)
+{
+    size_t const size = _batch.size;
+    while (true)
+    {
+        size_t begin = _batch.next.load();
+        size_t range;
+        do
+        {
+            if (begin >= size)
+                return;
+            range = max(c_minRange, (size - begin) / (2 * _batch.threads));
+        } while (!_batch.next.compare_exchange_weak(begin, begin + range));
+        size_t const end = min(begin + range, size);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            // Everything below a failure still runs, so the lowest failing index is reported.
+            if (i > _batch.firstFailure.load())
+                break;
+            try
+            {
+                _batch.job(i);
+            }
+            catch (...)
+            {
+                Guard l(_batch.x_done);
+                if (i < _batch.firstFailure.load())
+                {
+                    _batch.firstFailure = i;
+                    _batch.error = current_exception();
+                }
+            }
+        }
+
+        Guard l(_batch.x_done);
+        _batch.done += end - begin;
+        if (_batch.done == size)
+            _batch.finished.notify_all();
+    }
+}
+
+void VerifierPool::workerBody()
+{
+    while (true)
+    {
+        shared_ptr<Batch> batch;
+        {
+            unique_lock<Mutex> l(x_batches);
+            m_batchReady.wait(l, [&](){ return !m_batches.empty() || m_aborting; });
+            if (m_aborting)
+                return;
+            batch = m_batches.front();
+        }
+
+        work(*batch);
+
+        // Every range is taken, stop offering the batch.
+        DEV_GUARDED(x_batches)
+            if (!m_batches.empty() && m_batches.front() == batch)
+                m_batches.pop_front();
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Transaction.h"
+#include <libdevcore/Guards.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+namespace brc
+{
+
+/**
+ * @brief Long-lived pool of worker threads for transaction and block verification.
+ * Shared by BlockChain::verifyBlock, and so by the BlockQueue verifiers, and by the
+ * TransactionQueue. A batch is split on the fly: every thread claims the next range of indices
+ * with a size proportional to what is left, so the ranges are large while there is plenty of work
+ * and shrink towards the end, letting idle threads pick up the tail of a slower one.
+ * @threadsafe
+ */
+class VerifierPool
+{
+public:
+    explicit VerifierPool(unsigned _threads = std::thread::hardware_concurrency());
+    ~VerifierPool();
+
+    /// Calls @a _job for every index below @a _count and returns when all calls are done. The
+    /// calling thread takes part, so the pool may be used from its own users' threads. If a call
+    /// throws, the indices above it may be skipped and the exception of the lowest failing index
+    /// is rethrown.
+    void run(size_t _count, std::function<void(size_t)> const& _job);
+
+    /// Recovers the sender of every transaction in @a _txs. A transaction whose signature doesn't
+    /// recover is left with a zero sender.
+    void recover(Transactions const& _txs);
+
+    /// Worker threads, the caller of run() not included.
+    size_t workers() const { return m_workers.size(); }
+
+    static VerifierPool& instance() { static VerifierPool pool; return pool; }
+
+private:
+    struct Batch
+    {
+        Batch(size_t _size, std::function<void(size_t)> const& _job, size_t _threads):
+            job(_job), size(_size), threads(_threads) {}
+
+        /// Only called for ranges claimed before the last one is done, a worker can hold the
+        /// batch after run() returned.
+        std::function<void(size_t)> const& job;
+        size_t const size;
+        size_t const threads;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> firstFailure{std::numeric_limits<size_t>::max()};
+        size_t done = 0;
+        std::exception_ptr error;
+        Mutex x_done;
+        std::condition_variable finished;
+    };
+
+    /// Runs ranges of @a _batch until none is left.
+    static void work(Batch& _batch);
+    void workerBody();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::shared_ptr<Batch>> m_batches;
+    Mutex x_batches;
+    std::condition_variable m_batchReady;
+    bool m_aborting = false;
+};
+
+}
+}
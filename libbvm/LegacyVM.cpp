@@ -1,5 +1,7 @@
 #include "LegacyVM.h"
 
+#include <libbrcd-interpreter/Word256.h>
+
 using namespace std;
 using namespace dev;
 using namespace dev::brc;
@@ -9,16 +11,6 @@ uint64_t LegacyVM::memNeed(u256 _offset, u256 _size)
     return toInt63(_size ? u512(_offset) + _size : u512(0));
 }
 
-template <class S> S divWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) / s512(_b));
-}
-
-template <class S> S modWorkaround(S const& _a, S const& _b)
-{
-    return (S)(s512(_a) % s512(_b));
-}
-
 
 //
 // for decoding destinations of JUMPTO, JUMPV, JUMPSUB and JUMPSUBV
@@ -226,6 +218,34 @@ owning_bytes_ref LegacyVM::exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const&
     return std::move(m_output);
 }
 
+owning_bytes_ref LegacyVM::frameOutput(uint64_t _begin, uint64_t _size)
+{
+    // A pooled instance keeps its memory for the next frame, the output is a copy.
+    if (!vmPoolCapacity())
+        return owning_bytes_ref{std::move(m_mem), _begin, _size};
+    if (!_size)
+        return owning_bytes_ref{};
+    return owning_bytes_ref{bytes(m_mem.data() + _begin, m_mem.data() + _begin + _size), 0, _size};
+}
+
+void LegacyVM::reset()
+{
+    recycleBuffer(m_mem);
+    recycleBuffer(m_returnData);
+    m_output = owning_bytes_ref{};
+    m_analysis.reset();
+    m_code = nullptr;
+    m_pool = nullptr;
+    m_ext = nullptr;
+    m_io_gas_p = nullptr;
+    m_onOp = OnOpFunc();
+    m_nSteps = 0;
+    m_SP = m_SPP = m_stackEnd;
+#if EIP_615
+    m_RP = m_return - 1;
+#endif
+}
+
 //
 // main interpreter loop and switch
 //
@@ -285,7 +305,7 @@ void LegacyVM::interpretCases()
 
             uint64_t b = (uint64_t)m_SP[0];
             uint64_t s = (uint64_t)m_SP[1];
-            m_output = owning_bytes_ref{std::move(m_mem), b, s};
+            m_output = frameOutput(b, s);
             m_bounce = 0;
         }
         BREAK
@@ -303,7 +323,7 @@ void LegacyVM::interpretCases()
 
             uint64_t b = (uint64_t)m_SP[0];
             uint64_t s = (uint64_t)m_SP[1];
-            owning_bytes_ref output{move(m_mem), b, s};
+            owning_bytes_ref output = frameOutput(b, s);
             throwRevertInstruction(move(output));
         }
         BREAK;
@@ -347,7 +367,7 @@ void LegacyVM::interpretCases()
             updateMem(toInt63(m_SP[0]) + 32);
             updateIOGas();
 
-            m_SPP[0] = (u256)*(h256 const*)(m_mem.data() + (unsigned)m_SP[0]);
+            m_SPP[0] = Word256::loadBigEndian(m_mem.data() + (unsigned)m_SP[0]).toU256();
         }
         NEXT
 
@@ -357,7 +377,7 @@ void LegacyVM::interpretCases()
             updateMem(toInt63(m_SP[0]) + 32);
             updateIOGas();
 
-            *(h256*)&m_mem[(unsigned)m_SP[0]] = (h256)m_SP[1];
+            Word256::fromU256(m_SP[1]).storeBigEndian(&m_mem[(unsigned)m_SP[0]]);
         }
         NEXT
 
@@ -456,8 +476,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            u256 base = m_SP[0];
-            m_SPP[0] = exp256(base, expon);
+            m_SPP[0] = exp(Word256::fromU256(m_SP[0]), Word256::fromU256(expon)).toU256();
         }
         NEXT
 
@@ -499,7 +518,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? divWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = div(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -508,7 +527,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(divWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = sdiv(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
             --m_SP;
         }
         NEXT
@@ -518,7 +537,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? modWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = mod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -527,7 +546,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(modWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = smod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])).toU256();
         }
         NEXT
 
@@ -563,7 +582,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) < u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = slt(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1])) ? 1 : 0;
         }
         NEXT
 
@@ -572,7 +591,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) > u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = slt(Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[0])) ? 1 : 0;
         }
         NEXT
 
@@ -671,25 +690,9 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            static u256 const hibit = u256(1) << 255;
-            static u256 const allbits =
-                u256("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
-
-            u256 shiftee = m_SP[1];
-            if (m_SP[0] >= 256)
-            {
-                if (shiftee & hibit)
-                    m_SPP[0] = allbits;
-                else
-                    m_SPP[0] = 0;
-            }
-            else
-            {
-                unsigned amount = unsigned(m_SP[0]);
-                m_SPP[0] = shiftee >> amount;
-                if (shiftee & hibit)
-                    m_SPP[0] |= allbits << (256 - amount);
-            }
+            // Shifting by 255 already fills the word with the sign bit.
+            unsigned const amount = m_SP[0] >= 256 ? 255 : unsigned(m_SP[0]);
+            m_SPP[0] = sar(Word256::fromU256(m_SP[1]), amount).toU256();
         }
         NEXT
 
@@ -698,7 +701,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) + u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = addmod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[2])).toU256();
         }
         NEXT
 
@@ -707,7 +710,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) * u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = mulmod(Word256::fromU256(m_SP[0]), Word256::fromU256(m_SP[1]), Word256::fromU256(m_SP[2])).toU256();
         }
         NEXT
 
@@ -735,7 +738,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_PC = decodeJumpDest(m_code.data(), m_PC);
+            m_PC = decodeJumpDest(m_code, m_PC);
         }
         CONTINUE
 
@@ -745,7 +748,7 @@ void LegacyVM::interpretCases()
             updateIOGas();
 
             if (m_SP[0])
-                m_PC = decodeJumpDest(m_code.data(), m_PC);
+                m_PC = decodeJumpDest(m_code, m_PC);
             else
                 ++m_PC;
         }
@@ -755,7 +758,7 @@ void LegacyVM::interpretCases()
         {
             ON_OP();
             updateIOGas();
-            m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+            m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
         }
         CONTINUE
 
@@ -764,7 +767,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC++;
-            m_PC = decodeJumpDest(m_code.data(), m_PC);
+            m_PC = decodeJumpDest(m_code, m_PC);
         }
         CONTINUE
 
@@ -773,7 +776,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC;
-            m_PC = decodeJumpvDest(m_code.data(), m_PC, byte(m_SP[0]));
+            m_PC = decodeJumpvDest(m_code, m_PC, byte(m_SP[0]));
         }
         CONTINUE
 
@@ -1463,6 +1466,18 @@ void LegacyVM::interpretCases()
         CASE(PUSH2)
         CASE(PUSH3)
         CASE(PUSH4)
+        {
+            ON_OP();
+            updateIOGas();
+
+            int numBytes = (int)m_OP - (int)Instruction::PUSH1 + 1;
+            uint64_t val = 0;
+            for (++m_PC; numBytes--; ++m_PC)
+                val = (val << 8) | m_code[m_PC];
+            m_SPP[0] = val;
+        }
+        CONTINUE
+
         CASE(PUSH5)
         CASE(PUSH6)
         CASE(PUSH7)
@@ -1495,13 +1510,9 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            int numBytes = (int)m_OP - (int)Instruction::PUSH1 + 1;
-            m_SPP[0] = 0;
-            // Construct a number out of PUSH bytes.
-            // This requires the code has been copied and extended by 32 zero
-            // bytes to handle "out of code" push data here.
-            for (++m_PC; numBytes--; ++m_PC)
-                m_SPP[0] = (m_SPP[0] << 8) | m_code[m_PC];
+            // The analysis decoded the PUSH bytes into the constant pool.
+            m_SPP[0] = m_pool[CodeAnalysis::poolIndex(&m_code[m_PC + 1])];
+            m_PC += (int)m_OP - (int)Instruction::PUSH1 + 2;
         }
         CONTINUE
 
@@ -3,6 +3,9 @@
 #include "Instruction.h"
 #include "LegacyVMConfig.h"
 #include "VMFace.h"
+#include "VMPool.h"
+
+#include <libbrcd-interpreter/CodeAnalysis.h>
 
 namespace dev
 {
@@ -20,6 +23,9 @@ public:
     void validateSubroutine(uint64_t _PC, uint64_t* _rp, u256* _sp);
 #endif
 
+    /// Gets the instance ready for the next frame, for VMPool.
+    void reset();
+
     bytes const& memory() const { return m_mem; }
     u256s stack() const {
         u256s stack(m_SP, m_stackEnd);
@@ -36,8 +42,6 @@ private:
 
     static std::array<InstructionMetric, 256> c_metrics;
     static void initMetrics();
-    static u256 exp256(u256 _base, u256 _exponent);
-    void copyCode(int);
     typedef void (LegacyVM::*MemFnPtr)();
     MemFnPtr m_bounce = 0;
     MemFnPtr m_onFail = 0;
@@ -50,8 +54,9 @@ private:
     // space for memory
     bytes m_mem;
 
-    // space for code
-    bytes m_code;
+    // analysed code, shared with every frame running it
+    std::shared_ptr<CodeAnalysis const> m_analysis;
+    byte const* m_code = nullptr;
 
     /// RETURNDATA buffer for memory returned from direct subcalls.
     bytes m_returnData;
@@ -70,7 +75,7 @@ private:
 #endif
 
     // constant pool
-    std::vector<u256> m_pool;
+    u256 const* m_pool = nullptr;
 
     // interpreter state
     Instruction m_OP;                   // current operation
@@ -100,6 +105,7 @@ private:
 
     void copyDataToMemory(bytesConstRef _data, u256*_sp);
     uint64_t memNeed(u256 _offset, u256 _size);
+    owning_bytes_ref frameOutput(uint64_t _begin, uint64_t _size);
 
     void throwOutOfGas();
     void throwBadInstruction();
@@ -110,7 +116,6 @@ private:
     void throwBufferOverrun(bigint const& _enfOfAccess);
 
     std::vector<uint64_t> m_beginSubs;
-    std::vector<uint64_t> m_jumpDests;
     int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
 
     void onOperation();
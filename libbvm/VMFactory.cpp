@@ -1,7 +1,9 @@
 #include "VMFactory.h"
 #include "BVMC.h"
 #include "LegacyVM.h"
+#include "VMPool.h"
 
+#include <libbrcd-interpreter/CodeAnalysis.h>
 #include <libbrcd-interpreter/interpreter.h>
 
 #include <bvmc/loader.h>
@@ -38,6 +40,7 @@ struct VMKindTableEntry
 /// so linear search only to parse command line arguments is not a problem.
 VMKindTableEntry vmKindsTable[] = {
     {VMKind::Interpreter, "interpreter"},
+    {VMKind::Threaded, "threaded"},
     {VMKind::Legacy, "legacy"},
 };
 
@@ -153,6 +156,18 @@ po::options_description vmProgramOptions(unsigned _lineLength)
             ->notifier(parseBvmcOptions),
         "BVMC option\n");
 
+    add("vm-code-cache",
+        po::value<size_t>()->value_name("<MiB>")->notifier([](size_t _mb) {
+            CodeAnalysisCache::instance().setBudget(_mb * 1024 * 1024);
+        }),
+        "Set the memory of analysed contract code shared by all calls, 0 to analyse the code on "
+        "every call (default: 32)\n");
+
+    add("vm-pool",
+        po::value<size_t>()->value_name("<n>")->notifier([](size_t _n) { vmPoolCapacity() = _n; }),
+        "Set the idle VM instances each thread keeps for the next call frames, 0 to make a VM for "
+        "every frame (default: 16)\n");
+
     return opts;
 }
 
@@ -166,18 +181,23 @@ VMPtr VMFactory::create(VMKind _kind)
 {
     static const auto default_delete = [](VMFace * _vm) noexcept { delete _vm; };
     static const auto null_delete = [](VMFace*) noexcept {};
+    static const auto legacy_release = [](VMFace* _vm) noexcept {
+        VMPool<LegacyVM>::release(std::unique_ptr<LegacyVM>{static_cast<LegacyVM*>(_vm)});
+    };
 
     switch (_kind)
     {
     case VMKind::Interpreter:
         return {new BVMC{bvmc_create_interpreter()}, default_delete};
+    case VMKind::Threaded:
+        return {new BVMC{bvmc_create_threaded_interpreter()}, default_delete};
     case VMKind::DLL:
         assert(g_bvmcDll != nullptr);
         // Return "fake" owning pointer to global BVMC DLL VM.
         return {g_bvmcDll.get(), null_delete};
     case VMKind::Legacy:
     default:
-        return {new LegacyVM, default_delete};
+        return {VMPool<LegacyVM>::acquire().release(), legacy_release};
     }
 }
 }  // namespace brc
@@ -11,6 +11,7 @@ namespace brc
 enum class VMKind
 {
     Interpreter,
+    Threaded,
     Legacy,
     DLL
 };
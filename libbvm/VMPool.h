@@ -0,0 +1,113 @@
+#pragma once
+
+#include <libdevcore/Common.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace dev
+{
+namespace brc
+{
+
+/// Idle instances kept by each thread in every VMPool, 0 to make a new VM for every frame.
+inline std::atomic<size_t>& vmPoolCapacity()
+{
+    static std::atomic<size_t> capacity{16};
+    return capacity;
+}
+
+/// Buffers of an idle VM over this capacity are freed rather than kept for the next frame.
+static constexpr size_t c_maxIdleBuffer = 1024 * 1024;
+
+/// Empties @a _buffer for the next frame, keeping its allocation unless it is outsized.
+inline void recycleBuffer(bytes& _buffer)
+{
+    if (_buffer.capacity() > c_maxIdleBuffer)
+        bytes().swap(_buffer);
+    else
+        _buffer.clear();
+}
+
+struct VMPoolStats
+{
+    uint64_t acquired = 0;
+    uint64_t created = 0;
+};
+
+/**
+ * @brief Per-thread pool of idle VM instances of one type.
+ * A call frame takes an instance from the pool of its thread and gives it back when it is done, so
+ * the nested calls and the next transactions run on instances whose stack array is already built
+ * and whose memory and return data buffers are already grown. VMType::reset() makes an instance
+ * given back ready for the next frame: it clears only what the frame used, and keeps the buffers.
+ * The memory is zeroed as it grows again, like a new one.
+ */
+template <class VMType>
+class VMPool
+{
+public:
+    /// @returns an idle instance of this thread, or a new one.
+    static std::unique_ptr<VMType> acquire()
+    {
+        ++counters().acquired;
+        auto& pool = idle();
+        if (pool.empty())
+        {
+            ++counters().created;
+            return std::unique_ptr<VMType>(new VMType);
+        }
+        auto ret = std::move(pool.back());
+        pool.pop_back();
+        return ret;
+    }
+
+    /// Keeps @a _vm for the next acquire() of this thread, deletes it if the pool is full.
+    static void release(std::unique_ptr<VMType> _vm) noexcept
+    {
+        auto& pool = idle();
+        if (pool.size() >= vmPoolCapacity())
+            return;
+        try
+        {
+            _vm->reset();
+            pool.push_back(std::move(_vm));
+        }
+        catch (...)
+        {
+            // Out of memory, the instance is deleted.
+        }
+    }
+
+    /// Counts of every thread since the start.
+    static VMPoolStats stats()
+    {
+        VMPoolStats ret;
+        ret.acquired = counters().acquired;
+        ret.created = counters().created;
+        return ret;
+    }
+
+private:
+    struct Counters
+    {
+        std::atomic<uint64_t> acquired{0};
+        std::atomic<uint64_t> created{0};
+    };
+
+    static Counters& counters()
+    {
+        static Counters counters;
+        return counters;
+    }
+
+    static std::vector<std::unique_ptr<VMType>>& idle()
+    {
+        thread_local std::vector<std::unique_ptr<VMType>> t_idle;
+        return t_idle;
+    }
+};
+
+}
+}
@@ -2,6 +2,7 @@
 
 #include <libdevcore/Log.h>
 #include <libbvm/VMFactory.h>
+#include <libbrcd-interpreter/CodeAnalysis.h>
 
 namespace dev
 {
@@ -42,6 +43,7 @@ BRC::Result BRC::execute(ExtVMFace& _ext, int64_t gas)
     bvmc_message msg = {kind, flags, static_cast<int32_t>(_ext.depth), gas, toBvmC(_ext.myAddress),
         toBvmC(_ext.caller), _ext.data.data(), _ext.data.size(), toBvmC(_ext.value),
         toBvmC(0x0_cppui256)};
+    CodeAnalysisCache::CodeHashScope codeHash(_ext.codeHash);
     return BRC::Result{
         bvmc_execute(m_instance, &_ext, mode, &msg, _ext.code.data(), _ext.code.size())};
 }
@@ -35,6 +35,21 @@ DBKindTableEntry dbKindsTable[] = {
     {DatabaseKind::MemoryDB, "memorydb"},
 };
 
+/// The available database profiles, the first one is the default and keeps the settings used
+/// before profiles existed.
+///
+/// Keys of the state trie are random hashes, so a lookup usually misses every level but one:
+/// the bloom filters spare those reads, the block cache keeps the upper trie nodes in memory.
+DatabaseProfile const dbProfilesTable[] = {
+    {"default", 8 * 1024 * 1024, 4 * 1024 * 1024, 0, 256, false},
+    {"archive", 512 * 1024 * 1024, 64 * 1024 * 1024, 10, 1024, true},
+    {"validator", 256 * 1024 * 1024, 32 * 1024 * 1024, 10, 512, false},
+    {"lowmem", 8 * 1024 * 1024, 2 * 1024 * 1024, 10, 64, false},
+};
+
+DatabaseProfile const* g_profile = &dbProfilesTable[0];
+unsigned g_commitPipelineDepth = 0;
+
 void setDatabaseKindByName(std::string const& _name)
 {
     for (auto& entry : dbKindsTable)
@@ -55,6 +70,36 @@ void setDatabaseKind(DatabaseKind _kind)
     g_kind = _kind;
 }
 
+DatabaseProfile const& databaseProfile()
+{
+    return *g_profile;
+}
+
+void setDatabaseProfileByName(std::string const& _name)
+{
+    for (auto const& entry : dbProfilesTable)
+    {
+        if (_name == entry.name)
+        {
+            g_profile = &entry;
+            return;
+        }
+    }
+
+    BOOST_THROW_EXCEPTION(brc::InvalidDatabaseProfile()
+                          << errinfo_comment("invalid database profile supplied: " + _name));
+}
+
+unsigned commitPipelineDepth()
+{
+    return g_commitPipelineDepth;
+}
+
+void setCommitPipelineDepth(unsigned _depth)
+{
+    g_commitPipelineDepth = _depth;
+}
+
 void setDatabasePath(std::string const& _path)
 {
     g_dbPath = fs::path(_path);
@@ -96,6 +141,19 @@ po::options_description databaseProgramOptions(unsigned _lineLength)
 
         return "Select database implementation. Available options are: " + names + ".";
     }();
+    static std::string const profileDescription = [] {
+        std::string names;
+        for (auto const& entry : dbProfilesTable)
+        {
+            if (!names.empty())
+                names += ", ";
+            names += entry.name;
+        }
+
+        return "Select the cache, bloom filter and compaction settings of the database. Available "
+               "options are: " +
+               names + ".";
+    }();
 
     po::options_description opts("DATABASE OPTIONS", _lineLength);
     auto add = opts.add_options();
@@ -112,6 +170,17 @@ po::options_description databaseProgramOptions(unsigned _lineLength)
             ->notifier(setDatabasePath),
         "Database path (for non-memory database options)\n");
 
+    add("db-profile",
+        po::value<std::string>()->value_name("<name>")->default_value(dbProfilesTable[0].name)->notifier(
+            setDatabaseProfileByName),
+        profileDescription.data());
+
+    add("db-commit-pipeline",
+        po::value<unsigned>()->value_name("<n>")->default_value(0)->notifier(
+            setCommitPipelineDepth),
+        "Write up to <n> committed state batches in the background while the next blocks are "
+        "imported, 0 to write them on commit. After a crash, the last blocks may need --rescue.\n");
+
     return opts;
 }
 
@@ -125,6 +194,17 @@ std::unique_ptr<DatabaseFace> DBFactory::create(fs::path const& _path)
     return create(g_kind, _path);
 }
 
+std::unique_ptr<DatabaseFace> DBFactory::create(fs::path const& _path,
+    std::vector<DatabaseFamily> const& _families, FamilyRouter const& _route)
+{
+    if (g_kind == DatabaseKind::RocksDB && _families.size() > 1)
+        return std::unique_ptr<DatabaseFace>(new RocksDBFamilies(_path, _families, _route));
+    if (g_kind == DatabaseKind::RocksDB && !_families.empty())
+        return std::unique_ptr<DatabaseFace>(new RocksDB(_path, RocksDB::defaultReadOptions(),
+            RocksDB::defaultWriteOptions(), RocksDB::familyOptions(_families.front())));
+    return create(_path);
+}
+
 std::unique_ptr<DatabaseFace> DBFactory::create(DatabaseKind _kind)
 {
     return create(_kind, databasePath());
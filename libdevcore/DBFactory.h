@@ -6,6 +6,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/program_options/options_description.hpp>
 
+#include <functional>
+#include <vector>
+
 namespace dev
 {
 namespace db
@@ -17,6 +20,31 @@ enum class DatabaseKind
     MemoryDB
 };
 
+/// Tuning of the on-disk databases, selected by name with --db-profile.
+struct DatabaseProfile
+{
+    char const* name;
+    size_t blockCacheSize;    ///< Bytes of uncompressed blocks kept in memory, by one cache shared by
+                              ///< every database opened with the profile.
+    size_t writeBufferSize;   ///< Bytes buffered in the memtable before it is flushed to a table.
+    int bloomBitsPerKey;      ///< 0 for no bloom filter.
+    int maxOpenFiles;
+    bool universalCompaction; ///< RocksDB only, fewer rewrites at the cost of space.
+};
+
+/// A part of a database kept apart where the backend supports it: a RocksDB column family with
+/// its own compaction. Other backends keep every family in the one keyspace.
+struct DatabaseFamily
+{
+    std::string name;       ///< The first family of a database must be "default".
+    bool cached;            ///< Reads go through the profile's block cache, off for data seldom read.
+    bool pointLookups;      ///< Mostly read by random key: bloom filter, tuned for hits.
+    bool bulkWrites;        ///< Mostly written in large batches: bigger write buffers.
+};
+
+/// @returns the index of the family of a key.
+using FamilyRouter = std::function<size_t(Slice)>;
+
 /// Provide a set of program options related to databases
 ///
 /// @param _lineLength  The line length for description text wrapping, the same as in
@@ -28,6 +56,11 @@ bool isDiskDatabase();
 DatabaseKind databaseKind();
 void setDatabaseKindByName(std::string const& _name);
 void setDatabaseKind(DatabaseKind _kind);
+DatabaseProfile const& databaseProfile();
+void setDatabaseProfileByName(std::string const& _name);
+/// Committed state batches written in the background at a time, 0 to write them on commit.
+unsigned commitPipelineDepth();
+void setCommitPipelineDepth(unsigned _depth);
 boost::filesystem::path databasePath();
 
 class DBFactory
@@ -41,6 +74,9 @@ public:
     static std::unique_ptr<DatabaseFace> create(DatabaseKind _kind);
     static std::unique_ptr<DatabaseFace> create(
         DatabaseKind _kind, boost::filesystem::path const& _path);
+    /// Opens the database at @a _path with every key kept in the family @a _route picks.
+    static std::unique_ptr<DatabaseFace> create(boost::filesystem::path const& _path,
+        std::vector<DatabaseFamily> const& _families, FamilyRouter const& _route);
 
 private:
 };
@@ -1,5 +1,9 @@
 #include "LevelDB.h"
 #include "Assertions.h"
+#include "DBFactory.h"
+
+#include <map>
+#include <mutex>
 
 namespace dev
 {
@@ -26,6 +30,22 @@ DatabaseStatus toDatabaseStatus(leveldb::Status const& _status)
         return DatabaseStatus::Unknown;
 }
 
+/// The block cache of @a _profile, shared by every database opened with it, so the profile's
+/// blockCacheSize is the budget of the process. Made again once all of them are closed.
+std::shared_ptr<leveldb::Cache> profileBlockCache(DatabaseProfile const& _profile)
+{
+    static std::mutex s_mutex;
+    static std::map<DatabaseProfile const*, std::weak_ptr<leveldb::Cache>> s_caches;
+    std::lock_guard<std::mutex> l(s_mutex);
+    std::shared_ptr<leveldb::Cache> cache = s_caches[&_profile].lock();
+    if (!cache)
+    {
+        cache.reset(leveldb::NewLRUCache(_profile.blockCacheSize));
+        s_caches[&_profile] = cache;
+    }
+    return cache;
+}
+
 void checkStatus(leveldb::Status const& _status, boost::filesystem::path const& _path = {})
 {
     if (_status.ok())
@@ -77,9 +97,12 @@ leveldb::WriteOptions LevelDB::defaultWriteOptions()
 
 leveldb::Options LevelDB::defaultDBOptions()
 {
+    DatabaseProfile const& profile = databaseProfile();
     leveldb::Options options;
     options.create_if_missing = true;
-    options.max_open_files = 256;
+    options.max_open_files = profile.maxOpenFiles;
+    options.write_buffer_size = profile.writeBufferSize;
+    options.compression = leveldb::kSnappyCompression;
     return options;
 }
 
@@ -87,6 +110,18 @@ LevelDB::LevelDB(boost::filesystem::path const& _path, leveldb::ReadOptions _rea
     leveldb::WriteOptions _writeOptions, leveldb::Options _dbOptions)
   : m_db(nullptr), m_readOptions(std::move(_readOptions)), m_writeOptions(std::move(_writeOptions))
 {
+    DatabaseProfile const& profile = databaseProfile();
+    if (!_dbOptions.block_cache)
+    {
+        m_blockCache = profileBlockCache(profile);
+        _dbOptions.block_cache = m_blockCache.get();
+    }
+    if (!_dbOptions.filter_policy && profile.bloomBitsPerKey > 0)
+    {
+        m_filterPolicy.reset(leveldb::NewBloomFilterPolicy(profile.bloomBitsPerKey));
+        _dbOptions.filter_policy = m_filterPolicy.get();
+    }
+
     auto db = static_cast<leveldb::DB*>(nullptr);
     auto const status = leveldb::DB::Open(_dbOptions, _path.string(), &db);
     checkStatus(status, _path);
@@ -173,5 +208,25 @@ void LevelDB::forEach(std::function<bool(Slice, Slice)> _f) const
     }
 }
 
+void LevelDB::sync()
+{
+    // LevelDB syncs its log on a synced write, even of an empty batch.
+    leveldb::WriteOptions options = m_writeOptions;
+    options.sync = true;
+    leveldb::WriteBatch batch;
+    auto const status = m_db->Write(options, &batch);
+    checkStatus(status);
+}
+
+std::string LevelDB::stats() const
+{
+    std::string ret;
+    m_db->GetProperty("leveldb.stats", &ret);
+    std::string memory;
+    if (m_db->GetProperty("leveldb.approximate-memory-usage", &memory))
+        ret += "memory: " + memory + "\n";
+    return ret;
+}
+
 }  // namespace db
 }  // namespace dev
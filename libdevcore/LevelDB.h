@@ -3,7 +3,9 @@
 #include "db.h"
 
 #include <boost/filesystem.hpp>
+#include <leveldb/cache.h>
 #include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
 #include <leveldb/write_batch.h>
 
 namespace dev
@@ -15,6 +17,9 @@ class LevelDB : public DatabaseFace
 public:
     static leveldb::ReadOptions defaultReadOptions();
     static leveldb::WriteOptions defaultWriteOptions();
+    /// Options of the selected databaseProfile(). The constructor adds the block cache of the
+    /// profile, shared with the other databases, and a bloom filter it owns, unless @a _dbOptions
+    /// already has them.
     static leveldb::Options defaultDBOptions();
 
     explicit LevelDB(boost::filesystem::path const& _path,
@@ -32,7 +37,14 @@ public:
 
     void forEach(std::function<bool(Slice, Slice)> _f) const override;
 
+    void sync() override;
+
+    std::string stats() const override;
+
 private:
+    // Used by m_db, so destroyed after it.
+    std::shared_ptr<leveldb::Cache> m_blockCache;
+    std::unique_ptr<leveldb::FilterPolicy const> m_filterPolicy;
     std::unique_ptr<leveldb::DB> m_db;
     leveldb::ReadOptions const m_readOptions;
     leveldb::WriteOptions const m_writeOptions;
@@ -39,6 +39,12 @@ public:
 
 	bytes lookupAux(h256 const& _h) const;
 
+	/// Waits for the writes committed so far to be on disk, see db::DatabaseFace::sync().
+	void sync() const { if (m_db) m_db->sync(); }
+
+	/// Internal statistics of the database behind, see db::DatabaseFace::stats().
+	std::string stats() const { return m_db ? m_db->stats() : std::string(); }
+
 
 private:
 	using StateCacheDB::clear;
@@ -0,0 +1,198 @@
+#include "PipelinedDB.h"
+#include "Log.h"
+
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace dev
+{
+namespace db
+{
+void PipelinedWriteBatch::insert(Slice _key, Slice _value)
+{
+    m_writes[_key.toString()] = std::make_pair(_value.toString(), true);
+}
+
+void PipelinedWriteBatch::kill(Slice _key)
+{
+    m_writes[_key.toString()] = std::make_pair(std::string(), false);
+}
+
+PipelinedDB::PipelinedDB(std::unique_ptr<DatabaseFace> _db, unsigned _depth)
+  : m_db(std::move(_db)), m_depth(std::max(_depth, 1U))
+{
+    m_writer = std::thread([this]() {
+        setThreadName("dbwriter");
+        writerBody();
+    });
+}
+
+PipelinedDB::~PipelinedDB()
+{
+    DEV_GUARDED(x_queue)
+        m_stopping = true;
+    m_queued.notify_all();
+    m_writer.join();
+}
+
+bool PipelinedDB::findQueued(Slice _key, std::pair<std::string, bool>& o_write) const
+{
+    Guard l(x_queue);
+    if (m_queue.empty())
+        return false;
+    std::string const key = _key.toString();
+    for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it)
+    {
+        auto const found = (*it)->find(key);
+        if (found != (*it)->end())
+        {
+            o_write = found->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string PipelinedDB::lookup(Slice _key) const
+{
+    // A batch leaves the queue only once it is in m_db, so a miss here is never stale there.
+    std::pair<std::string, bool> write;
+    if (findQueued(_key, write))
+        return write.first;
+    return m_db->lookup(_key);
+}
+
+bool PipelinedDB::exists(Slice _key) const
+{
+    std::pair<std::string, bool> write;
+    if (findQueued(_key, write))
+        return write.second;
+    return m_db->exists(_key);
+}
+
+void PipelinedDB::insert(Slice _key, Slice _value)
+{
+    auto batch = createWriteBatch();
+    batch->insert(_key, _value);
+    commit(std::move(batch));
+}
+
+void PipelinedDB::kill(Slice _key)
+{
+    auto batch = createWriteBatch();
+    batch->kill(_key);
+    commit(std::move(batch));
+}
+
+std::unique_ptr<WriteBatchFace> PipelinedDB::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(new PipelinedWriteBatch);
+}
+
+void PipelinedDB::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    if (!_batch)
+    {
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+    }
+    auto* batchPtr = dynamic_cast<PipelinedWriteBatch*>(_batch.get());
+    if (!batchPtr)
+    {
+        BOOST_THROW_EXCEPTION(
+            DatabaseError() << errinfo_comment("Invalid batch type passed to PipelinedDB::commit"));
+    }
+    if (batchPtr->writes().empty())
+        return;
+
+    Frozen frozen = std::make_shared<PipelinedWriteBatch::Writes const>(std::move(batchPtr->writes()));
+    {
+        std::unique_lock<Mutex> l(x_queue);
+        m_written.wait(l, [&]() { return m_queue.size() < m_depth; });
+        m_queue.push_back(std::move(frozen));
+    }
+    m_queued.notify_all();
+}
+
+void PipelinedDB::waitWritten() const
+{
+    std::unique_lock<Mutex> l(x_queue);
+    m_written.wait(l, [&]() { return m_queue.empty(); });
+}
+
+void PipelinedDB::forEach(std::function<bool(Slice, Slice)> _f) const
+{
+    waitWritten();
+    m_db->forEach(_f);
+}
+
+void PipelinedDB::sync()
+{
+    waitWritten();
+    m_db->sync();
+}
+
+std::string PipelinedDB::stats() const
+{
+    size_t queued;
+    DEV_GUARDED(x_queue)
+        queued = m_queue.size();
+    return m_db->stats() + "pipeline: " + std::to_string(queued) + "/" + std::to_string(m_depth) +
+           " batches queued\n";
+}
+
+void PipelinedDB::writerBody()
+{
+    while (true)
+    {
+        Frozen batch;
+        {
+            std::unique_lock<Mutex> l(x_queue);
+            m_queued.wait(l, [&]() { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty())
+                return;
+            // Left in the queue for the readers until it is written.
+            batch = m_queue.front();
+        }
+
+        write(*batch);
+
+        DEV_GUARDED(x_queue)
+            m_queue.pop_front();
+        m_written.notify_all();
+    }
+}
+
+void PipelinedDB::write(PipelinedWriteBatch::Writes const& _writes)
+{
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        auto batch = m_db->createWriteBatch();
+        for (auto const& w : _writes)
+            if (w.second.second)
+                batch->insert(Slice(w.first), Slice(w.second.first));
+            else
+                batch->kill(Slice(w.first));
+        try
+        {
+            m_db->commit(std::move(batch));
+            return;
+        }
+        catch (boost::exception const& ex)
+        {
+            // The import thread has gone on already, there is nobody to report to.
+            if (i == 9)
+            {
+                cwarn << "Fail writing to database. Bombing out.";
+                exit(-1);
+            }
+            cwarn << "Error writing to database: " << boost::diagnostic_information(ex);
+            cwarn << "Sleeping for" << (i + 1) << "seconds, then retrying.";
+            std::this_thread::sleep_for(std::chrono::seconds(i + 1));
+        }
+    }
+}
+
+}  // namespace db
+}  // namespace dev
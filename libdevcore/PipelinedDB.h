@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Guards.h"
+#include "db.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace dev
+{
+namespace db
+{
+class PipelinedWriteBatch : public WriteBatchFace
+{
+public:
+    /// Value of every key written, with false for a killed key.
+    using Writes = std::unordered_map<std::string, std::pair<std::string, bool>>;
+
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    Writes& writes() { return m_writes; }
+
+private:
+    Writes m_writes;
+};
+
+/**
+ * @brief Writes the batches committed to another database on a background thread.
+ * commit() freezes the batch and queues it, so the block import goes on with the next block while
+ * the previous ones are written. Lookups see the queued batches before the database behind, the
+ * newest first, so the pipeline is invisible to readers. At most @a _depth batches are queued,
+ * commit() waits for the writer beyond that. sync() is the barrier: it returns once every batch
+ * committed before it is written and synced to disk.
+ * @threadsafe
+ */
+class PipelinedDB : public DatabaseFace
+{
+public:
+    PipelinedDB(std::unique_ptr<DatabaseFace> _db, unsigned _depth);
+    /// Writes the batches still queued.
+    ~PipelinedDB();
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    /// Queued like a batch, to keep the order with the batches before.
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    /// Waits for the queued batches, then goes through the database behind.
+    void forEach(std::function<bool(Slice, Slice)> _f) const override;
+
+    void sync() override;
+
+    std::string stats() const override;
+
+private:
+    using Frozen = std::shared_ptr<PipelinedWriteBatch::Writes const>;
+
+    /// Looks @a _key up in the queued batches. @returns false if no batch writes it.
+    bool findQueued(Slice _key, std::pair<std::string, bool>& o_write) const;
+    void waitWritten() const;
+    void writerBody();
+    void write(PipelinedWriteBatch::Writes const& _writes);
+
+    std::unique_ptr<DatabaseFace> const m_db;
+    size_t const m_depth;
+
+    /// Oldest first, a batch leaves once it is written.
+    std::deque<Frozen> m_queue;
+    mutable Mutex x_queue;
+    std::condition_variable m_queued;
+    mutable std::condition_variable m_written;
+    bool m_stopping = false;
+    std::thread m_writer;
+};
+
+}  // namespace db
+}  // namespace dev
@@ -1,5 +1,13 @@
 #include "RocksDB.h"
 #include "Assertions.h"
+#include "DBFactory.h"
+
+#include <rocksdb/cache.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+
+#include <map>
+#include <mutex>
 
 namespace dev
 {
@@ -48,6 +56,22 @@ void checkStatus(rocksdb::Status const& _status, boost::filesystem::path const&
     BOOST_THROW_EXCEPTION(ex);
 }
 
+/// The block cache of @a _profile, shared by every database and column family opened with it, so the
+/// profile's blockCacheSize is the budget of the process. Made again once all of them are closed.
+std::shared_ptr<rocksdb::Cache> profileBlockCache(DatabaseProfile const& _profile)
+{
+    static std::mutex s_mutex;
+    static std::map<DatabaseProfile const*, std::weak_ptr<rocksdb::Cache>> s_caches;
+    std::lock_guard<std::mutex> l(s_mutex);
+    std::shared_ptr<rocksdb::Cache> cache = s_caches[&_profile].lock();
+    if (!cache)
+    {
+        cache = rocksdb::NewLRUCache(_profile.blockCacheSize);
+        s_caches[&_profile] = cache;
+    }
+    return cache;
+}
+
 class RocksDBWriteBatch : public WriteBatchFace
 {
 public:
@@ -90,9 +114,45 @@ rocksdb::WriteOptions RocksDB::defaultWriteOptions()
 
 rocksdb::Options RocksDB::defaultDBOptions()
 {
+    DatabaseProfile const& profile = databaseProfile();
     rocksdb::Options options;
     options.create_if_missing = true;
-    options.max_open_files = 256;
+    options.max_open_files = profile.maxOpenFiles;
+    options.write_buffer_size = profile.writeBufferSize;
+    options.compression = rocksdb::kSnappyCompression;
+    options.compaction_style =
+        profile.universalCompaction ? rocksdb::kCompactionStyleUniversal : rocksdb::kCompactionStyleLevel;
+
+    rocksdb::BlockBasedTableOptions table;
+    table.block_cache = profileBlockCache(profile);
+    if (profile.bloomBitsPerKey > 0)
+        table.filter_policy.reset(rocksdb::NewBloomFilterPolicy(profile.bloomBitsPerKey, false));
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table));
+    return options;
+}
+
+rocksdb::Options RocksDB::familyOptions(DatabaseFamily const& _family)
+{
+    DatabaseProfile const& profile = databaseProfile();
+    rocksdb::Options options = defaultDBOptions();
+    if (_family.bulkWrites)
+    {
+        options.write_buffer_size = profile.writeBufferSize * 2;
+        options.max_write_buffer_number = 4;
+    }
+
+    rocksdb::BlockBasedTableOptions table;
+    if (_family.cached)
+        table.block_cache = profileBlockCache(profile);
+    else
+        table.no_block_cache = true;
+    if (_family.pointLookups && profile.bloomBitsPerKey > 0)
+    {
+        table.filter_policy.reset(rocksdb::NewBloomFilterPolicy(profile.bloomBitsPerKey, false));
+        // Lookups mostly find their key, no filter is needed for the last level.
+        options.optimize_filters_for_hits = true;
+    }
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table));
     return options;
 }
 
@@ -185,5 +245,210 @@ void RocksDB::forEach(std::function<bool(Slice, Slice)> f) const
     }
 }
 
+void RocksDB::sync()
+{
+    auto const status = m_db->SyncWAL();
+    checkStatus(status);
+}
+
+std::string RocksDB::stats() const
+{
+    std::string ret;
+    m_db->GetProperty("rocksdb.stats", &ret);
+    std::string memory;
+    if (m_db->GetProperty("rocksdb.block-cache-usage", &memory))
+        ret += "block cache: " + memory + "\n";
+    return ret;
+}
+
+RocksDBFamilies::RocksDBFamilies(boost::filesystem::path const& _path,
+    std::vector<DatabaseFamily> const& _families, FamilyRouter _route)
+  : m_route(std::move(_route)),
+    m_readOptions(RocksDB::defaultReadOptions()),
+    m_writeOptions(RocksDB::defaultWriteOptions())
+{
+    assert(!_families.empty() && _families.front().name == rocksdb::kDefaultColumnFamilyName);
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (auto const& f : _families)
+    {
+        descriptors.emplace_back(f.name, rocksdb::ColumnFamilyOptions(RocksDB::familyOptions(f)));
+        m_names.push_back(f.name);
+    }
+
+    rocksdb::DBOptions options(RocksDB::defaultDBOptions());
+    options.create_missing_column_families = true;
+    auto db = static_cast<rocksdb::DB*>(nullptr);
+    auto const status = rocksdb::DB::Open(options, _path.string(), descriptors, &m_families, &db);
+    checkStatus(status, _path);
+
+    assert(db);
+    m_db.reset(db);
+}
+
+RocksDBFamilies::~RocksDBFamilies()
+{
+    for (auto handle : m_families)
+        m_db->DestroyColumnFamilyHandle(handle);
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBFamilies::family(Slice _key) const
+{
+    size_t const index = m_route(_key);
+    assert(index < m_families.size());
+    return m_families[index];
+}
+
+std::string RocksDBFamilies::lookup(Slice _key) const
+{
+    rocksdb::Slice const key(_key.data(), _key.size());
+    auto handle = family(_key);
+    std::string value;
+    auto status = m_db->Get(m_readOptions, handle, key, &value);
+    if (status.IsNotFound() && handle != m_families.front())
+        status = m_db->Get(m_readOptions, m_families.front(), key, &value);
+    if (status.IsNotFound())
+        return std::string();
+
+    checkStatus(status);
+    return value;
+}
+
+bool RocksDBFamilies::exists(Slice _key) const
+{
+    rocksdb::Slice const key(_key.data(), _key.size());
+    auto handle = family(_key);
+    if (exists(handle, key))
+        return true;
+    return handle != m_families.front() && exists(m_families.front(), key);
+}
+
+bool RocksDBFamilies::exists(rocksdb::ColumnFamilyHandle* _family, rocksdb::Slice const& _key) const
+{
+    std::string value;
+    if (!m_db->KeyMayExist(m_readOptions, _family, _key, &value, nullptr))
+        return false;
+
+    auto const status = m_db->Get(m_readOptions, _family, _key, &value);
+    if (status.IsNotFound())
+        return false;
+
+    checkStatus(status);
+    return true;
+}
+
+void RocksDBFamilies::insert(Slice _key, Slice _value)
+{
+    rocksdb::Slice const key(_key.data(), _key.size());
+    rocksdb::Slice const value(_value.data(), _value.size());
+    auto const status = m_db->Put(m_writeOptions, family(_key), key, value);
+    checkStatus(status);
+}
+
+void RocksDBFamilies::kill(Slice _key)
+{
+    rocksdb::Slice const key(_key.data(), _key.size());
+    auto handle = family(_key);
+    rocksdb::WriteBatch batch;
+    batch.Delete(handle, key);
+    if (handle != m_families.front())
+        batch.Delete(m_families.front(), key);
+    auto const status = m_db->Write(m_writeOptions, &batch);
+    checkStatus(status);
+}
+
+namespace
+{
+class RocksDBFamiliesWriteBatch : public WriteBatchFace
+{
+public:
+    RocksDBFamiliesWriteBatch(std::function<rocksdb::ColumnFamilyHandle*(Slice)> _family,
+        rocksdb::ColumnFamilyHandle* _default)
+      : m_family(std::move(_family)), m_default(_default)
+    {}
+
+    void insert(Slice _key, Slice _value) override
+    {
+        auto const status = m_writeBatch.Put(m_family(_key), rocksdb::Slice(_key.data(), _key.size()),
+            rocksdb::Slice(_value.data(), _value.size()));
+        checkStatus(status);
+    }
+
+    void kill(Slice _key) override
+    {
+        // like RocksDBFamilies::kill, the copy a pre-family database keeps in the default family goes too.
+        rocksdb::Slice const key(_key.data(), _key.size());
+        auto const handle = m_family(_key);
+        checkStatus(m_writeBatch.Delete(handle, key));
+        if (handle != m_default)
+            checkStatus(m_writeBatch.Delete(m_default, key));
+    }
+
+    rocksdb::WriteBatch& writeBatch() { return m_writeBatch; }
+
+private:
+    std::function<rocksdb::ColumnFamilyHandle*(Slice)> const m_family;
+    rocksdb::ColumnFamilyHandle* const m_default;
+    rocksdb::WriteBatch m_writeBatch;
+};
+}  // namespace
+
+std::unique_ptr<WriteBatchFace> RocksDBFamilies::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(
+        new RocksDBFamiliesWriteBatch([this](Slice _key) { return family(_key); }, m_families.front()));
+}
+
+void RocksDBFamilies::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    if (!_batch)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+
+    auto* batchPtr = dynamic_cast<RocksDBFamiliesWriteBatch*>(_batch.get());
+    if (!batchPtr)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Invalid batch type passed to RocksDBFamilies::commit"));
+
+    auto const status = m_db->Write(m_writeOptions, &batchPtr->writeBatch());
+    checkStatus(status);
+}
+
+void RocksDBFamilies::forEach(std::function<bool(Slice, Slice)> f) const
+{
+    for (auto handle : m_families)
+    {
+        std::unique_ptr<rocksdb::Iterator> itr(m_db->NewIterator(m_readOptions, handle));
+        if (itr == nullptr)
+            BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("null iterator"));
+
+        for (itr->SeekToFirst(); itr->Valid(); itr->Next())
+        {
+            auto const dbKey = itr->key();
+            auto const dbValue = itr->value();
+            Slice const key(dbKey.data(), dbKey.size());
+            Slice const value(dbValue.data(), dbValue.size());
+            if (!f(key, value))
+                return;
+        }
+    }
+}
+
+void RocksDBFamilies::sync()
+{
+    // The families share the write ahead log.
+    auto const status = m_db->SyncWAL();
+    checkStatus(status);
+}
+
+std::string RocksDBFamilies::stats() const
+{
+    std::string ret;
+    for (size_t i = 0; i < m_families.size(); ++i)
+    {
+        std::string family;
+        m_db->GetProperty(m_families[i], "rocksdb.stats", &family);
+        ret += m_names[i] + ":\n" + family;
+    }
+    return ret;
+}
+
 }  // namespace db
 }  // namespace dev
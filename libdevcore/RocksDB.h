@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DBFactory.h"
 #include "db.h"
 
 #include <boost/filesystem.hpp>
@@ -15,7 +16,10 @@ class RocksDB : public DatabaseFace
 public:
     static rocksdb::ReadOptions defaultReadOptions();
     static rocksdb::WriteOptions defaultWriteOptions();
+    /// Options of the selected databaseProfile().
     static rocksdb::Options defaultDBOptions();
+    /// defaultDBOptions() tuned for the data of @a _family.
+    static rocksdb::Options familyOptions(DatabaseFamily const& _family);
 
     explicit RocksDB(boost::filesystem::path const& _path,
         rocksdb::ReadOptions _readOptions = defaultReadOptions(),
@@ -32,8 +36,51 @@ public:
 
     void forEach(std::function<bool(Slice, Slice)> f) const override;
 
+    void sync() override;
+
+    std::string stats() const override;
+
+private:
+    std::unique_ptr<rocksdb::DB> m_db;
+    rocksdb::ReadOptions const m_readOptions;
+    rocksdb::WriteOptions const m_writeOptions;
+};
+
+/**
+ * @brief A RocksDB database split in column families, each with the options of its DatabaseFamily.
+ * Every key goes to the family picked by the router. A key missing from its family is looked up
+ * in the default family too, where a database written before the family existed has it.
+ */
+class RocksDBFamilies : public DatabaseFace
+{
+public:
+    RocksDBFamilies(boost::filesystem::path const& _path, std::vector<DatabaseFamily> const& _families,
+        FamilyRouter _route);
+    ~RocksDBFamilies();
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    /// Goes through the families in turn.
+    void forEach(std::function<bool(Slice, Slice)> f) const override;
+
+    void sync() override;
+
+    std::string stats() const override;
+
 private:
+    rocksdb::ColumnFamilyHandle* family(Slice _key) const;
+    bool exists(rocksdb::ColumnFamilyHandle* _family, rocksdb::Slice const& _key) const;
+
     std::unique_ptr<rocksdb::DB> m_db;
+    std::vector<rocksdb::ColumnFamilyHandle*> m_families;
+    std::vector<std::string> m_names;
+    FamilyRouter const m_route;
     rocksdb::ReadOptions const m_readOptions;
     rocksdb::WriteOptions const m_writeOptions;
 };
@@ -3,6 +3,8 @@
 
 #include <brcash/keccak.hpp>
 
+#include <algorithm>
+
 namespace dev
 {
 h256 const EmptySHA3 = sha3(bytesConstRef());
@@ -16,4 +18,247 @@ bool sha3(bytesConstRef _input, bytesRef o_output) noexcept
     bytesConstRef{h.bytes, 32}.copyTo(o_output);
     return true;
 }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DEV_SHA3_LANES 1
+#endif
+
+namespace
+{
+#if DEV_SHA3_LANES
+
+/// The rate of Keccak-256: the bytes absorbed by every permutation.
+size_t const c_rate = 136;
+
+uint64_t const c_roundConstants[24] = {0x0000000000000001, 0x0000000000008082,
+    0x800000000000808a, 0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+    0x8000000080008081, 0x8000000000008009, 0x000000000000008a, 0x0000000000000088,
+    0x0000000080008009, 0x000000008000000a, 0x000000008000808b, 0x800000000000008b,
+    0x8000000000008089, 0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+    0x000000000000800a, 0x800000008000000a, 0x8000000080008081, 0x8000000000008080,
+    0x0000000080000001, 0x8000000080008008};
+
+typedef uint64_t Lanes4 __attribute__((vector_size(32)));
+typedef uint64_t Lanes8 __attribute__((vector_size(64)));
+
+#define DEV_ROL(_v, _n) (((_v) << (_n)) | ((_v) >> (64 - (_n))))
+
+/// Keccak-f[1600] on the states of every lane of @a V at once, lane by lane the same as
+/// brcash_keccakf1600. Written out in full so the state stays in registers, and inlined into the
+/// kernels so it is built for their instruction set.
+template <class V>
+inline __attribute__((always_inline)) void keccakf1600Lanes(V* _a)
+{
+    for (uint64_t rc : c_roundConstants)
+    {
+        // theta
+        V const c0 = _a[0] ^ _a[5] ^ _a[10] ^ _a[15] ^ _a[20];
+        V const c1 = _a[1] ^ _a[6] ^ _a[11] ^ _a[16] ^ _a[21];
+        V const c2 = _a[2] ^ _a[7] ^ _a[12] ^ _a[17] ^ _a[22];
+        V const c3 = _a[3] ^ _a[8] ^ _a[13] ^ _a[18] ^ _a[23];
+        V const c4 = _a[4] ^ _a[9] ^ _a[14] ^ _a[19] ^ _a[24];
+        V const d0 = c4 ^ DEV_ROL(c1, 1);
+        V const d1 = c0 ^ DEV_ROL(c2, 1);
+        V const d2 = c1 ^ DEV_ROL(c3, 1);
+        V const d3 = c2 ^ DEV_ROL(c4, 1);
+        V const d4 = c3 ^ DEV_ROL(c0, 1);
+
+        // rho and pi: lane x + 5y rotated into y + 5(2x + 3y)
+        V const b0 = _a[0] ^ d0;
+        V const b1 = DEV_ROL(_a[6] ^ d1, 44);
+        V const b2 = DEV_ROL(_a[12] ^ d2, 43);
+        V const b3 = DEV_ROL(_a[18] ^ d3, 21);
+        V const b4 = DEV_ROL(_a[24] ^ d4, 14);
+        V const b5 = DEV_ROL(_a[3] ^ d3, 28);
+        V const b6 = DEV_ROL(_a[9] ^ d4, 20);
+        V const b7 = DEV_ROL(_a[10] ^ d0, 3);
+        V const b8 = DEV_ROL(_a[16] ^ d1, 45);
+        V const b9 = DEV_ROL(_a[22] ^ d2, 61);
+        V const b10 = DEV_ROL(_a[1] ^ d1, 1);
+        V const b11 = DEV_ROL(_a[7] ^ d2, 6);
+        V const b12 = DEV_ROL(_a[13] ^ d3, 25);
+        V const b13 = DEV_ROL(_a[19] ^ d4, 8);
+        V const b14 = DEV_ROL(_a[20] ^ d0, 18);
+        V const b15 = DEV_ROL(_a[4] ^ d4, 27);
+        V const b16 = DEV_ROL(_a[5] ^ d0, 36);
+        V const b17 = DEV_ROL(_a[11] ^ d1, 10);
+        V const b18 = DEV_ROL(_a[17] ^ d2, 15);
+        V const b19 = DEV_ROL(_a[23] ^ d3, 56);
+        V const b20 = DEV_ROL(_a[2] ^ d2, 62);
+        V const b21 = DEV_ROL(_a[8] ^ d3, 55);
+        V const b22 = DEV_ROL(_a[14] ^ d4, 39);
+        V const b23 = DEV_ROL(_a[15] ^ d0, 41);
+        V const b24 = DEV_ROL(_a[21] ^ d1, 2);
+
+        // chi and iota
+        _a[0] = b0 ^ (~b1 & b2);
+        _a[1] = b1 ^ (~b2 & b3);
+        _a[2] = b2 ^ (~b3 & b4);
+        _a[3] = b3 ^ (~b4 & b0);
+        _a[4] = b4 ^ (~b0 & b1);
+        _a[5] = b5 ^ (~b6 & b7);
+        _a[6] = b6 ^ (~b7 & b8);
+        _a[7] = b7 ^ (~b8 & b9);
+        _a[8] = b8 ^ (~b9 & b5);
+        _a[9] = b9 ^ (~b5 & b6);
+        _a[10] = b10 ^ (~b11 & b12);
+        _a[11] = b11 ^ (~b12 & b13);
+        _a[12] = b12 ^ (~b13 & b14);
+        _a[13] = b13 ^ (~b14 & b10);
+        _a[14] = b14 ^ (~b10 & b11);
+        _a[15] = b15 ^ (~b16 & b17);
+        _a[16] = b16 ^ (~b17 & b18);
+        _a[17] = b17 ^ (~b18 & b19);
+        _a[18] = b18 ^ (~b19 & b15);
+        _a[19] = b19 ^ (~b15 & b16);
+        _a[20] = b20 ^ (~b21 & b22);
+        _a[21] = b21 ^ (~b22 & b23);
+        _a[22] = b22 ^ (~b23 & b24);
+        _a[23] = b23 ^ (~b24 & b20);
+        _a[24] = b24 ^ (~b20 & b21);
+        _a[0] ^= rc;
+    }
+}
+
+#undef DEV_ROL
+
+/// An input being absorbed in one lane: its whole blocks and its padded last one.
+struct Lane
+{
+    byte const* data;
+    size_t blocks;
+    byte last[c_rate];
+    h256* out;
+
+    void init(bytesConstRef _input, h256* _out)
+    {
+        data = _input.data();
+        blocks = _input.size() / c_rate + 1;
+        size_t const tail = _input.size() % c_rate;
+        std::memset(last, 0, c_rate);
+        if (tail)
+            std::memcpy(last, data + _input.size() - tail, tail);
+        last[tail] = 0x01;
+        last[c_rate - 1] |= 0x80;
+        out = _out;
+    }
+
+    /// @returns block @a _i, or null past the last one.
+    byte const* block(size_t _i) const
+    {
+        return _i + 1 < blocks ? data + _i * c_rate : _i + 1 == blocks ? last : nullptr;
+    }
+};
+
+/// Hashes as many inputs as @a V has lanes or fewer, the one of the most blocks in the last lane.
+template <class V>
+inline __attribute__((always_inline)) void hashLanes(Lane const* _lanes, unsigned _count)
+{
+    static byte const c_noBlock[c_rate] = {};
+    size_t const lanes = sizeof(V) / sizeof(uint64_t);
+    V a[25] = {};
+    size_t const blocks = _lanes[_count - 1].blocks;
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        // The words of the lanes are put side by side, the lanes done or unused take zeros.
+        byte const* block[lanes];
+        for (unsigned l = 0; l < lanes; ++l)
+        {
+            block[l] = l < _count ? _lanes[l].block(i) : nullptr;
+            if (!block[l])
+                block[l] = c_noBlock;
+        }
+        for (unsigned w = 0; w < c_rate / 8; ++w)
+        {
+            V words;
+            for (unsigned l = 0; l < lanes; ++l)
+                std::memcpy(reinterpret_cast<uint64_t*>(&words) + l, block[l] + w * 8, 8);
+            a[w] ^= words;
+        }
+        keccakf1600Lanes(a);
+        for (unsigned l = 0; l < _count; ++l)
+            if (_lanes[l].blocks == i + 1)
+                for (unsigned w = 0; w < 4; ++w)
+                {
+                    uint64_t const word = a[w][l];
+                    std::memcpy(_lanes[l].out->data() + w * 8, &word, 8);
+                }
+    }
+}
+
+__attribute__((target("avx2"))) void hashLanes4(Lane const* _lanes, unsigned _count)
+{
+    hashLanes<Lanes4>(_lanes, _count);
+}
+
+__attribute__((target("avx512f"))) void hashLanes8(Lane const* _lanes, unsigned _count)
+{
+    hashLanes<Lanes8>(_lanes, _count);
+}
+
+unsigned detectLanes()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 8;
+    if (__builtin_cpu_supports("avx2"))
+        return 4;
+    return 1;
+}
+
+#endif
+}  // namespace
+
+unsigned sha3BatchLanes() noexcept
+{
+#if DEV_SHA3_LANES
+    static unsigned const s_lanes = detectLanes();
+    return s_lanes;
+#else
+    return 1;
+#endif
+}
+
+void sha3Batch(bytesConstRef const* _inputs, size_t _count, h256* o_outputs) noexcept
+{
+#if DEV_SHA3_LANES
+    unsigned const lanes = sha3BatchLanes();
+    if (lanes > 1 && _count > 1)
+    {
+        // The inputs go through in groups of the lanes in the order of their number of blocks,
+        // so the inputs of a group are mostly of as many blocks and no lane idles long.
+        std::pair<size_t, size_t> order[64];
+        Lane group[8];
+        for (size_t begin = 0; begin < _count; begin += 64)
+        {
+            size_t const n = std::min<size_t>(_count - begin, 64);
+            for (size_t i = 0; i < n; ++i)
+                order[i] = {_inputs[begin + i].size() / c_rate, begin + i};
+            std::sort(order, order + n);
+            for (size_t i = 0; i < n; i += lanes)
+            {
+                unsigned const groupSize = unsigned(std::min<size_t>(n - i, lanes));
+                if (groupSize == 1)
+                {
+                    size_t const k = order[i].second;
+                    sha3(_inputs[k], o_outputs[k].ref());
+                    continue;
+                }
+                for (unsigned l = 0; l < groupSize; ++l)
+                {
+                    size_t const k = order[i + l].second;
+                    group[l].init(_inputs[k], &o_outputs[k]);
+                }
+                if (lanes == 8)
+                    hashLanes8(group, groupSize);
+                else
+                    hashLanes4(group, groupSize);
+            }
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < _count; ++i)
+        sha3(_inputs[i], o_outputs[i].ref());
+}
 }  // namespace dev
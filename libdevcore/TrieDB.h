@@ -310,6 +310,16 @@ public:
     void insert(KeyType _k, bytes const& _value) { insert(_k, bytesConstRef(&_value)); }
     void remove(KeyType _k) { Generic::remove(bytesConstRef((byte const*)&_k, sizeof(KeyType))); }
 
+    /// Inserts the pairs in order, an empty value removes the key. For the hashed tries only.
+    void apply(std::vector<std::pair<KeyType, bytes>> const& _writes)
+    {
+        std::vector<std::pair<bytesConstRef, bytesConstRef>> writes;
+        writes.reserve(_writes.size());
+        for (auto const& w: _writes)
+            writes.emplace_back(bytesConstRef((byte const*)&w.first, sizeof(KeyType)), bytesConstRef(&w.second));
+        Generic::apply(writes);
+    }
+
     class iterator: public Generic::iterator
     {
     public:
@@ -339,6 +349,16 @@ std::ostream& operator<<(std::ostream& _out, SpecificTrieDB<Generic, KeyType> co
     return _out;
 }
 
+/// The hashes of the keys written by HashedGenericTrieDB::apply and FatGenericTrieDB::apply.
+inline h256s hashKeys(std::vector<std::pair<bytesConstRef, bytesConstRef>> const& _writes)
+{
+    std::vector<bytesConstRef> keys;
+    keys.reserve(_writes.size());
+    for (auto const& w: _writes)
+        keys.push_back(w.first);
+    return sha3Batch(keys);
+}
+
 template <class _DB>
 class HashedGenericTrieDB: private SpecificTrieDB<GenericTrieDB<_DB>, h256>
 {
@@ -371,6 +391,17 @@ public:
     void insert(bytesConstRef _key, bytesConstRef _value) { Super::insert(sha3(_key), _value); }
     void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
 
+    /// Inserts the pairs in order, an empty value removes the key; the keys are hashed together first.
+    void apply(std::vector<std::pair<bytesConstRef, bytesConstRef>> const& _writes)
+    {
+        h256s const hashes = hashKeys(_writes);
+        for (size_t i = 0; i < _writes.size(); ++i)
+            if (_writes[i].second.empty())
+                Super::remove(hashes[i]);
+            else
+                Super::insert(hashes[i], _writes[i].second);
+    }
+
     // empty from the PoV of the iterator interface; still need a basic iterator impl though.
     class iterator
     {
@@ -428,6 +459,20 @@ public:
 
     void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
 
+    /// Inserts the pairs in order, an empty value removes the key; the keys are hashed together first.
+    void apply(std::vector<std::pair<bytesConstRef, bytesConstRef>> const& _writes)
+    {
+        h256s const hashes = hashKeys(_writes);
+        for (size_t i = 0; i < _writes.size(); ++i)
+            if (_writes[i].second.empty())
+                Super::remove(hashes[i]);
+            else
+            {
+                Super::insert(hashes[i], _writes[i].second);
+                Super::db()->insertAux(hashes[i], _writes[i].first);
+            }
+    }
+
     // iterates over <key, value> pairs
     class iterator: public GenericTrieDB<_DB>::iterator
     {
@@ -38,7 +38,9 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 		else
 		{
 			// otherwise enumerate all 16+1 entries.
-			_rlp.appendList(17);
+			// the children are independent, those to be hashed are hashed together.
+			RLPStream children[16];
+			std::vector<bytesConstRef> toHash;
 			auto b = _begin;
 			if (_preLen == b->first.size())
 				++b;
@@ -46,11 +48,26 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 			{
 				auto n = b;
 				for (; n != _end && n->first[_preLen] == i; ++n) {}
-				if (b == n)
+				if (b != n)
+				{
+					hash256rlp(_s, b, n, _preLen + 1, children[i]);
+					if (children[i].out().size() >= 32)
+						toHash.push_back(&children[i].out());
+				}
+				b = n;
+			}
+			h256s const hashes = sha3Batch(toHash);
+			auto hash = hashes.begin();
+			_rlp.appendList(17);
+			for (auto const& child: children)
+			{
+				if (child.out().empty())
 					_rlp << "";
+				else if (child.out().size() < 32)
+					// RECURSIVE RLP
+					_rlp.appendRaw(child.out());
 				else
-					hash256aux(_s, b, n, _preLen + 1, _rlp);
-				b = n;
+					_rlp << *hash++;
 			}
 			if (_preLen == _begin->first.size())
 				_rlp << _begin->second;
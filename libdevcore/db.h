@@ -47,6 +47,14 @@ public:
     // of each record in the database. If `f` returns false, the `forEach`
     // method must return immediately.
     virtual void forEach(std::function<bool(Slice, Slice)> f) const = 0;
+
+    // Human readable internal statistics of the database (compaction levels, cache use), for the
+    // logs. Empty if the implementation has none.
+    virtual std::string stats() const { return std::string(); }
+
+    // Returns once every write before the call is on disk, not only in the buffers of the OS.
+    // Writes are not synced otherwise: a crash of the machine may lose the last ones.
+    virtual void sync() {}
 };
 
 DEV_SIMPLE_EXCEPTION(DatabaseError);
@@ -110,6 +110,47 @@ Json::Value Brc::brc_getPendingOrderPool(string const& _order_type, string const
     }
 }
 
+Json::Value Brc::brc_getSuccessPendingOrderPage(
+    string const& _getSize, string const& _cursor, string const& _blockNum)
+{
+    try
+    {
+        return client()->successPendingOrderPage(jsToInt(_getSize), _cursor, jsToBlockNumber(_blockNum));
+    }
+    catch (...)
+    {
+        BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+    }
+}
+
+Json::Value Brc::brc_getPendingOrderPoolForAddrPage(
+    string const& _address, string const& _getSize, string const& _cursor, string const& _blockNum)
+{
+    try
+    {
+        return client()->pendingOrderPoolForAddrPage(
+            jsToAddress(_address), jsToInt(_getSize), _cursor, jsToBlockNumber(_blockNum));
+    }
+    catch (...)
+    {
+        BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+    }
+}
+
+Json::Value Brc::brc_getPendingOrderPoolPage(string const& _order_type, string const& _order_token_type,
+    string const& _getSize, string const& _cursor, string const& _blockNumber)
+{
+    try
+    {
+        return client()->pendingOrderPoolPage(jsToOrderEnum(_order_type), jsToOrderEnum(_order_token_type),
+            jsToInt(_getSize), _cursor, jsToBlockNumber(_blockNumber));
+    }
+    catch (...)
+    {
+        BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+    }
+}
+
 Json::Value Brc::brc_getBalance(string const& _address, string const& _blockNumber)
 {
     try
@@ -56,6 +56,9 @@ public:
 	virtual Json::Value brc_getSuccessPendingOrder(std::string const& _getSize, std::string const& _blockNum) override;
     virtual Json::Value brc_getPendingOrderPoolForAddr(std::string const& _address, std::string const& _getSize, std::string const& _blockNum) override;
     virtual Json::Value brc_getPendingOrderPool(std::string const& _order_type, std::string const& _order_token_type, std::string const& _getSize,std::string const& _blockNumber) override;
+	virtual Json::Value brc_getSuccessPendingOrderPage(std::string const& _getSize, std::string const& _cursor, std::string const& _blockNum) override;
+    virtual Json::Value brc_getPendingOrderPoolForAddrPage(std::string const& _address, std::string const& _getSize, std::string const& _cursor, std::string const& _blockNum) override;
+    virtual Json::Value brc_getPendingOrderPoolPage(std::string const& _order_type, std::string const& _order_token_type, std::string const& _getSize, std::string const& _cursor, std::string const& _blockNumber) override;
 	virtual Json::Value brc_getBalance(std::string const& _address, std::string const& _blockNumber) override;
     virtual std::string brc_getBallot(std::string const& _address, std::string const& _blockNumber) override;
 	virtual std::string brc_getStorageAt(std::string const& _address, std::string const& _position, std::string const& _blockNumber) override;
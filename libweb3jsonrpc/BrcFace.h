@@ -47,6 +47,22 @@ public:
                 jsonrpc::JSON_STRING, "param1", jsonrpc::JSON_STRING, "param2",
                 jsonrpc::JSON_STRING, "param3", jsonrpc::JSON_STRING, NULL),
             &dev::rpc::BrcFace::brc_getPendingOrderPoolForAddrI);
+        this->bindAndAddMethod(jsonrpc::Procedure("brc_getSuccessPendingOrderPage",
+                                   jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",
+                                   jsonrpc::JSON_STRING, "param2", jsonrpc::JSON_STRING, "param3",
+                                   jsonrpc::JSON_STRING, NULL),
+            &dev::rpc::BrcFace::brc_getSuccessPendingOrderPageI);
+        this->bindAndAddMethod(jsonrpc::Procedure("brc_getPendingOrderPoolPage",
+                                   jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",
+                                   jsonrpc::JSON_STRING, "param2", jsonrpc::JSON_STRING, "param3",
+                                   jsonrpc::JSON_STRING, "param4", jsonrpc::JSON_STRING, "param5",
+                                   jsonrpc::JSON_STRING, NULL),
+            &dev::rpc::BrcFace::brc_getPendingOrderPoolPageI);
+        this->bindAndAddMethod(jsonrpc::Procedure("brc_getPendingOrderPoolForAddrPage",
+                                   jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",
+                                   jsonrpc::JSON_STRING, "param2", jsonrpc::JSON_STRING, "param3",
+                                   jsonrpc::JSON_STRING, "param4", jsonrpc::JSON_STRING, NULL),
+            &dev::rpc::BrcFace::brc_getPendingOrderPoolForAddrPageI);
         this->bindAndAddMethod(
             jsonrpc::Procedure("brc_getBalance", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_STRING,
                 "param1", jsonrpc::JSON_STRING, "param2", jsonrpc::JSON_STRING, NULL),
@@ -272,6 +288,22 @@ public:
 	{
 		response = this->brc_getSuccessPendingOrder(request[0u].asString(), request[1u].asString());
 	}
+    inline virtual void brc_getSuccessPendingOrderPageI(const Json::Value& request, Json::Value& response)
+    {
+        response = this->brc_getSuccessPendingOrderPage(
+            request[0u].asString(), request[1u].asString(), request[2u].asString());
+    }
+    inline virtual void brc_getPendingOrderPoolPageI(const Json::Value& request, Json::Value& response)
+    {
+        response = this->brc_getPendingOrderPoolPage(request[0u].asString(), request[1u].asString(),
+            request[2u].asString(), request[3u].asString(), request[4u].asString());
+    }
+    inline virtual void brc_getPendingOrderPoolForAddrPageI(
+        const Json::Value& request, Json::Value& response)
+    {
+        response = this->brc_getPendingOrderPoolForAddrPage(request[0u].asString(),
+            request[1u].asString(), request[2u].asString(), request[3u].asString());
+    }
     inline virtual void brc_getBalanceI(const Json::Value& request, Json::Value& response)
     {
         response = this->brc_getBalance(request[0u].asString(), request[1u].asString());
@@ -504,6 +536,12 @@ public:
     virtual Json::Value brc_getPendingOrderPoolForAddr(
         const std::string& param1, const std::string& param2, const std::string& param3) = 0;
 	virtual Json::Value brc_getSuccessPendingOrder(const std::string& param1, const std::string& param2) = 0;
+    virtual Json::Value brc_getSuccessPendingOrderPage(
+        const std::string& param1, const std::string& param2, const std::string& param3) = 0;
+    virtual Json::Value brc_getPendingOrderPoolPage(const std::string& param1, const std::string& param2,
+        const std::string& param3, const std::string& param4, const std::string& param5) = 0;
+    virtual Json::Value brc_getPendingOrderPoolForAddrPage(const std::string& param1,
+        const std::string& param2, const std::string& param3, const std::string& param4) = 0;
 	virtual Json::Value brc_getBalance(const std::string& param1, const std::string& param2) = 0;
     virtual std::string brc_getBallot(const std::string& param1, const std::string& param2) = 0;
     virtual std::string brc_getStorageAt(
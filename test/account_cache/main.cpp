@@ -0,0 +1,76 @@
+//
+// account cache hit rate and block time against the cache budget.
+// replays synthetic blocks shaped like mainnet traffic: most transactions come from a small set of
+// exchange counterparties, the rest from a long tail, and every transaction reads the DPoS system
+// accounts. each transaction checks both balances, one in ten transfers.
+// usage: account_cache [accounts] [blocks] [txs_per_block]
+//
+
+#include <libbrcdchain/DposVote.h>
+#include <libbrcdchain/State.h>
+#include <libdevcore/Common.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    Address account(size_t i) {
+        return Address(u160(i + 1) << 32);
+    }
+
+    double elapsed_us(std::chrono::steady_clock::time_point const &_start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start).count();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t accounts = argc > 1 ? std::stoul(argv[1]) : 50000;
+    size_t blocks = argc > 2 ? std::stoul(argv[2]) : 20;
+    size_t txs = argc > 3 ? std::stoul(argv[3]) : 5000;
+    size_t const hot = 200;
+
+    // the in memory overlay is enough, nothing is written to disk.
+    State base(0, OverlayDB(), ex::exchange_plugin(), BaseState::Empty);
+    base.setAccountVersion(2);
+    for (size_t i = 0; i < accounts; i++)
+        base.addBalance(account(i), 1000000);
+    base.addBalance(SysElectorAddress, 1);
+    base.addBalance(SysVarlitorAddress, 1);
+    base.addBalance(SysCanlitorAddress, 1);
+    base.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+    std::cout << "budget(KiB)\tblock(us)\thits\t\tmisses\t\tevictions" << std::endl;
+    for (size_t budget_kib : {64, 256, 1024, 4096, 16384}) {
+        State::setAccountCacheBudget(budget_kib * 1024);
+        State s(base);
+        AccountCacheIndex::Stats const before = s.accountCacheStats();
+        std::mt19937 engine(42);
+        std::uniform_int_distribution<size_t> hot_dist(0, hot - 1);
+        std::uniform_int_distribution<size_t> tail_dist(0, accounts - 1);
+        std::uniform_int_distribution<size_t> percent(0, 99);
+        auto pick = [&] { return account(percent(engine) < 80 ? hot_dist(engine) : tail_dist(engine)); };
+
+        double block_us = 0;
+        for (size_t b = 0; b < blocks; b++) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t t = 0; t < txs; t++) {
+                Address const from = pick();
+                Address const to = pick();
+                s.balance(SysElectorAddress);
+                s.balance(SysVarlitorAddress);
+                if (s.balance(from) > 0 && s.balance(to) >= 0 && t % 10 == 0)
+                    s.transferBalance(from, to, 1);
+            }
+            s.commit(State::CommitBehaviour::KeepEmptyAccounts);
+            block_us += elapsed_us(start);
+        }
+        AccountCacheIndex::Stats const &after = s.accountCacheStats();
+        std::cout << budget_kib << "\t\t" << block_us / blocks << "\t\t" << after.hits - before.hits << "\t\t"
+                  << after.misses - before.misses << "\t\t" << after.evictions - before.evictions << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+//
+// contract call time with and without the shared code analysis cache, for both VMs.
+// the contract is large, like a deployed token or exchange contract, but every call only runs a
+// short path through it: the per-call analysis of the whole code dominates without the cache.
+// the path adds PUSH1 to PUSH32 constants and returns the sum, checked against the expected one.
+// usage: code_analysis [calls] [code_kib] [pushes]
+//
+
+#include <libbrcd-interpreter/CodeAnalysis.h>
+#include <libbrcdchain/LastBlockHashesFace.h>
+#include <libbvm/VMFactory.h>
+#include <libdevcore/SHA3.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    class NoLastBlockHashes : public LastBlockHashesFace {
+    public:
+        h256s precedingHashes(h256 const &) const override { return h256s(256, h256()); }
+        void clear() override {}
+    };
+
+    // the contract makes no calls.
+    class LeafExtVM : public ExtVMFace {
+    public:
+        using ExtVMFace::ExtVMFace;
+
+        CreateResult create(u256, u256 &, bytesConstRef, Instruction, u256, OnOpFunc const &) override {
+            return {BVMC_FAILURE, {}, h160()};
+        }
+        CallResult call(CallParameters &) override { return {BVMC_FAILURE, {}}; }
+        h256 blockHash(u256) override { return h256(); }
+    };
+
+    void push(bytes &_code, u256 const &_value, unsigned _bytes) {
+        _code.push_back(byte(Instruction::PUSH1) + _bytes - 1);
+        for (unsigned i = _bytes; i--;)
+            _code.push_back(byte(_value >> (8 * i)));
+    }
+
+    // @returns the code and the sum it returns.
+    std::pair<bytes, u256> contract(size_t _size, size_t _pushes) {
+        bytes code;
+        u256 sum = 0;
+        push(code, 0, 1);
+        for (size_t i = 0; i < _pushes; i++) {
+            unsigned const n = 1 + i % 32;
+            u256 const value = (u256(sha3(toBigEndian(u256(i)))) >> (8 * (32 - n)));
+            push(code, value, n);
+            code.push_back(byte(Instruction::ADD));
+            sum += value;
+        }
+        push(code, 0, 1);
+        code.push_back(byte(Instruction::MSTORE));
+        size_t const jump = code.size();
+        push(code, 0, 2);
+        code.push_back(byte(Instruction::JUMP));
+        for (size_t i = 0; code.size() < _size; i++) {
+            push(code, u256(sha3(toBigEndian(u256(i)))), 32);
+            code.push_back(byte(Instruction::POP));
+            code.push_back(byte(Instruction::JUMPDEST));
+        }
+        size_t const dest = code.size();
+        code[jump + 1] = byte(dest >> 8);
+        code[jump + 2] = byte(dest);
+        code.push_back(byte(Instruction::JUMPDEST));
+        push(code, 32, 1);
+        push(code, 0, 1);
+        code.push_back(byte(Instruction::RETURN));
+        return {code, sum};
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t calls = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t code_kib = argc > 2 ? std::stoul(argv[2]) : 16;
+    size_t pushes = argc > 3 ? std::stoul(argv[3]) : 64;
+
+    auto const c = contract(code_kib * 1024, std::min<size_t>(pushes, 60000));
+    h256 const codeHash = sha3(c.first);
+    NoLastBlockHashes lastHashes;
+    BlockHeader header;
+    header.setGasLimit(u256(1) << 62);
+    header.setTimestamp(1);
+    EnvInfo const envInfo(header, lastHashes, 0);
+
+    std::cout << "vm\t\tcache\tcall(us)\thits\tmisses" << std::endl;
+    for (auto kind : {VMKind::Legacy, VMKind::Interpreter}) {
+        for (size_t budget : {size_t(0), size_t(32 * 1024 * 1024)}) {
+            CodeAnalysisCache &cache = CodeAnalysisCache::instance();
+            cache.clear();
+            cache.setBudget(budget);
+            CodeAnalysisCache::Stats const before = cache.stats();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < calls; i++) {
+                LeafExtVM ext(envInfo, Address(1), Address(2), Address(2), 0, 0, bytesConstRef(), c.first, codeHash,
+                              1, false, false);
+                u256 gas = u256(1) << 40;
+                owning_bytes_ref out = VMFactory::create(kind)->exec(gas, ext, OnOpFunc());
+                if (fromBigEndian<u256>(out) != c.second) {
+                    std::cerr << "wrong sum returned" << std::endl;
+                    return 1;
+                }
+            }
+            double const us =
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            CodeAnalysisCache::Stats const after = cache.stats();
+            std::cout << (kind == VMKind::Legacy ? "legacy\t" : "interpreter") << "\t" << (budget ? "on" : "off")
+                      << "\t" << us / calls << "\t\t" << after.hits - before.hits << "\t"
+                      << after.misses - before.misses << std::endl;
+        }
+    }
+    return 0;
+}
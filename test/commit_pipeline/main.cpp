@@ -0,0 +1,86 @@
+//
+// block time with the state written on commit and with the commit pipeline.
+// every block reads nodes of the blocks before it, writes new ones and commits. the database
+// behind takes a fixed time per batch, like a disk flush. a node not found fails the run.
+// usage: commit_pipeline [blocks] [nodes_per_block] [write_ms] [depth]
+//
+
+#include <libdevcore/MemoryDB.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/PipelinedDB.h>
+#include <libdevcore/SHA3.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace dev;
+
+namespace {
+    class SlowDB : public db::MemoryDB {
+    public:
+        explicit SlowDB(unsigned _writeMs) : m_writeMs(_writeMs) {}
+
+        void commit(std::unique_ptr<db::WriteBatchFace> _batch) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_writeMs));
+            db::MemoryDB::commit(std::move(_batch));
+        }
+
+    private:
+        unsigned const m_writeMs;
+    };
+
+    bytes node(size_t i) {
+        return rlp(u256(i));
+    }
+
+    // @returns false if a node is missing.
+    bool run(OverlayDB &_db, size_t _blocks, size_t _nodes, double &o_block_us) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < _blocks; b++) {
+            for (size_t n = 0; n < _nodes; n++) {
+                size_t const i = b * _nodes + n;
+                if (b > 0) {
+                    size_t const earlier = (i * 7919) % (b * _nodes);
+                    if (_db.lookup(sha3(node(earlier))) != asString(node(earlier)))
+                        return false;
+                }
+                bytes const v = node(i);
+                _db.insert(sha3(v), &v);
+            }
+            _db.commit();
+        }
+        _db.sync();
+        o_block_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / _blocks;
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t blocks = argc > 1 ? std::stoul(argv[1]) : 200;
+    size_t nodes = argc > 2 ? std::stoul(argv[2]) : 2000;
+    unsigned write_ms = argc > 3 ? std::stoul(argv[3]) : 5;
+    unsigned depth = argc > 4 ? std::stoul(argv[4]) : 4;
+
+    double sync_us = 0;
+    double pipelined_us = 0;
+    {
+        OverlayDB db(std::unique_ptr<db::DatabaseFace>(new SlowDB(write_ms)));
+        if (!run(db, blocks, nodes, sync_us)) {
+            std::cerr << "missing node on commit" << std::endl;
+            return 1;
+        }
+    }
+    {
+        std::unique_ptr<db::DatabaseFace> slow(new SlowDB(write_ms));
+        OverlayDB db(std::unique_ptr<db::DatabaseFace>(new db::PipelinedDB(std::move(slow), depth)));
+        if (!run(db, blocks, nodes, pipelined_us)) {
+            std::cerr << "missing node with the pipeline" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "commit\t\tblock(us)" << std::endl;
+    std::cout << "on commit\t" << sync_us << std::endl;
+    std::cout << "pipeline(" << depth << ")\t" << pipelined_us << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+//
+// deletes on a RocksDB database opened with column families over one written before them.
+// a key written without families sits in the default family; once it is routed to another family
+// a delete, direct or in a write batch, must clear the default family too, or the lookup falls
+// back to the old copy and the key comes back.
+// usage: db_families
+//
+
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/TransientDirectory.h>
+
+#include <iostream>
+
+using namespace dev;
+using namespace dev::db;
+
+namespace {
+    std::vector<DatabaseFamily> const c_families{{"default", true, true, false}, {"moved", false, false, false}};
+
+    std::string const c_old = "old";
+    std::string const c_kept = "m-kept";
+
+    // keys starting with 'm' live in the second family.
+    size_t route(Slice _key) { return _key.size() && _key[0] == 'm' ? 1 : 0; }
+
+    bool expectGone(DatabaseFace &_db, std::string const &_key, char const *_how) {
+        if (_db.exists(Slice(_key)) || !_db.lookup(Slice(_key)).empty()) {
+            std::cerr << _key << " still found after " << _how << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    setDatabaseKind(DatabaseKind::RocksDB);
+    TransientDirectory dir;
+
+    {
+        auto legacy = DBFactory::create(dir.path());
+        for (std::string key : {"m-direct", "m-batch", "m-kept", "plain"})
+            legacy->insert(Slice(key), Slice(c_old));
+    }
+
+    auto db = DBFactory::create(dir.path(), c_families, route);
+    if (db->lookup(Slice(c_kept)) != "old") {
+        std::cerr << "a key written before the families is not found" << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    db->kill(Slice(std::string("m-direct")));
+    ok &= expectGone(*db, "m-direct", "a direct delete");
+
+    auto batch = db->createWriteBatch();
+    batch->kill(Slice(std::string("m-batch")));
+    batch->kill(Slice(std::string("plain")));
+    batch->insert(Slice(std::string("m-new")), Slice(std::string("new")));
+    db->commit(std::move(batch));
+    ok &= expectGone(*db, "m-batch", "a batched delete");
+    ok &= expectGone(*db, "plain", "a batched delete");
+
+    batch = db->createWriteBatch();
+    batch->kill(Slice(std::string("m-new")));
+    db->commit(std::move(batch));
+    ok &= expectGone(*db, "m-new", "a batched delete");
+
+    if (db->lookup(Slice(c_kept)) != "old") {
+        std::cerr << "a key not deleted is lost" << std::endl;
+        ok = false;
+    }
+    std::cout << (ok ? "ok" : "failed") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+//
+// BRC operation decode throughput, in operations per second.
+// copy: the old path, every op copied out of the transaction data, its type read, then parsed again.
+// view: transationTool::decode_operations, every op parsed once from its slice of the data.
+// usage: op_decode [transactions] [ops_per_transaction]
+//
+
+#include <libbrcdchain/Transaction.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    double elapsed_s(std::chrono::steady_clock::time_point const &_start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // transaction data holding _ops operations made by _make.
+    template <class MAKE>
+    bytes make_data(size_t _ops, MAKE _make) {
+        RLPStream s(_ops);
+        for (size_t i = 0; i < _ops; i++)
+            s << _make(i).serialize();
+        return s.out();
+    }
+
+    size_t decode_copy(bytes const &_data) {
+        size_t n = 0;
+        for (auto const &val : RLP(_data).toVector<bytes>()) {
+            switch (transationTool::operation::get_type(val)) {
+            case transationTool::vote:
+                n += transationTool::vote_operation(val).m_vote_numbers != 0;
+                break;
+            case transationTool::brcTranscation:
+                n += transationTool::transcation_operation(val).m_Transcation_numbers != 0;
+                break;
+            case transationTool::pendingOrder:
+                n += transationTool::pendingorder_opearaion(val).m_Pendingorder_num != 0;
+                break;
+            default:
+                break;
+            }
+        }
+        return n;
+    }
+
+    size_t decode_view(bytes const &_data) {
+        size_t n = 0;
+        for (auto const &val : transationTool::decode_operations(&_data)) {
+            switch (val.type) {
+            case transationTool::vote:
+                n += val.get<transationTool::vote_operation>().m_vote_numbers != 0;
+                break;
+            case transationTool::brcTranscation:
+                n += val.get<transationTool::transcation_operation>().m_Transcation_numbers != 0;
+                break;
+            case transationTool::pendingOrder:
+                n += val.get<transationTool::pendingorder_opearaion>().m_Pendingorder_num != 0;
+                break;
+            default:
+                break;
+            }
+        }
+        return n;
+    }
+
+    template <class DECODE>
+    double ops_per_s(std::vector<bytes> const &_datas, size_t _ops, DECODE _decode) {
+        size_t check = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto const &d : _datas)
+            check += _decode(d);
+        double const s = elapsed_s(start);
+        if (check != _datas.size() * _ops)
+            std::cout << "decoded " << check << " of " << _datas.size() * _ops << std::endl;
+        return _datas.size() * _ops / s;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t ops = argc > 2 ? std::stoul(argv[2]) : 4;
+
+    Address const from(1);
+    Address const to(2);
+    std::vector<std::pair<std::string, std::vector<bytes>>> kinds(3);
+    kinds[0].first = "vote";
+    kinds[1].first = "transfer";
+    kinds[2].first = "order";
+    for (size_t i = 0; i < count; i++) {
+        kinds[0].second.push_back(make_data(ops, [&](size_t j) {
+            return transationTool::vote_operation(transationTool::vote, from, to, 1, i + j + 1);
+        }));
+        kinds[1].second.push_back(make_data(ops, [&](size_t j) {
+            return transationTool::transcation_operation(transationTool::brcTranscation, from, to, 1, i + j + 1);
+        }));
+        kinds[2].second.push_back(make_data(ops, [&](size_t j) {
+            return transationTool::pendingorder_opearaion(transationTool::pendingOrder, from, ex::order_type::buy,
+                    ex::order_token_type::BRC, ex::order_buy_type::only_price, i + j + 1, 100 + j);
+        }));
+    }
+
+    std::cout << "op\t\tcopy(op/s)\tview(op/s)" << std::endl;
+    for (auto const &k : kinds)
+        std::cout << k.first << "\t\t" << ops_per_s(k.second, ops, decode_copy) << "\t"
+                  << ops_per_s(k.second, ops, decode_view) << std::endl;
+    return 0;
+}
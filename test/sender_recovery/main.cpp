@@ -0,0 +1,70 @@
+//
+// sender recovery throughput, in transactions per second.
+// serial: one thread recovers every sender, as the transaction queue did under its lock.
+// pool: VerifierPool spreads the batch over all cores.
+// queue: TransactionQueue::import of the whole batch, recovery included.
+// usage: sender_recovery [transactions] [senders]
+//
+
+#include <libbrcdchain/VerifierPool.h>
+#include <libbrcdchain/TransactionQueue.h>
+#include <libdevcrypto/Common.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    double elapsed_s(std::chrono::steady_clock::time_point const &_start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // a fresh decode, nothing recovered yet.
+    Transactions decode(std::vector<bytes> const &_rlps) {
+        Transactions ret;
+        ret.reserve(_rlps.size());
+        for (auto const &r : _rlps)
+            ret.emplace_back(r, CheckTransaction::Cheap);
+        return ret;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t senders = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+    std::vector<KeyPair> keys;
+    for (size_t i = 0; i < senders; i++)
+        keys.push_back(KeyPair::create());
+    std::vector<bytes> rlps;
+    for (size_t i = 0; i < count; i++) {
+        KeyPair const &k = keys[i % senders];
+        Transaction t(1, 1, 21000, Address(i + 1), bytes(), i / senders, k.secret());
+        rlps.push_back(t.rlp());
+    }
+    std::cout << "threads: " << std::thread::hardware_concurrency() << "\ttransactions: " << count << std::endl;
+
+    Transactions txs = decode(rlps);
+    auto start = std::chrono::steady_clock::now();
+    for (auto const &t : txs)
+        t.safeSender();
+    std::cout << "serial\t" << count / elapsed_s(start) << " tx/s" << std::endl;
+
+    txs = decode(rlps);
+    start = std::chrono::steady_clock::now();
+    VerifierPool::instance().recover(txs);
+    std::cout << "pool\t" << count / elapsed_s(start) << " tx/s" << std::endl;
+
+    txs = decode(rlps);
+    TransactionQueue tq(count, count);
+    start = std::chrono::steady_clock::now();
+    std::vector<ImportResult> const results = tq.import(txs);
+    double const queue_s = elapsed_s(start);
+    size_t imported = 0;
+    for (auto r : results)
+        imported += r == ImportResult::Success;
+    std::cout << "queue\t" << count / queue_s << " tx/s\t(" << imported << " imported)" << std::endl;
+    return 0;
+}
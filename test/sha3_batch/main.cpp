@@ -0,0 +1,79 @@
+//
+// keccak-256 throughput of dev::sha3 one input at a time against dev::sha3Batch, for inputs of 32
+// bytes (trie keys) and of 200 bytes (transactions, receipts); the batch hashes are first checked
+// against the single ones for every input size up to a few blocks.
+// usage: sha3_batch [inputs] [rounds]
+//
+
+#include <libdevcore/SHA3.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace dev;
+
+namespace {
+    bool check() {
+        std::mt19937_64 rng(1);
+        bytes data(700);
+        for (auto &b : data)
+            b = byte(rng());
+        // every size from 0 to past 5 blocks, in batches of mixed sizes.
+        std::vector<bytesConstRef> inputs;
+        for (size_t size = 0; size <= data.size(); ++size)
+            inputs.push_back(bytesConstRef(data.data() + (size * 7) % 64, std::min(size, data.size() - 64)));
+        for (size_t n = 1; n <= inputs.size(); n = n * 2 + 1) {
+            std::vector<bytesConstRef> const batch(inputs.begin(), inputs.begin() + n);
+            h256s const hashes = sha3Batch(batch);
+            for (size_t i = 0; i < n; ++i)
+                if (hashes[i] != sha3(batch[i])) {
+                    std::cerr << "input of " << batch[i].size() << " bytes in a batch of " << n
+                              << " hashed wrong" << std::endl;
+                    return false;
+                }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t inputs = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    if (!check())
+        return 1;
+
+    std::cout << "lanes: " << sha3BatchLanes() << std::endl;
+    std::cout << "size\tsingle(MB/s)\tbatch(MB/s)\tspeedup" << std::endl;
+    for (size_t size : {32, 200}) {
+        bytes data(inputs * size);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = byte(i * 31 + 7);
+        std::vector<bytesConstRef> refs;
+        for (size_t i = 0; i < inputs; ++i)
+            refs.push_back(bytesConstRef(data.data() + i * size, size));
+        h256s single(inputs);
+        h256s batch(inputs);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r)
+            for (size_t i = 0; i < inputs; ++i)
+                single[i] = sha3(refs[i]);
+        double const singleSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < rounds; ++r)
+            sha3Batch(refs.data(), refs.size(), batch.data());
+        double const batchSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (single != batch) {
+            std::cerr << "batch hashes differ for inputs of " << size << " bytes" << std::endl;
+            return 1;
+        }
+        double const mb = double(data.size()) * rounds / 1e6;
+        std::cout << size << "\t" << mb / singleSecs << "\t\t" << mb / batchSecs << "\t\t" << singleSecs / batchSecs
+                  << std::endl;
+    }
+    return 0;
+}
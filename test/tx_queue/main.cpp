@@ -0,0 +1,106 @@
+//
+// transaction queue import throughput with concurrent importers and a sealer.
+// each importer thread submits the transactions of its own senders, senders are recovered
+// up front so only the queue itself is measured. one more thread keeps pulling
+// topTransactions the way the sealer does. first the nonces of every sender are checked to come out
+// of topTransactions in order after the lowest ones were dropped.
+// usage: tx_queue [transactions] [senders]
+//
+
+#include <libbrcdchain/VerifierPool.h>
+#include <libbrcdchain/TransactionQueue.h>
+#include <libdevcrypto/Common.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    double elapsed_s(std::chrono::steady_clock::time_point const &_start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    bool checkNonceOrder() {
+        std::vector<KeyPair> keys{KeyPair::create(), KeyPair::create()};
+        TransactionQueue tq;
+        // the later nonces pay more, so only the heights keep them behind the earlier ones.
+        auto import = [&](size_t _sender, unsigned _nonce) {
+            Transaction t(0, 1 + _nonce, 21000, Address(1), bytes(), _nonce, keys[_sender].secret());
+            tq.import(t);
+            return t;
+        };
+        std::vector<Transaction> first;
+        for (unsigned nonce = 0; nonce < 4; nonce++) {
+            first.push_back(import(0, nonce));
+            import(1, nonce);
+        }
+        tq.dropGood(first[0]);
+        tq.dropGood(first[1]);
+        for (unsigned nonce = 4; nonce < 8; nonce++)
+            import(0, nonce);
+
+        std::map<Address, u256> next;
+        for (auto const &t : tq.topTransactions(0)) {
+            auto n = next.find(t.from());
+            if (n != next.end() && t.nonce() != n->second) {
+                std::cerr << "nonce " << t.nonce() << " of " << t.from() << " came before nonce " << n->second
+                          << std::endl;
+                return false;
+            }
+            next[t.from()] = t.nonce() + 1;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 40000;
+    size_t senders = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    if (!checkNonceOrder())
+        return 1;
+
+    std::vector<KeyPair> keys;
+    for (size_t i = 0; i < senders; i++)
+        keys.push_back(KeyPair::create());
+    Transactions txs;
+    for (size_t i = 0; i < count; i++)
+        txs.emplace_back(1, 1, 21000, Address(i + 1), bytes(), i / senders, keys[i % senders].secret());
+    VerifierPool::instance().recover(txs);
+    for (auto const &t : txs)
+        t.sha3();
+
+    std::cout << "importers\ttx/s\t\ttop pulls" << std::endl;
+    for (unsigned importers = 1; importers <= std::max(std::thread::hardware_concurrency(), 1U); importers *= 2) {
+        TransactionQueue tq(count, count);
+        std::atomic<bool> done{false};
+        size_t pulls = 0;
+        std::thread sealer([&] {
+            while (!done) {
+                tq.topTransactions(1024);
+                pulls++;
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned k = 0; k < importers; k++)
+            threads.emplace_back([&, k] {
+                // a sender always goes to the same importer, its nonces arrive in order.
+                for (size_t i = 0; i < count; i++)
+                    if (i % senders % importers == k)
+                        tq.import(txs[i]);
+            });
+        for (auto &t : threads)
+            t.join();
+        double const import_s = elapsed_s(start);
+        done = true;
+        sealer.join();
+        std::cout << importers << "\t\t" << count / import_s << "\t\t" << pulls << std::endl;
+    }
+    return 0;
+}
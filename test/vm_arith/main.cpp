@@ -0,0 +1,151 @@
+//
+// VM arithmetic on boost u256 against the Word256 kernels, in nanoseconds per operation.
+// the stack values are loaded and stored as the interpreters do, so the kernel timings include
+// the limb copies from and to u256. every kernel result is checked against boost first, over
+// random operands of every width and the edge values.
+// usage: vm_arith [operations]
+//
+
+#include <libbrcd-interpreter/Word256.h>
+#include <libdevcore/FixedHash.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    u256 const c_max = ~u256(0);
+    u256 const c_min = u256(1) << 255;
+
+    std::vector<u256> operands(size_t _count) {
+        std::mt19937_64 engine(7);
+        std::vector<u256> ret{0, 1, 2, 3, c_max, c_max - 1, c_min, c_min - 1, c_min + 1, u256(1) << 64,
+                              (u256(1) << 64) - 1, (u256(1) << 128) + 1, (u256(1) << 192) - 1};
+        while (ret.size() < _count) {
+            u256 v = 0;
+            for (int i = 0; i < 4; i++)
+                v = (v << 64) | engine();
+            // every width, so the divisions take their short and long paths.
+            ret.push_back(v >> (engine() % 256));
+        }
+        return ret;
+    }
+
+    template<class S>
+    S divWorkaround(S const &_a, S const &_b) {
+        return (S) (s512(_a) / s512(_b));
+    }
+
+    template<class S>
+    S modWorkaround(S const &_a, S const &_b) {
+        return (S) (s512(_a) % s512(_b));
+    }
+
+    u256 exp256(u256 _base, u256 _exponent) {
+        using boost::multiprecision::limb_type;
+        u256 result = 1;
+        while (_exponent) {
+            if (static_cast<limb_type>(_exponent) & 1)
+                result *= _base;
+            _base *= _base;
+            _exponent >>= 1;
+        }
+        return result;
+    }
+
+    Word256 word(u256 const &_v) { return Word256::fromU256(_v); }
+
+    struct Op {
+        char const *name;
+        std::function<u256(u256 const &, u256 const &, u256 const &)> boost;
+        std::function<u256(u256 const &, u256 const &, u256 const &)> kernel;
+    };
+
+    std::vector<Op> const c_ops{
+            {"ADD", [](u256 const &a, u256 const &b, u256 const &) { return a + b; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return add(word(a), word(b)).toU256(); }},
+            {"SUB", [](u256 const &a, u256 const &b, u256 const &) { return a - b; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return sub(word(a), word(b)).toU256(); }},
+            {"MUL", [](u256 const &a, u256 const &b, u256 const &) { return a * b; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return mul(word(a), word(b)).toU256(); }},
+            {"DIV", [](u256 const &a, u256 const &b, u256 const &) { return b ? divWorkaround(a, b) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return div(word(a), word(b)).toU256(); }},
+            {"SDIV", [](u256 const &a, u256 const &b, u256 const &) { return b ? s2u(divWorkaround(u2s(a), u2s(b))) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return sdiv(word(a), word(b)).toU256(); }},
+            {"MOD", [](u256 const &a, u256 const &b, u256 const &) { return b ? modWorkaround(a, b) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return mod(word(a), word(b)).toU256(); }},
+            {"SMOD", [](u256 const &a, u256 const &b, u256 const &) { return b ? s2u(modWorkaround(u2s(a), u2s(b))) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &) { return smod(word(a), word(b)).toU256(); }},
+            {"ADDMOD", [](u256 const &a, u256 const &b, u256 const &c) { return c ? u256((u512(a) + u512(b)) % c) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &c) { return addmod(word(a), word(b), word(c)).toU256(); }},
+            {"MULMOD", [](u256 const &a, u256 const &b, u256 const &c) { return c ? u256((u512(a) * u512(b)) % c) : 0; },
+                    [](u256 const &a, u256 const &b, u256 const &c) { return mulmod(word(a), word(b), word(c)).toU256(); }},
+            {"EXP", [](u256 const &a, u256 const &b, u256 const &) { return exp256(a, b); },
+                    [](u256 const &a, u256 const &b, u256 const &) { return exp(word(a), word(b)).toU256(); }},
+            {"LT", [](u256 const &a, u256 const &b, u256 const &) { return u256(a < b ? 1 : 0); },
+                    [](u256 const &a, u256 const &b, u256 const &) { return u256(lt(word(a), word(b)) ? 1 : 0); }},
+            {"SLT", [](u256 const &a, u256 const &b, u256 const &) { return u256(u2s(a) < u2s(b) ? 1 : 0); },
+                    [](u256 const &a, u256 const &b, u256 const &) { return u256(slt(word(a), word(b)) ? 1 : 0); }},
+            {"SHL", [](u256 const &a, u256 const &b, u256 const &) { return b << unsigned(a & 0xff); },
+                    [](u256 const &a, u256 const &b, u256 const &) { return shl(word(b), unsigned(a & 0xff)).toU256(); }},
+            {"SHR", [](u256 const &a, u256 const &b, u256 const &) { return b >> unsigned(a & 0xff); },
+                    [](u256 const &a, u256 const &b, u256 const &) { return shr(word(b), unsigned(a & 0xff)).toU256(); }},
+            {"SAR", [](u256 const &a, u256 const &b, u256 const &) {
+                unsigned const amount = unsigned(a & 0xff);
+                u256 r = b >> amount;
+                if (b & c_min)
+                    r |= c_max << (256 - amount);
+                return r;
+            },
+                    [](u256 const &a, u256 const &b, u256 const &) { return sar(word(b), unsigned(a & 0xff)).toU256(); }},
+            {"MLOAD", [](u256 const &a, u256 const &, u256 const &) {
+                h256 const m(a);
+                return (u256) m;
+            },
+                    [](u256 const &a, u256 const &, u256 const &) {
+                        h256 const m(a);
+                        return Word256::loadBigEndian(m.data()).toU256();
+                    }},
+    };
+
+    template<class F>
+    double time_ns(std::vector<u256> const &_v, size_t _n, F const &_f) {
+        u256 sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < _n; i++)
+            sink ^= _f(_v[i % _v.size()], _v[(i * 7 + 1) % _v.size()], _v[(i * 13 + 2) % _v.size()]);
+        double const ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (sink == 42)
+            std::cout << "";
+        return ns / _n;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::vector<u256> const v = operands(4096);
+
+    for (auto const &op : c_ops)
+        for (auto const &a : v)
+            for (size_t j = 0; j < 64; j++) {
+                u256 const &b = v[(std::hash<u256>()(a) + j) % v.size()];
+                u256 const &c = v[(j * 31) % v.size()];
+                if (op.boost(a, b, c) != op.kernel(a, b, c)) {
+                    std::cerr << op.name << " differs for " << a << ", " << b << ", " << c << std::endl;
+                    return 1;
+                }
+            }
+
+    std::cout << "op\tboost(ns)\tkernel(ns)" << std::endl;
+    for (auto const &op : c_ops) {
+        // EXP with full width exponents is slow on both sides.
+        size_t const count = std::string(op.name) == "EXP" ? n / 50 : n;
+        std::cout << op.name << "\t" << time_ns(v, count, op.boost) << "\t\t" << time_ns(v, count, op.kernel)
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+//
+// contract run time on the legacy VM, the interpreter and the threaded interpreter.
+// the contract loops through a subroutine called with a constant jump and left with a computed
+// one, reads the gas left on every turn and returns the value it folded; the value is checked
+// against the expected one, the gas used by both interpreters against each other.
+// usage: vm_dispatch [calls] [turns]
+//
+
+#include <libbrcd-interpreter/CodeAnalysis.h>
+#include <libbrcdchain/LastBlockHashesFace.h>
+#include <libbvm/VMFactory.h>
+#include <libdevcore/SHA3.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    class NoLastBlockHashes : public LastBlockHashesFace {
+    public:
+        h256s precedingHashes(h256 const &) const override { return h256s(256, h256()); }
+        void clear() override {}
+    };
+
+    // the contract makes no calls, SHL needs constantinople.
+    class LeafExtVM : public ExtVMFace {
+    public:
+        using ExtVMFace::ExtVMFace;
+
+        CreateResult create(u256, u256 &, bytesConstRef, Instruction, u256, OnOpFunc const &) override {
+            return {BVMC_FAILURE, {}, h160()};
+        }
+        CallResult call(CallParameters &) override { return {BVMC_FAILURE, {}}; }
+        h256 blockHash(u256) override { return h256(); }
+        BRCSchedule const &brcSchedule() const override { return ConstantinopleSchedule; }
+    };
+
+    void op(bytes &_code, Instruction _op) { _code.push_back(byte(_op)); }
+
+    void push2(bytes &_code, size_t _value) {
+        op(_code, Instruction::PUSH2);
+        _code.push_back(byte(_value >> 8));
+        _code.push_back(byte(_value));
+    }
+
+    // @returns the code and the value it returns.
+    std::pair<bytes, u256> contract(unsigned _turns) {
+        size_t const loop = 6, ret = 14, sub = 35;
+        bytes code;
+        // acc ctr
+        push2(code, 1);
+        push2(code, _turns);
+        // loop: acc ctr ret, then the call to sub
+        op(code, Instruction::JUMPDEST);
+        push2(code, ret);
+        push2(code, sub);
+        op(code, Instruction::JUMP);
+        // ret: acc ctr
+        op(code, Instruction::JUMPDEST);
+        op(code, Instruction::GAS);
+        op(code, Instruction::POP);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(1);
+        op(code, Instruction::SWAP1);
+        op(code, Instruction::SUB);
+        op(code, Instruction::DUP1);
+        push2(code, loop);
+        op(code, Instruction::JUMPI);
+        op(code, Instruction::POP);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(0);
+        op(code, Instruction::MSTORE);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(32);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(0);
+        op(code, Instruction::RETURN);
+        // sub: acc ctr ret -> acc * 3 + ctr xor ctr << 8, ctr
+        op(code, Instruction::JUMPDEST);
+        op(code, Instruction::DUP3);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(3);
+        op(code, Instruction::MUL);
+        op(code, Instruction::DUP3);
+        op(code, Instruction::ADD);
+        op(code, Instruction::DUP3);
+        code.push_back(byte(Instruction::PUSH1));
+        code.push_back(8);
+        op(code, Instruction::SHL);
+        op(code, Instruction::XOR);
+        op(code, Instruction::SWAP3);
+        op(code, Instruction::POP);
+        op(code, Instruction::JUMP);
+        assert(code[loop] == byte(Instruction::JUMPDEST) && code[ret] == byte(Instruction::JUMPDEST) &&
+               code[sub] == byte(Instruction::JUMPDEST));
+
+        u256 acc = 1;
+        for (u256 ctr = _turns; ctr; --ctr)
+            acc = (acc * 3 + ctr) ^ (ctr << 8);
+        return {code, acc};
+    }
+
+    char const *name(VMKind _kind) {
+        return _kind == VMKind::Legacy ? "legacy\t" : _kind == VMKind::Interpreter ? "interpreter" : "threaded";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t calls = argc > 1 ? std::stoul(argv[1]) : 2000;
+    unsigned turns = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+    auto const c = contract(turns);
+    h256 const codeHash = sha3(c.first);
+    NoLastBlockHashes lastHashes;
+    BlockHeader header;
+    header.setGasLimit(u256(1) << 62);
+    header.setTimestamp(1);
+    EnvInfo const envInfo(header, lastHashes, 0);
+
+    std::cout << "vm\t\tcall(us)\tgas used" << std::endl;
+    u256 interpreterGas = 0;
+    for (auto kind : {VMKind::Legacy, VMKind::Interpreter, VMKind::Threaded}) {
+        u256 used = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; i++) {
+            LeafExtVM ext(envInfo, Address(1), Address(2), Address(2), 0, 0, bytesConstRef(), c.first, codeHash,
+                          1, false, false);
+            u256 const gas = u256(1) << 40;
+            u256 left = gas;
+            owning_bytes_ref out = VMFactory::create(kind)->exec(left, ext, OnOpFunc());
+            if (fromBigEndian<u256>(out) != c.second) {
+                std::cerr << name(kind) << " returned a wrong value" << std::endl;
+                return 1;
+            }
+            used = gas - left;
+        }
+        double const us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name(kind) << "\t" << us / calls << "\t\t" << used << std::endl;
+
+        if (kind == VMKind::Interpreter)
+            interpreterGas = used;
+        else if (kind == VMKind::Threaded && used != interpreterGas) {
+            std::cerr << "threaded used " << used << " gas, the interpreter " << interpreterGas << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+//
+// nested call run time and heap allocations with the VM pool off and on, for the legacy VM and
+// the interpreter. the contract called with n calls itself with n - 1 and grows its memory, down
+// to 0; every frame returns n plus its child's value plus a memory word which only holds the byte
+// the frame set itself, so a pooled instance handing on the memory of an earlier frame is caught.
+// usage: vm_pool [calls] [depth]
+//
+
+#include <libbrcdchain/LastBlockHashesFace.h>
+#include <libbvm/LegacyVM.h>
+#include <libbvm/VMFactory.h>
+#include <libbrcd-interpreter/VM.h>
+#include <libdevcore/SHA3.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    std::atomic<uint64_t> g_allocations{0};
+}
+
+void *operator new(size_t _size) {
+    ++g_allocations;
+    if (void *p = std::malloc(_size ? _size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *_p) noexcept { std::free(_p); }
+
+void operator delete(void *_p, size_t) noexcept { std::free(_p); }
+
+namespace {
+    class NoLastBlockHashes : public LastBlockHashesFace {
+    public:
+        h256s precedingHashes(h256 const &) const override { return h256s(256, h256()); }
+        void clear() override {}
+    };
+
+    // every call runs the same code again, one frame deeper.
+    class NestedExtVM : public ExtVMFace {
+    public:
+        NestedExtVM(EnvInfo const &_envInfo, bytesConstRef _data, bytes const &_code, h256 const &_codeHash,
+                    unsigned _depth, VMKind _kind) :
+                ExtVMFace(_envInfo, Address(1), Address(2), Address(2), 0, 0, _data, _code, _codeHash, _depth,
+                          false, false),
+                m_kind(_kind) {}
+
+        CreateResult create(u256, u256 &, bytesConstRef, Instruction, u256, OnOpFunc const &) override {
+            return {BVMC_FAILURE, {}, h160()};
+        }
+
+        CallResult call(CallParameters &_p) override {
+            NestedExtVM child(envInfo(), _p.data, code, codeHash, depth + 1, m_kind);
+            owning_bytes_ref out = VMFactory::create(m_kind)->exec(_p.gas, child, _p.onOp);
+            return {BVMC_SUCCESS, std::move(out)};
+        }
+
+        h256 blockHash(u256) override { return h256(); }
+
+        BRCSchedule const &brcSchedule() const override { return ConstantinopleSchedule; }
+
+    private:
+        VMKind m_kind;
+    };
+
+    void op(bytes &_code, Instruction _op) { _code.push_back(byte(_op)); }
+
+    void push1(bytes &_code, byte _value) {
+        op(_code, Instruction::PUSH1);
+        _code.push_back(_value);
+    }
+
+    void push2(bytes &_code, size_t _value) {
+        op(_code, Instruction::PUSH2);
+        _code.push_back(byte(_value >> 8));
+        _code.push_back(byte(_value));
+    }
+
+    bytes contract() {
+        size_t const end = 40;
+        bytes code;
+        // n
+        push1(code, 0);
+        op(code, Instruction::CALLDATALOAD);
+        op(code, Instruction::DUP1);
+        op(code, Instruction::ISZERO);
+        push1(code, end);
+        op(code, Instruction::JUMPI);
+        // mem[0] = n - 1, mem[0x400] = 1
+        op(code, Instruction::DUP1);
+        push1(code, 1);
+        op(code, Instruction::SWAP1);
+        op(code, Instruction::SUB);
+        push1(code, 0);
+        op(code, Instruction::MSTORE);
+        push1(code, 1);
+        push2(code, 0x400);
+        op(code, Instruction::MSTORE8);
+        // mem[0] = call(self, mem[0])
+        push1(code, 32);
+        push1(code, 0);
+        push1(code, 32);
+        push1(code, 0);
+        push1(code, 0);
+        op(code, Instruction::ADDRESS);
+        op(code, Instruction::GAS);
+        op(code, Instruction::CALL);
+        op(code, Instruction::POP);
+        push1(code, 0);
+        op(code, Instruction::MLOAD);
+        op(code, Instruction::ADD);
+        // end: return v + mem[0x3e1], 1 if mem[0x400] was set in this frame, 0 unless another frame's
+        // memory shows through
+        op(code, Instruction::JUMPDEST);
+        push2(code, 0x3e1);
+        op(code, Instruction::MLOAD);
+        op(code, Instruction::ADD);
+        push1(code, 0);
+        op(code, Instruction::MSTORE);
+        push1(code, 32);
+        push1(code, 0);
+        op(code, Instruction::RETURN);
+        assert(code[end] == byte(Instruction::JUMPDEST));
+        return code;
+    }
+
+    VMPoolStats poolStats(VMKind _kind) {
+        return _kind == VMKind::Legacy ? VMPool<LegacyVM>::stats() : VMPool<VM>::stats();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t calls = argc > 1 ? std::stoul(argv[1]) : 2000;
+    unsigned depth = argc > 2 ? std::stoul(argv[2]) : 32;
+
+    bytes const code = contract();
+    h256 const codeHash = sha3(code);
+    h256 const input = h256(u256(depth));
+    u256 const expected = u256(depth) * (depth + 1) / 2 + depth;
+    NoLastBlockHashes lastHashes;
+    BlockHeader header;
+    header.setGasLimit(u256(1) << 62);
+    header.setTimestamp(1);
+    EnvInfo const envInfo(header, lastHashes, 0);
+
+    std::cout << "vm\t\tpool\tcall(us)\tallocs/call\tVMs acquired\tVMs created" << std::endl;
+    for (auto kind : {VMKind::Legacy, VMKind::Interpreter}) {
+        for (size_t capacity : {0, 16, 64}) {
+            vmPoolCapacity() = capacity;
+            VMPoolStats const before = poolStats(kind);
+            uint64_t const allocations = g_allocations;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < calls; i++) {
+                NestedExtVM ext(envInfo, input.ref(), code, codeHash, 0, kind);
+                u256 gas = u256(1) << 40;
+                owning_bytes_ref out = VMFactory::create(kind)->exec(gas, ext, OnOpFunc());
+                if (fromBigEndian<u256>(out) != expected) {
+                    std::cerr << (kind == VMKind::Legacy ? "legacy" : "interpreter") << " returned "
+                              << fromBigEndian<u256>(out) << ", expected " << expected << std::endl;
+                    return 1;
+                }
+            }
+            double const us =
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            VMPoolStats const after = poolStats(kind);
+            std::cout << (kind == VMKind::Legacy ? "legacy\t" : "interpreter") << "\t" << capacity << "\t"
+                      << us / calls << "\t\t" << double(g_allocations - allocations) / calls << "\t\t"
+                      << after.acquired - before.acquired << "\t\t" << after.created - before.created
+                      << std::endl;
+        }
+    }
+    return 0;
+}
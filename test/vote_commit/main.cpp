@@ -0,0 +1,68 @@
+//
+// commit cost of one candidate login/logout against the candidate set size.
+// the elector records live in the vote trie, so a commit writes the changed records only
+// and the cost should stay flat while the set grows.
+// usage: vote_commit [max_candidates] [rounds]
+//
+
+#include <libbrcdchain/DposVote.h>
+#include <libbrcdchain/State.h>
+#include <libdevcore/Common.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace dev;
+using namespace dev::brc;
+
+namespace {
+    Address candidate(size_t i) {
+        return Address(u160(i + 1) << 32);
+    }
+
+    double elapsed_us(std::chrono::steady_clock::time_point const &_start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start).count();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_candidates = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    // the in memory overlay is enough, nothing is written to disk.
+    State s(0, OverlayDB(), ex::exchange_plugin(), BaseState::Empty);
+    s.setAccountVersion(2);
+    DposVote vote(s);
+    std::cout << "candidates\tcommit(us)\treload(us)" << std::endl;
+
+    size_t size = 0;
+    for (size_t target = 100; target <= max_candidates; target *= 2) {
+        for (; size < target; size++) {
+            s.addBalance(candidate(size), 1);
+            vote.voteLoginCandidate(candidate(size));
+        }
+        s.addBalance(candidate(size), 1);
+        s.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+        double commit_us = 0;
+        double reload_us = 0;
+        std::string info;
+        for (size_t r = 0; r < rounds; r++) {
+            if (r % 2)
+                vote.voteLogoutCandidate(candidate(size));
+            else
+                vote.voteLoginCandidate(candidate(size));
+            auto start = std::chrono::steady_clock::now();
+            s.commit(State::CommitBehaviour::KeepEmptyAccounts);
+            commit_us += elapsed_us(start);
+
+            // cache miss of the elector account, then one record lookup.
+            s.setRoot(s.rootHash());
+            start = std::chrono::steady_clock::now();
+            vote.verifyVote(candidate(0), candidate(0), ELoginCandidate, info);
+            reload_us += elapsed_us(start);
+        }
+        std::cout << target << "\t\t" << commit_us / rounds << "\t\t" << reload_us / rounds << std::endl;
+    }
+    return 0;
+}